@@ -0,0 +1,607 @@
+#include <math.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "equation_solver.h"
+#include "thread_pool.h"
+#include "batch_io.h"
+#include "num_io.h"
+#include "solution_cache.h"
+
+/// Size of input block
+static const size_t IO_BUFFER_SIZE = 1 << 20;
+
+/// Size of output block
+static const size_t OUT_BUFFER_SIZE = 1 << 16;
+
+/// Number of equations solved at once
+static const size_t STREAM_BATCH_SIZE = 1 << 16;
+
+/// Equations per chunk of cached solving, multiple of cache line for every output array
+static const size_t CACHE_CHUNK_SIZE = 8192;
+
+static_assert (CACHE_CHUNK_SIZE * sizeof (double) % CACHE_LINE_SIZE == 0 &&
+               CACHE_CHUNK_SIZE * sizeof (enum num_roots) % CACHE_LINE_SIZE == 0, "chunk must be cache line aligned");
+
+/// Number of coefficients in quadric equation
+static const int NUM_COEFFS = 3;
+
+/// Number of coefficients in cubic equation
+static const int NUM_CUBIC_COEFFS = 4;
+
+static inline bool is_separator (char c)
+{
+    return c == ' ' || c == '\t' || c == ',' || c == '\r';
+}
+
+///@brief Arguments of solve_cached_chunk
+struct cached_args
+{
+    size_t n;
+    const double *a;
+    const double *b;
+    const double *c;
+    double *x1;
+    double *x2;
+    enum num_roots *n_roots;
+    struct solution_cache   *cache;
+    const struct batch_opts *opts; ///< Options of solving cache misses, without pool and cache
+};
+
+static void solve_cached_chunk (void *arg, size_t chunk, int thread_id);
+static void solve_uncached     (size_t n, const double a[], const double b[], const double c[],
+                                double x1[], double x2[], enum num_roots n_roots[], const void *arg);
+
+static int read_mapped (FILE *in_stream, line_func_t func, void *arg);
+static int read_blocks (FILE *in_stream, line_func_t func, void *arg);
+
+int eq_batch_ctor (struct eq_batch *batch, size_t capacity)
+{
+    assert (batch != NULL && "pointer can't be null");
+
+    // Every column is a multiple of cache line
+    capacity = (capacity + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+
+    size_t block_size = capacity * (7 * sizeof (double) + sizeof (enum num_roots) + sizeof (bool) + sizeof (uint8_t));
+    char  *block      = (char *) aligned_alloc (CACHE_LINE_SIZE, block_size);
+
+    if (block == NULL) return ENOMEM;
+
+    batch->size     = 0;
+    batch->capacity = capacity;
+
+    batch->a  = (double *) block;
+    batch->b  = batch->a  + capacity;
+    batch->c  = batch->b  + capacity;
+    batch->d  = batch->c  + capacity;
+    batch->x1 = batch->d  + capacity;
+    batch->x2 = batch->x1 + capacity;
+    batch->x3 = batch->x2 + capacity;
+
+    batch->n_roots      = (enum num_roots *) (batch->x3 + capacity);
+    batch->parse_failed = (bool *) (batch->n_roots + capacity);
+    batch->status       = (uint8_t *) (batch->parse_failed + capacity);
+
+    return 0;
+}
+
+void eq_batch_dtor (struct eq_batch *batch)
+{
+    assert (batch != NULL && "pointer can't be null");
+
+    // All arrays are in one block, starting with a
+    free (batch->a);
+
+    batch->a = batch->b = batch->c = batch->d = batch->x1 = batch->x2 = batch->x3 = NULL;
+    batch->n_roots      = NULL;
+    batch->parse_failed = NULL;
+    batch->status       = NULL;
+    batch->size = batch->capacity = 0;
+}
+
+void eq_batch_solve (struct eq_batch *batch, const struct batch_opts *opts)
+{
+    assert (batch != NULL && "pointer can't be null");
+    assert (opts  != NULL && "pointer can't be null");
+
+    if (opts->cubic)
+    {
+        assert (batch->d  != NULL && "pointer can't be null");
+        assert (batch->x3 != NULL && "pointer can't be null");
+
+        if (opts->pool != NULL)
+        {
+            solve_cubic_eq_batch_parallel (opts->pool, batch->size, batch->a, batch->b, batch->c, batch->d,
+                                           batch->x1, batch->x2, batch->x3, batch->n_roots);
+        }
+        else
+        {
+            solve_cubic_eq_batch (batch->size, batch->a, batch->b, batch->c, batch->d,
+                                  batch->x1, batch->x2, batch->x3, batch->n_roots);
+        }
+    }
+    else
+    {
+        eq_batch_solve_quad (batch->size, batch->a, batch->b, batch->c, batch->x1, batch->x2, batch->n_roots, opts);
+    }
+
+    if (batch->status == NULL) return;
+
+    eq_status_fill (batch->size, batch->a, batch->b, batch->c, opts->cubic ? batch->d : NULL,
+                    batch->n_roots, batch->parse_failed, batch->status);
+
+    if (opts->errors != NULL) batch_errors_add (opts->errors, batch->size, batch->status);
+}
+
+void eq_status_fill (size_t n, const double a[], const double b[], const double c[], const double d[],
+                     const enum num_roots n_roots[], const bool parse_failed[], uint8_t status[])
+{
+    assert (a       != NULL && "pointer can't be null");
+    assert (b       != NULL && "pointer can't be null");
+    assert (c       != NULL && "pointer can't be null");
+    assert (n_roots != NULL && "pointer can't be null");
+    assert (status  != NULL && "pointer can't be null");
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (parse_failed != NULL && parse_failed[i])
+        {
+            status[i] = EQ_PARSE_ERROR;
+            continue;
+        }
+
+        bool finite = isfinite (a[i]) && isfinite (b[i]) && isfinite (c[i]) && (d == NULL || isfinite (d[i]));
+        bool range  = n_roots[i] == ERANGE_SOLVE;
+
+        status[i] = (uint8_t) ((finite ? EQ_OK : EQ_NOT_FINITE) | (range ? EQ_OUT_OF_RANGE : EQ_OK));
+    }
+}
+
+void batch_errors_add (struct batch_errors *errors, size_t n, const uint8_t status[])
+{
+    assert (errors != NULL && "pointer can't be null");
+    assert (status != NULL && "pointer can't be null");
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (status[i] == EQ_OK) continue;
+
+        errors->n_errors++;
+
+        for (int bit = 0; bit < EQ_STATUS_BITS; ++bit)
+        {
+            if (!(status[i] & (1 << bit))) continue;
+
+            if (errors->count[bit]++ == 0) errors->first[bit] = errors->n_equations + i + 1;
+        }
+    }
+
+    errors->n_equations += n;
+}
+
+void print_batch_errors (const struct batch_errors *errors, FILE *stream)
+{
+    assert (errors != NULL && "pointer can't be null");
+    assert (stream != NULL && "pointer can't be null");
+
+    static const char *const STATUS_NAMES[EQ_STATUS_BITS] = {"parse error", "not finite coefficient", "out of range"};
+
+    fprintf (stream, "Errors: %zu of %zu equations\n", errors->n_errors, errors->n_equations);
+
+    for (int bit = 0; bit < EQ_STATUS_BITS; ++bit)
+    {
+        if (errors->count[bit] == 0) continue;
+
+        fprintf (stream, "    %-24s %zu, first is equation #%zu\n", STATUS_NAMES[bit], errors->count[bit], errors->first[bit]);
+    }
+}
+
+void eq_batch_solve_quad (size_t n, const double a[], const double b[], const double c[],
+                          double x1[], double x2[], enum num_roots n_roots[], const struct batch_opts *opts)
+{
+    assert (opts != NULL && "pointer can't be null");
+
+    if (opts->cache != NULL)
+    {
+        batch_opts uncached = *opts;
+        uncached.pool  = NULL;
+        uncached.cache = NULL;
+
+        if (opts->pool != NULL)
+        {
+            cached_args args = {n, a, b, c, x1, x2, n_roots, opts->cache, &uncached};
+
+            thread_pool_run (opts->pool, (n + CACHE_CHUNK_SIZE - 1) / CACHE_CHUNK_SIZE, solve_cached_chunk, &args);
+        }
+        else
+        {
+            solution_cache_solve (opts->cache, opts->cache_shard, n, a, b, c, x1, x2, n_roots, solve_uncached, &uncached);
+        }
+
+        return;
+    }
+
+    if (opts->pool != NULL && opts->complex_roots)
+    {
+        solve_quad_eq_batch_complex_parallel_mode (opts->pool, opts->solver, n, a, b, c, x1, x2, n_roots);
+    }
+    else if (opts->pool != NULL)
+    {
+        solve_quad_eq_batch_parallel_mode (opts->pool, opts->solver, n, a, b, c, x1, x2, n_roots);
+    }
+    else if (opts->complex_roots)
+    {
+        solve_quad_eq_batch_complex_mode (opts->solver, n, a, b, c, x1, x2, n_roots);
+    }
+    else
+    {
+        solve_quad_eq_batch_mode (opts->solver, n, a, b, c, x1, x2, n_roots);
+    }
+
+    if (opts->polish)
+    {
+        polish_quad_eq_batch (n, a, b, c, n_roots, x1, x2, NULL);
+    }
+}
+
+///@brief Solve chunk of equations with cache shard of the worker
+static void solve_cached_chunk (void *arg, size_t chunk, int thread_id)
+{
+    assert (arg != NULL && "pointer can't be null");
+
+    const cached_args *args = (const cached_args *) arg;
+
+    size_t begin = chunk * CACHE_CHUNK_SIZE;
+    size_t size  = args->n - begin < CACHE_CHUNK_SIZE ? args->n - begin : CACHE_CHUNK_SIZE;
+
+    solution_cache_solve (args->cache, thread_id, size, args->a + begin, args->b + begin, args->c + begin,
+                          args->x1 + begin, args->x2 + begin, args->n_roots + begin, solve_uncached, args->opts);
+}
+
+///@brief Solve cache misses, arg is batch_opts without pool and cache
+static void solve_uncached (size_t n, const double a[], const double b[], const double c[],
+                            double x1[], double x2[], enum num_roots n_roots[], const void *arg)
+{
+    assert (arg != NULL && "pointer can't be null");
+
+    eq_batch_solve_quad (n, a, b, c, x1, x2, n_roots, (const batch_opts *) arg);
+}
+
+size_t eq_batch_format (const struct eq_batch *batch, size_t begin, size_t end, const struct batch_opts *opts,
+                        char *buffer)
+{
+    assert (batch  != NULL && "pointer can't be null");
+    assert (opts   != NULL && "pointer can't be null");
+    assert (buffer != NULL && "pointer can't be null");
+    assert (begin <= end && end <= batch->size && "range must be in batch");
+
+    const char *parse_error     = opts->format == FORMAT_MACHINE ? "error\n" : "Failed to parse coefficients\n";
+    const size_t parse_error_len = strlen (parse_error);
+
+    size_t len = 0;
+
+    for (size_t i = begin; i < end; ++i)
+    {
+        if (batch->parse_failed != NULL && batch->parse_failed[i])
+        {
+            memcpy (buffer + len, parse_error, parse_error_len);
+            len += parse_error_len;
+        }
+        else
+        {
+            double roots[3] = {batch->x1[i], batch->x2[i], batch->x3 != NULL ? batch->x3[i] : NAN};
+            len += format_solution (buffer + len, batch->n_roots[i], roots, opts->format);
+        }
+    }
+
+    return len;
+}
+
+int eq_batch_print (const struct eq_batch *batch, const struct batch_opts *opts, FILE *stream)
+{
+    assert (batch  != NULL && "pointer can't be null");
+    assert (opts   != NULL && "pointer can't be null");
+    assert (stream != NULL && "pointer can't be null");
+
+    /// Lines formatted into buffer at once
+    const size_t chunk_size = OUT_BUFFER_SIZE / MAX_SOLUTION_LEN;
+
+    char *buffer = (char *) malloc (OUT_BUFFER_SIZE);
+    if (buffer == NULL) return ENOMEM;
+
+    int err = 0;
+
+    for (size_t begin = 0; begin < batch->size; begin += chunk_size)
+    {
+        size_t end = batch->size - begin < chunk_size ? batch->size : begin + chunk_size;
+        size_t len = eq_batch_format (batch, begin, end, opts, buffer);
+
+        if (fwrite (buffer, 1, len, stream) != len) err = EIO;
+    }
+
+    free (buffer);
+    return err;
+}
+
+int parse_leading_coeffs (const char *line, const char *end, int n_coeffs, double coeffs[], const char **stop)
+{
+    assert (line   != NULL && "pointer can't be null");
+    assert (end    != NULL && "pointer can't be null");
+    assert (coeffs != NULL && "pointer can't be null");
+    assert (stop   != NULL && "pointer can't be null");
+
+    const char *pos = line;
+
+    for (int i = 0; i < n_coeffs; ++i)
+    {
+        while (pos < end && is_separator (*pos)) pos++;
+
+        if (pos == end) return -1;
+
+        const char *num_end = pos;
+        int err = parse_double (pos, end, &coeffs[i], &num_end);
+
+        //Nothing converted, bad input or garbage right after number
+        if (err == EINVAL || !isfinite (coeffs[i]) || (num_end < end && !is_separator (*num_end)))
+        {
+            return -1;
+        }
+
+        pos = num_end;
+    }
+
+    *stop = pos;
+    return 0;
+}
+
+int parse_eq_line (const char *line, const char *end, int n_coeffs, double coeffs[])
+{
+    assert (line   != NULL && "pointer can't be null");
+    assert (end    != NULL && "pointer can't be null");
+    assert (coeffs != NULL && "pointer can't be null");
+
+    const char *pos = line;
+
+    if (parse_leading_coeffs (line, end, n_coeffs, coeffs, &pos) != 0) return -1;
+
+    while (pos < end && is_separator (*pos)) pos++;
+
+    // Extra coefficients
+    return pos == end ? 0 : -1;
+}
+
+int scan_lines (const char *data, size_t size, bool last, line_func_t func, void *arg, size_t *done)
+{
+    assert (data != NULL && "pointer can't be null");
+    assert (func != NULL && "pointer can't be null");
+    assert (done != NULL && "pointer can't be null");
+
+    const char *pos      = data;
+    const char *data_end = data + size;
+    int err = 0;
+
+    while (pos < data_end && err == 0)
+    {
+        const char *line_end = (const char *) memchr (pos, '\n', (size_t) (data_end - pos));
+
+        if (line_end == NULL)
+        {
+            if (!last) break;
+            line_end = data_end;
+        }
+
+        const char *line = pos;
+        pos = line_end < data_end ? line_end + 1 : data_end;
+
+        while (line < line_end && is_separator (*line)) line++;
+        if (line == line_end || *line == '#') continue;
+
+        err = func (line, line_end, arg);
+    }
+
+    *done = (size_t) (pos - data);
+    return err;
+}
+
+int read_lines (FILE *in_stream, line_func_t func, void *arg)
+{
+    assert (in_stream != NULL && "pointer can't be null");
+    assert (func      != NULL && "pointer can't be null");
+
+    struct stat in_stat = {};
+
+    if (fstat (fileno (in_stream), &in_stat) == 0 && S_ISREG (in_stat.st_mode))
+    {
+        return read_mapped (in_stream, func, arg);
+    }
+
+    return read_blocks (in_stream, func, arg);
+}
+
+/**
+ * @brief Scan regular file directly in mapped pages, starting at current stream position
+ *
+ * @return Non zero value (errno value) on error
+ */
+static int read_mapped (FILE *in_stream, line_func_t func, void *arg)
+{
+    assert (in_stream != NULL && "pointer can't be null");
+    assert (func      != NULL && "pointer can't be null");
+
+    stream_map map = {};
+
+    int err = map_stream (in_stream, &map);
+    if (err != 0 || map.size == 0) return err;
+
+    madvise (map.addr, map.map_size, MADV_SEQUENTIAL);
+
+    size_t done = 0;
+    err = scan_lines (map.data, map.size, true, func, arg, &done);
+
+    unmap_stream (&map);
+
+    // Leave stream at the end, as if it was read
+    fseeko (in_stream, 0, SEEK_END);
+
+    return err;
+}
+
+int map_stream (FILE *stream, struct stream_map *map)
+{
+    assert (stream != NULL && "pointer can't be null");
+    assert (map    != NULL && "pointer can't be null");
+
+    struct stat in_stat = {};
+    off_t offset = ftello (stream);
+
+    *map = {};
+
+    if (fstat (fileno (stream), &in_stat) != 0 || offset < 0) return errno;
+    if (in_stat.st_size <= offset) return 0;
+
+    void *addr = mmap (NULL, (size_t) in_stat.st_size, PROT_READ, MAP_PRIVATE, fileno (stream), 0);
+
+    if (addr == MAP_FAILED) return errno;
+
+    map->addr     = addr;
+    map->map_size = (size_t) in_stat.st_size;
+    map->data     = (const char *) addr + offset;
+    map->size     = map->map_size - (size_t) offset;
+
+    return 0;
+}
+
+void unmap_stream (struct stream_map *map)
+{
+    assert (map != NULL && "pointer can't be null");
+
+    if (map->addr != NULL) munmap (map->addr, map->map_size);
+
+    *map = {};
+}
+
+/**
+ * @brief Read stream in large blocks and scan complete lines of each block
+ *
+ * @return Non zero value (errno value) on error
+ */
+static int read_blocks (FILE *in_stream, line_func_t func, void *arg)
+{
+    assert (in_stream != NULL && "pointer can't be null");
+    assert (func      != NULL && "pointer can't be null");
+
+    char *buffer = (char *) malloc (IO_BUFFER_SIZE);
+    if (buffer == NULL) return ENOMEM;
+
+    size_t carry = 0; // Size of incomplete line from previous block
+    int    err   = 0;
+
+    while (err == 0)
+    {
+        size_t n_read = fread (buffer + carry, 1, IO_BUFFER_SIZE - carry, in_stream);
+        size_t size   = carry + n_read;
+        size_t done   = 0;
+
+        if (n_read == 0)
+        {
+            if (ferror (in_stream)) err = EIO;
+
+            // Last line without '\n'
+            else err = scan_lines (buffer, size, true, func, arg, &done);
+
+            break;
+        }
+
+        err = scan_lines (buffer, size, false, func, arg, &done);
+
+        // Line does not fit into buffer
+        if (err == 0 && done == 0 && size == IO_BUFFER_SIZE) err = EINVAL;
+
+        carry = size - done;
+        memmove (buffer, buffer + done, carry);
+    }
+
+    free (buffer);
+
+    return err;
+}
+
+///@brief State of solve_stream, argument of solve_line
+struct stream_state
+{
+    struct eq_batch          *batch;
+    FILE                     *out_stream;
+    const struct batch_opts  *opts;
+};
+
+void eq_batch_add_line (struct eq_batch *batch, const char *line, const char *end, int n_coeffs)
+{
+    assert (batch != NULL && "pointer can't be null");
+    assert (batch->size < batch->capacity && "batch is full");
+    assert (n_coeffs <= NUM_CUBIC_COEFFS && "too many coefficients");
+
+    double coeffs[NUM_CUBIC_COEFFS] = {};
+    size_t i = batch->size++;
+
+    batch->parse_failed[i] = parse_eq_line (line, end, n_coeffs, coeffs) != 0;
+
+    if (batch->parse_failed[i])
+    {
+        coeffs[0] = coeffs[1] = coeffs[2] = coeffs[3] = 0;
+    }
+
+    batch->a[i] = coeffs[0];
+    batch->b[i] = coeffs[1];
+    batch->c[i] = coeffs[2];
+    batch->d[i] = coeffs[3];
+}
+
+///@brief Add line to batch, solve and print batch when it is full
+static int solve_line (const char *line, const char *end, void *arg)
+{
+    assert (arg != NULL && "pointer can't be null");
+
+    stream_state *state = (stream_state *) arg;
+    eq_batch     *batch = state->batch;
+
+    eq_batch_add_line (batch, line, end, state->opts->cubic ? NUM_CUBIC_COEFFS : NUM_COEFFS);
+
+    if (batch->size < batch->capacity) return 0;
+
+    eq_batch_solve (batch, state->opts);
+    int err = eq_batch_print (batch, state->opts, state->out_stream);
+    batch->size = 0;
+
+    return err;
+}
+
+int solve_stream (FILE *in_stream, FILE *out_stream, const struct batch_opts *opts)
+{
+    assert (in_stream  != NULL && "pointer can't be null");
+    assert (out_stream != NULL && "pointer can't be null");
+    assert (opts       != NULL && "pointer can't be null");
+
+    eq_batch batch = {};
+
+    if (eq_batch_ctor (&batch, STREAM_BATCH_SIZE) != 0) return ENOMEM;
+
+    stream_state state = {&batch, out_stream, opts};
+
+    int err = read_lines (in_stream, solve_line, &state);
+
+    eq_batch_solve (&batch, opts);
+    int print_err = eq_batch_print (&batch, opts, out_stream);
+
+    if (err == 0) err = print_err;
+
+    if (err == 0 && (fflush (out_stream) != 0 || ferror (out_stream))) err = EIO;
+
+    eq_batch_dtor (&batch);
+
+    return err;
+}
@@ -0,0 +1,210 @@
+#ifndef QUAD_BATCH_IO_H
+#define QUAD_BATCH_IO_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "equation_solver.h"
+#include "num_io.h"
+
+///@brief Status of equation in batch, bit mask
+enum eq_status {
+    EQ_OK           = 0,
+    EQ_PARSE_ERROR  = 1 << 0, ///< Line was not parsed, there is no solution
+    EQ_NOT_FINITE   = 1 << 1, ///< Coefficient is infinite or NaN (binary input), solution is ERANGE_SOLVE
+    EQ_OUT_OF_RANGE = 1 << 2, ///< Solution is ERANGE_SOLVE: roots or intermediate values are out of double range
+};
+
+/// Number of eq_status bits
+const int EQ_STATUS_BITS = 3;
+
+///@brief Summary of errors of solved equations, equations are numbered from 1 in order of solving
+struct batch_errors
+{
+    size_t n_equations;                ///< Equations checked
+    size_t n_errors;                   ///< Equations with nonzero status
+    size_t count[EQ_STATUS_BITS];      ///< Equations with status bit 1 << i
+    size_t first[EQ_STATUS_BITS];      ///< Number of the first equation with status bit 1 << i, 0 if none
+};
+
+///@brief Options of batch solving
+struct batch_opts
+{
+    struct thread_pool  *pool;   ///< Pool for parallel solving, NULL to solve in calling thread
+    enum solver_mode     solver; ///< Solver implementation
+    enum solution_format format; ///< Output format
+    bool                 cubic;  ///< Equations are cubic, lines have four coefficients "a b c d"
+    bool                 complex_roots; ///< Quadratic equations with negative discriminant get COMPLEX_ROOTS
+    bool                 polish; ///< Roots of quadratic equations are refined by polish_quad_eq_batch
+    struct solution_cache *cache; ///< Cache of quadratic equations solutions with shard per pool worker, may be NULL
+    struct batch_errors   *errors; ///< Summary of errors, updated after every solved batch, may be NULL
+    int                  cache_shard; ///< Shard of cache used when pool is NULL
+};
+
+///@brief Quadratic or cubic equations and their solutions in structure of arrays layout
+struct eq_batch
+{
+    size_t size;
+    size_t capacity;
+
+    double *a;
+    double *b;
+    double *c;
+    double *d;  ///< Free coefficient of cubic equations, may be NULL for quadratic ones
+
+    double *x1;
+    double *x2;
+    double *x3; ///< Third root of cubic equations, may be NULL for quadratic ones
+    enum num_roots *n_roots;
+
+    bool *parse_failed; ///< Line was not parsed, coefficients are zero and solution must not be printed. May be NULL
+    uint8_t *status;    ///< eq_status bits of every equation, filled by eq_batch_solve. May be NULL
+};
+
+///@brief Read only mapping of regular file from some offset to its end
+struct stream_map
+{
+    void  *addr;      ///< Mapping address, NULL if nothing is mapped
+    size_t map_size;  ///< Mapping size
+
+    const char *data; ///< Data from stream position
+    size_t      size; ///< Size of data
+};
+
+/**
+ * @brief Function called for every line of the input
+ *
+ * @param[in] line  Line begin, leading separators are skipped
+ * @param[in] end   Line end (position of '\n' or end of data)
+ * @param[in] arg   Argument given to read_lines
+ *
+ * @return Non zero value (errno value) to stop reading
+ */
+typedef int (*line_func_t) (const char *line, const char *end, void *arg);
+
+/**
+ * @brief Allocate batch arrays, every array is aligned to cache line
+ *
+ * @return Non zero value (errno value) on error
+ */
+int  eq_batch_ctor (struct eq_batch *batch, size_t capacity);
+
+///@brief Free batch arrays
+void eq_batch_dtor (struct eq_batch *batch);
+
+///@brief Solve all equations in batch, fill status and add errors to opts->errors
+void eq_batch_solve (struct eq_batch *batch, const struct batch_opts *opts);
+
+/**@brief Find status of solved equations
+ *
+ * @param [in] d            Free coefficients of cubic equations, NULL for quadratic ones
+ * @param [in] parse_failed Equations which were not parsed, may be NULL
+ * @param [out] status      eq_status bits of every equation
+ */
+void eq_status_fill (size_t n, const double a[], const double b[], const double c[], const double d[],
+                     const enum num_roots n_roots[], const bool parse_failed[], uint8_t status[]);
+
+///@brief Add status of n next equations to summary
+void batch_errors_add (struct batch_errors *errors, size_t n, const uint8_t status[]);
+
+///@brief Print number of equations with every error and the first of them
+void print_batch_errors (const struct batch_errors *errors, FILE *stream);
+
+/**@brief Solve quadratic equations stored in separate arrays with solver, pool, complex roots and polish modes of opts
+ *
+ * If opts->cache is not NULL, solutions are taken from cache, every pool worker uses its own shard.
+ */
+void eq_batch_solve_quad (size_t n, const double a[], const double b[], const double c[],
+                          double x1[], double x2[], enum num_roots n_roots[], const struct batch_opts *opts);
+
+/**
+ * @brief Format solutions of equations [begin, end) of batch, one per line, in the same way as eq_batch_print
+ *
+ * @param[out] buffer  Buffer of at least (end - begin) * MAX_SOLUTION_LEN characters, it is not null terminated
+ *
+ * @return Length of formatted text
+ */
+size_t eq_batch_format (const struct eq_batch *batch, size_t begin, size_t end, const struct batch_opts *opts,
+                        char *buffer);
+
+/**
+ * @brief Print solutions of all equations in batch, one per line
+ *
+ * Lines are formatted into a large buffer, which is written by one fwrite. Lines which failed to parse are printed
+ * as "Failed to parse coefficients" in human format and as "error" in machine format.
+ *
+ * @return Non zero value (errno value) on error
+ */
+int eq_batch_print (const struct eq_batch *batch, const struct batch_opts *opts, FILE *stream);
+
+/**
+ * @brief     Parse first n_coeffs coefficients of line, the rest of the line is not checked
+ *
+ * @param[out] stop  Position after last coefficient
+ *
+ * @return     Non zero value on parsing error: too few coefficients, non finite value or garbage after number
+ */
+int parse_leading_coeffs (const char *line, const char *end, int n_coeffs, double coeffs[], const char **stop);
+
+/**
+ * @brief     Parse one line with n_coeffs coefficients separated by spaces, tabs or commas
+ *
+ * @param[in]  line      Line begin
+ * @param[in]  end       Line end (position of '\n' or end of data)
+ * @param[in]  n_coeffs  Number of coefficients
+ * @param[out] coeffs    Array of coefficients: from biggest exponent (zero index) to lowest exponent (n_coeffs-1 index)
+ *
+ * @return     Non zero value on parsing error: wrong number of coefficients, non finite value or garbage after number
+ */
+int parse_eq_line (const char *line, const char *end, int n_coeffs, double coeffs[]);
+
+/**
+ * @brief Parse line with n_coeffs coefficients into the next equation of batch, batch must not be full
+ *
+ * If line failed to parse, parse_failed is set and coefficients are zero.
+ */
+void eq_batch_add_line (struct eq_batch *batch, const char *line, const char *end, int n_coeffs);
+
+/**
+ * @brief Call func for complete lines in data, except empty lines and comments
+ *
+ * @param[in]  last  Data is the end of input, so text after last '\n' is a line too
+ * @param[out] done  Number of bytes processed (up to last '\n' in data, if not last)
+ *
+ * @return Non zero value returned by func
+ */
+int scan_lines (const char *data, size_t size, bool last, line_func_t func, void *arg, size_t *done);
+
+/**
+ * @brief Map regular file from current stream position to its end
+ *
+ * Stream position is not changed. If there is nothing to map, map->addr is NULL and 0 is returned.
+ *
+ * @return Non zero value (errno value) on error
+ */
+int  map_stream   (FILE *stream, struct stream_map *map);
+
+///@brief Unmap file mapped by map_stream
+void unmap_stream (struct stream_map *map);
+
+/**
+ * @brief Call func for every line of in_stream, except empty lines and lines beginning with '#'
+ *
+ * Regular files are memory mapped and scanned in place, other streams (pipes, terminals) are read in large blocks.
+ *
+ * @return Non zero value (errno value) on read error or value returned by func
+ */
+int read_lines (FILE *in_stream, line_func_t func, void *arg);
+
+/**
+ * @brief Solve equations from in_stream (one "a b c" per line, "a b c d" if opts->cubic) and write one solution per line
+ *        to out_stream
+ *
+ * Regular files are memory mapped and parsed in place, other streams (pipes, terminals) are read in large blocks.
+ * Equations are solved in batches. Empty lines and lines beginning with '#' are skipped,
+ * for lines which failed to parse error message is printed instead of solution.
+ *
+ * @return Non zero value (errno value) on read or write error
+ */
+int solve_stream (FILE *in_stream, FILE *out_stream, const struct batch_opts *opts);
+
+#endif //QUAD_BATCH_IO_H
@@ -0,0 +1,401 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cassert>
+#include <benchmark/benchmark.h>
+#include "equation_solver.h"
+#include "batch_io.h"
+#include "num_io.h"
+
+/*
+ * Microbenchmarks of solvers, parser and formatter (Google Benchmark). Every benchmark processes
+ * BENCH_SIZE equations per iteration and reports:
+ *
+ *     time_per_eq      -- time of one equation in seconds
+ *     items_per_second -- equations per second
+ *
+ * Run with --benchmark_out=file.json --benchmark_out_format=json to compare results across commits
+ * (make bench writes bin/bench.json).
+ */
+
+/// Equations processed by one benchmark iteration
+static const size_t BENCH_SIZE = 4096;
+
+/// Lines in stream of input_coeffs and solve_stream benchmarks
+static const size_t STREAM_LINES = 1 << 16;
+
+/// Buffer size of one coefficient written with "%.17g"
+static const size_t NUMBER_LEN = 32;
+
+///@brief Set of equations for benchmark
+enum eq_mix
+{
+    MIX_REALISTIC = 0, ///< 60% two roots, 20% zero roots, 10% one root, 10% linear (degenerate included)
+    MIX_TWO_ROOTS = 1,
+    MIX_ONE_ROOT  = 2,
+    MIX_NO_ROOTS  = 3,
+    MIX_LINEAR    = 4, ///< k*x + b, including k = 0 with and without roots
+};
+
+static const char *const MIX_NAMES[] = {"realistic", "two_roots", "one_root", "no_roots", "linear"};
+
+///@brief Equations in structure of arrays layout, roots and number of roots of reference solution
+struct bench_data
+{
+    double a[BENCH_SIZE];
+    double b[BENCH_SIZE];
+    double c[BENCH_SIZE];
+    double x1[BENCH_SIZE];
+    double x2[BENCH_SIZE];
+    enum num_roots n_roots[BENCH_SIZE];
+};
+
+static double rand_range   (double min, double max);
+static void   rand_equation (eq_mix mix, double *a, double *b, double *c);
+static void   fill_data    (eq_mix mix, bench_data *data);
+static void   set_counters (benchmark::State &state, size_t n_eq);
+static char  *make_stream_text (size_t n_lines, size_t *size);
+
+static void BM_solve_quad_eq (benchmark::State &state)
+{
+    eq_mix mix = (eq_mix) state.range (0);
+
+    static bench_data data = {};
+    fill_data (mix, &data);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < BENCH_SIZE; ++i)
+        {
+            double x1 = NAN, x2 = NAN;
+            num_roots n_roots = solve_quad_eq (data.a[i], data.b[i], data.c[i], &x1, &x2);
+
+            benchmark::DoNotOptimize (n_roots);
+            benchmark::DoNotOptimize (x1);
+            benchmark::DoNotOptimize (x2);
+        }
+    }
+
+    state.SetLabel (MIX_NAMES[mix]);
+    set_counters (state, BENCH_SIZE);
+}
+
+static void BM_solve_quad_eq_mode (benchmark::State &state)
+{
+    solver_mode mode = (solver_mode) state.range (0);
+
+    static bench_data data = {};
+    fill_data (MIX_REALISTIC, &data);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < BENCH_SIZE; ++i)
+        {
+            double x1 = NAN, x2 = NAN;
+            num_roots n_roots = solve_quad_eq_mode (mode, data.a[i], data.b[i], data.c[i], &x1, &x2);
+
+            benchmark::DoNotOptimize (n_roots);
+            benchmark::DoNotOptimize (x1);
+            benchmark::DoNotOptimize (x2);
+        }
+    }
+
+    static const char *const SOLVER_NAMES[] = {"classic", "branchless", "accurate"};
+
+    state.SetLabel (SOLVER_NAMES[mode]);
+    set_counters (state, BENCH_SIZE);
+}
+
+static void BM_solve_quad_eq_batch (benchmark::State &state)
+{
+    eq_mix mix = (eq_mix) state.range (0);
+
+    static bench_data data = {};
+    fill_data (mix, &data);
+
+    for (auto _ : state)
+    {
+        solve_quad_eq_batch (BENCH_SIZE, data.a, data.b, data.c, data.x1, data.x2, data.n_roots);
+        benchmark::ClobberMemory ();
+    }
+
+    state.SetLabel (MIX_NAMES[mix]);
+    set_counters (state, BENCH_SIZE);
+}
+
+static void BM_solve_lin_eq (benchmark::State &state)
+{
+    static bench_data data = {};
+    fill_data (MIX_LINEAR, &data);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < BENCH_SIZE; ++i)
+        {
+            double x = NAN;
+            num_roots n_roots = solve_lin_eq (data.b[i], data.c[i], &x);
+
+            benchmark::DoNotOptimize (n_roots);
+            benchmark::DoNotOptimize (x);
+        }
+    }
+
+    set_counters (state, BENCH_SIZE);
+}
+
+static void BM_parse_coeffs (benchmark::State &state)
+{
+    const int n_coeffs = 3;
+
+    static bench_data data = {};
+    fill_data (MIX_REALISTIC, &data);
+
+    // Round trip representation, as in files written by programs
+    static char  text[BENCH_SIZE * n_coeffs][NUMBER_LEN] = {};
+    static char *strings[BENCH_SIZE * n_coeffs] = {};
+
+    for (size_t i = 0; i < BENCH_SIZE; ++i)
+    {
+        const double coeffs[] = {data.a[i], data.b[i], data.c[i]};
+
+        for (int j = 0; j < n_coeffs; ++j)
+        {
+            char *str = text[i * n_coeffs + (size_t) j];
+
+            snprintf (str, NUMBER_LEN, "%.17g", coeffs[j]);
+            strings[i * n_coeffs + (size_t) j] = str;
+        }
+    }
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < BENCH_SIZE; ++i)
+        {
+            double coeffs[n_coeffs] = {};
+            int err = parse_coeffs (n_coeffs, coeffs, &strings[i * n_coeffs]);
+
+            benchmark::DoNotOptimize (err);
+            benchmark::DoNotOptimize (coeffs);
+        }
+    }
+
+    set_counters (state, BENCH_SIZE);
+}
+
+static void BM_input_coeffs (benchmark::State &state)
+{
+    size_t size = 0;
+    char  *text = make_stream_text (STREAM_LINES, &size);
+
+    FILE *in_stream  = fmemopen (text, size, "r");
+    FILE *dev_null   = fopen ("/dev/null", "w");
+
+    if (in_stream == NULL || dev_null == NULL)
+    {
+        state.SkipWithError ("Failed to open streams");
+    }
+    else
+    {
+        for (auto _ : state)
+        {
+            rewind (in_stream);
+
+            for (size_t i = 0; i < STREAM_LINES; ++i)
+            {
+                double coeffs[3] = {};
+                int err = input_coeffs (3, coeffs, in_stream, dev_null);
+
+                benchmark::DoNotOptimize (err);
+                benchmark::DoNotOptimize (coeffs);
+            }
+        }
+
+        set_counters (state, STREAM_LINES);
+    }
+
+    if (in_stream != NULL) fclose (in_stream);
+    if (dev_null  != NULL) fclose (dev_null);
+    free (text);
+}
+
+static void BM_solve_stream (benchmark::State &state)
+{
+    size_t size = 0;
+    char  *text = make_stream_text (STREAM_LINES, &size);
+
+    FILE *in_stream  = fmemopen (text, size, "r");
+    FILE *dev_null   = fopen ("/dev/null", "w");
+
+    batch_opts opts = {};
+    opts.format = (solution_format) state.range (0);
+
+    if (in_stream == NULL || dev_null == NULL)
+    {
+        state.SkipWithError ("Failed to open streams");
+    }
+    else
+    {
+        for (auto _ : state)
+        {
+            rewind (in_stream);
+
+            int err = solve_stream (in_stream, dev_null, &opts);
+            benchmark::DoNotOptimize (err);
+        }
+
+        state.SetLabel (opts.format == FORMAT_MACHINE ? "machine" : "human");
+        set_counters (state, STREAM_LINES);
+    }
+
+    if (in_stream != NULL) fclose (in_stream);
+    if (dev_null  != NULL) fclose (dev_null);
+    free (text);
+}
+
+static void BM_print_solution (benchmark::State &state)
+{
+    static bench_data data = {};
+    fill_data (MIX_REALISTIC, &data);
+
+    solve_quad_eq_batch (BENCH_SIZE, data.a, data.b, data.c, data.x1, data.x2, data.n_roots);
+
+    FILE *dev_null = fopen ("/dev/null", "w");
+
+    if (dev_null == NULL)
+    {
+        state.SkipWithError ("Failed to open /dev/null");
+        return;
+    }
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < BENCH_SIZE; ++i)
+        {
+            const double roots[] = {data.x1[i], data.x2[i]};
+            print_solution (data.n_roots[i], roots, dev_null);
+        }
+    }
+
+    set_counters (state, BENCH_SIZE);
+    fclose (dev_null);
+}
+
+BENCHMARK (BM_solve_quad_eq)->DenseRange (MIX_REALISTIC, MIX_LINEAR);
+BENCHMARK (BM_solve_quad_eq_mode)->DenseRange (SOLVER_CLASSIC, SOLVER_ACCURATE);
+BENCHMARK (BM_solve_quad_eq_batch)->Arg (MIX_REALISTIC)->Arg (MIX_TWO_ROOTS);
+BENCHMARK (BM_solve_lin_eq);
+BENCHMARK (BM_parse_coeffs);
+BENCHMARK (BM_input_coeffs);
+BENCHMARK (BM_solve_stream)->Arg (FORMAT_HUMAN)->Arg (FORMAT_MACHINE);
+BENCHMARK (BM_print_solution);
+
+BENCHMARK_MAIN ();
+
+///@brief time_per_eq and items_per_second counters, n_eq equations are processed by one iteration
+static void set_counters (benchmark::State &state, size_t n_eq)
+{
+    double n_total = (double) state.iterations () * (double) n_eq;
+
+    state.SetItemsProcessed ((int64_t) n_total);
+
+    // Inverted rate is seconds per equation, console output prints it with SI prefix (ns)
+    state.counters["time_per_eq"] = benchmark::Counter (n_total,
+                                                      benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+///@brief Fill data with equations of given mix, the same for every run (fixed seed)
+static void fill_data (eq_mix mix, bench_data *data)
+{
+    assert (data != NULL && "pointer can't be null");
+
+    srand (42);
+
+    for (size_t i = 0; i < BENCH_SIZE; ++i)
+    {
+        rand_equation (mix, &data->a[i], &data->b[i], &data->c[i]);
+    }
+}
+
+static void rand_equation (eq_mix mix, double *a, double *b, double *c)
+{
+    assert (a != NULL && "pointer can't be null");
+    assert (b != NULL && "pointer can't be null");
+    assert (c != NULL && "pointer can't be null");
+
+    if (mix == MIX_REALISTIC)
+    {
+        int kind = rand () % 10;
+
+        mix = kind < 6 ? MIX_TWO_ROOTS : kind < 8 ? MIX_NO_ROOTS : kind < 9 ? MIX_ONE_ROOT : MIX_LINEAR;
+    }
+
+    double root = rand_range (-100, 100);
+
+    *a = rand_range (-100, 100);
+
+    switch (mix)
+    {
+        case MIX_TWO_ROOTS:
+            // a (x - root) (x - root2)
+            *c = *a * root * rand_range (-100, 100);
+            *b = -*a * root - *c / root;
+            break;
+
+        case MIX_ONE_ROOT:
+            // a (x - root)^2 with exact integer values
+            *a = rand () % 20 + 1;
+            root = rand () % 21 - 10;
+            *b = -2 * *a * root;
+            *c = *a * root * root;
+            break;
+
+        case MIX_NO_ROOTS:
+            *b = rand_range (-100, 100);
+            *c = (*b * *b / (4 * *a)) + copysign (rand_range (1, 100), *a);
+            break;
+
+        case MIX_LINEAR:
+            // Half of linear equations are degenerate: 0 = c or 0 = 0
+            *a = 0;
+            *b = rand () % 2 ? rand_range (-100, 100) : 0;
+            *c = rand () % 2 ? rand_range (-100, 100) : 0;
+            break;
+
+        case MIX_REALISTIC:
+        default:
+            assert (0 && "Invalid enum member");
+            break;
+    }
+}
+
+///@brief Text with n_lines "a b c" lines of realistic mix, *size is set to its length
+static char *make_stream_text (size_t n_lines, size_t *size)
+{
+    assert (size != NULL && "pointer can't be null");
+
+    char *text = (char *) calloc (n_lines, 3 * NUMBER_LEN + 1);
+    assert (text != NULL && "Failed to allocate memory");
+
+    char *pos = text;
+    srand (42);
+
+    for (size_t i = 0; i < n_lines; ++i)
+    {
+        double coeffs[3] = {};
+        rand_equation (MIX_REALISTIC, &coeffs[0], &coeffs[1], &coeffs[2]);
+
+        for (int j = 0; j < 3; ++j)
+        {
+            pos += snprintf (pos, NUMBER_LEN, "%.17g%c", coeffs[j], j < 2 ? ' ' : '\n');
+        }
+    }
+
+    *size = (size_t) (pos - text);
+    return text;
+}
+
+static double rand_range (double min, double max)
+{
+    return min + (max - min) * rand () / RAND_MAX;
+}
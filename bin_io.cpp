@@ -0,0 +1,510 @@
+#include <math.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+#include <charconv>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "equation_solver.h"
+#include "thread_pool.h"
+#include "batch_io.h"
+#include "bin_io.h"
+
+/// Values are stored as is, so files can be used without conversion only on little-endian hosts
+static const bool HOST_LITTLE_ENDIAN = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+/// Alignment of columns in file
+static const size_t COLUMN_ALIGN = 8;
+
+/// Size of output block
+static const size_t OUT_BUFFER_SIZE = 1 << 16;
+
+/// Buffer size enough for "a b c" line or solution
+static const size_t MAX_LINE_LEN = MAX_SOLUTION_LEN;
+
+/// Size of precision field for doubles
+static const uint8_t DOUBLE_PRECISION = sizeof (double);
+
+/// Maximal number of equations, so sizes of columns do not overflow
+static const uint64_t MAX_BIN_COUNT = SIZE_MAX / 32;
+
+static_assert (sizeof (enum num_roots) == sizeof (int32_t), "n_roots column is written from enum array");
+
+///@brief Binary file mapped or loaded into memory
+struct bin_file
+{
+    bin_header  header;
+    const char *columns; ///< Begin of first column, aligned to COLUMN_ALIGN
+    stream_map  map;     ///< Mapping, if columns are used from mapped pages
+    char       *buffer;  ///< Loaded columns, if file is not mapped
+};
+
+///@brief Function writing text line of i-th equation of binary file
+typedef size_t (*line_formatter_t) (const bin_file *file, size_t i, char *buffer, enum solution_format format);
+
+///@brief Growing columns of text_to_bin
+struct text_columns
+{
+    double *col[3];
+    size_t  size;
+    size_t  capacity;
+    int     n_coeffs;
+};
+
+static size_t column_size   (size_t count, size_t value_size);
+static size_t columns_size  (const bin_header *header);
+static int    check_header  (const bin_header *header);
+static int    bin_open      (FILE *stream, bin_file *file);
+static void   bin_close     (bin_file *file);
+static int    load_columns  (bin_file *file, FILE *stream, const char *mapped);
+static int    write_header  (FILE *stream, enum bin_kind kind, size_t count);
+static int    write_column  (FILE *stream, const void *data, size_t count, size_t value_size);
+static int    print_lines   (const bin_file *file, FILE *stream, enum solution_format format,
+                             line_formatter_t format_line);
+static size_t format_coeffs (const bin_file *file, size_t i, char *buffer, enum solution_format format);
+static size_t format_roots  (const bin_file *file, size_t i, char *buffer, enum solution_format format);
+static int    check_roots   (const bin_file *file);
+static int    add_line      (const char *line, const char *end, void *arg);
+
+int solve_bin (FILE *in_stream, FILE *out_stream, bool bin_out, const struct batch_opts *opts)
+{
+    assert (in_stream  != NULL && "pointer can't be null");
+    assert (out_stream != NULL && "pointer can't be null");
+    assert (opts       != NULL && "pointer can't be null");
+
+    bin_file in = {};
+
+    int err = bin_open (in_stream, &in);
+    if (err != 0) return err;
+
+    if (in.header.kind != BIN_COEFFS)
+    {
+        bin_close (&in);
+        return EINVAL;
+    }
+
+    size_t n = in.header.count;
+
+    // Every column is a multiple of cache line
+    size_t capacity = (n / CACHE_LINE_SIZE + 1) * CACHE_LINE_SIZE;
+    char  *block    = (char *) aligned_alloc (CACHE_LINE_SIZE, capacity * (2 * sizeof (double) + sizeof (int32_t) + sizeof (uint8_t)));
+
+    if (block == NULL)
+    {
+        bin_close (&in);
+        return ENOMEM;
+    }
+
+    eq_batch roots = {};
+
+    roots.size     = n;
+    roots.capacity = capacity;
+    roots.x1       = (double *) block;
+    roots.x2       = roots.x1 + capacity;
+    roots.n_roots  = (enum num_roots *) (roots.x2 + capacity);
+    roots.status   = (uint8_t *) (roots.n_roots + capacity);
+
+    const double *a = (const double *) in.columns;
+    const double *b = a + n;
+    const double *c = b + n;
+
+    eq_batch_solve_quad (n, a, b, c, roots.x1, roots.x2, roots.n_roots, opts);
+
+    if (opts->errors != NULL)
+    {
+        eq_status_fill   (n, a, b, c, NULL, roots.n_roots, NULL, roots.status);
+        batch_errors_add (opts->errors, n, roots.status);
+    }
+
+    bin_close (&in);
+
+    if (bin_out)
+    {
+        err = write_header (out_stream, BIN_ROOTS, n);
+
+        if (err == 0) err = write_column (out_stream, roots.n_roots, n, sizeof (int32_t));
+        if (err == 0) err = write_column (out_stream, roots.x1,      n, sizeof (double));
+        if (err == 0) err = write_column (out_stream, roots.x2,      n, sizeof (double));
+    }
+    else
+    {
+        err = eq_batch_print (&roots, opts, out_stream);
+    }
+
+    if (err == 0 && (fflush (out_stream) != 0 || ferror (out_stream))) err = EIO;
+
+    free (block);
+
+    return err;
+}
+
+int text_to_bin (FILE *in_stream, FILE *out_stream, int n_coeffs, size_t *n_lines)
+{
+    assert (in_stream  != NULL && "pointer can't be null");
+    assert (out_stream != NULL && "pointer can't be null");
+    assert ((n_coeffs == 2 || n_coeffs == 3) && "only linear and quadratic equations are supported");
+
+    if (!HOST_LITTLE_ENDIAN) return ENOTSUP;
+
+    text_columns columns = {};
+    columns.n_coeffs = n_coeffs;
+
+    int err = read_lines (in_stream, add_line, &columns);
+
+    if (err == 0) err = write_header (out_stream, BIN_COEFFS, columns.size);
+
+    for (int i = 0; i < 3 && err == 0; ++i)
+    {
+        err = write_column (out_stream, columns.col[i], columns.size, sizeof (double));
+    }
+
+    if (err == 0 && (fflush (out_stream) != 0 || ferror (out_stream))) err = EIO;
+
+    // On parse error the bad line is not added, so it is the next one
+    if (n_lines != NULL) *n_lines = err == EINVAL ? columns.size + 1 : columns.size;
+
+    for (int i = 0; i < 3; ++i) free (columns.col[i]);
+
+    return err;
+}
+
+int bin_to_text (FILE *in_stream, FILE *out_stream, enum solution_format format)
+{
+    assert (in_stream  != NULL && "pointer can't be null");
+    assert (out_stream != NULL && "pointer can't be null");
+
+    bin_file in = {};
+
+    int err = bin_open (in_stream, &in);
+    if (err != 0) return err;
+
+    if (in.header.kind == BIN_COEFFS)
+    {
+        err = print_lines (&in, out_stream, format, format_coeffs);
+    }
+    else
+    {
+        err = check_roots (&in);
+        if (err == 0) err = print_lines (&in, out_stream, format, format_roots);
+    }
+
+    if (err == 0 && (fflush (out_stream) != 0 || ferror (out_stream))) err = EIO;
+
+    bin_close (&in);
+
+    return err;
+}
+
+///@brief Size of column with padding
+static size_t column_size (size_t count, size_t value_size)
+{
+    return (count * value_size + COLUMN_ALIGN - 1) / COLUMN_ALIGN * COLUMN_ALIGN;
+}
+
+///@brief Size of all columns after header
+static size_t columns_size (const bin_header *header)
+{
+    assert (header != NULL && "pointer can't be null");
+
+    if (header->kind == BIN_COEFFS) return 3 * column_size (header->count, sizeof (double));
+
+    return column_size (header->count, sizeof (int32_t)) + 2 * column_size (header->count, sizeof (double));
+}
+
+///@brief Check magic, version and fields of header
+static int check_header (const bin_header *header)
+{
+    assert (header != NULL && "pointer can't be null");
+
+    if (memcmp (header->magic, QUAD_BIN_MAGIC, sizeof (QUAD_BIN_MAGIC)) != 0) return EINVAL;
+
+    if (header->version != QUAD_BIN_VERSION || header->precision != DOUBLE_PRECISION) return ENOTSUP;
+
+    if ((header->kind != BIN_COEFFS && header->kind != BIN_ROOTS) || header->count > MAX_BIN_COUNT) return EINVAL;
+
+    return 0;
+}
+
+/**
+ * @brief Read and check header, map or load columns
+ *
+ * Regular files are mapped from current stream position, columns are used right from mapped pages
+ * if they are aligned. Stream is left after the end of columns.
+ *
+ * @return Non zero value (errno value) on error
+ */
+static int bin_open (FILE *stream, bin_file *file)
+{
+    assert (stream != NULL && "pointer can't be null");
+    assert (file   != NULL && "pointer can't be null");
+
+    *file = {};
+
+    if (!HOST_LITTLE_ENDIAN) return ENOTSUP;
+
+    struct stat in_stat = {};
+
+    if (fstat (fileno (stream), &in_stat) != 0 || !S_ISREG (in_stat.st_mode))
+    {
+        if (fread (&file->header, sizeof (file->header), 1, stream) != 1) return ferror (stream) ? EIO : EINVAL;
+
+        int err = check_header (&file->header);
+        if (err == 0) err = load_columns (file, stream, NULL);
+
+        if (err != 0) bin_close (file);
+        return err;
+    }
+
+    int err = map_stream (stream, &file->map);
+    if (err != 0) return err;
+
+    if (file->map.size < sizeof (file->header))
+    {
+        bin_close (file);
+        return EINVAL;
+    }
+
+    memcpy (&file->header, file->map.data, sizeof (file->header));
+
+    err = check_header (&file->header);
+    if (err == 0 && file->map.size - sizeof (file->header) < columns_size (&file->header)) err = EINVAL;
+
+    const char *columns = file->map.data + sizeof (file->header);
+
+    if (err == 0)
+    {
+        fseeko (stream, (off_t) (sizeof (file->header) + columns_size (&file->header)), SEEK_CUR);
+        madvise (file->map.addr, file->map.map_size, MADV_SEQUENTIAL);
+
+        // Stream position is not aligned, so doubles can't be used in place
+        if ((uintptr_t) columns % COLUMN_ALIGN != 0) err = load_columns (file, NULL, columns);
+        else file->columns = columns;
+    }
+
+    if (err != 0) bin_close (file);
+    return err;
+}
+
+///@brief Free columns
+static void bin_close (bin_file *file)
+{
+    assert (file != NULL && "pointer can't be null");
+
+    unmap_stream (&file->map);
+    free (file->buffer);
+
+    *file = {};
+}
+
+/**
+ * @brief Copy columns to aligned buffer from mapped data or read them from stream
+ *
+ * @param[in] stream  Stream, positioned after header, if mapped is NULL
+ * @param[in] mapped  Columns in mapped pages or NULL
+ *
+ * @return Non zero value (errno value) on error, EINVAL if stream is truncated
+ */
+static int load_columns (bin_file *file, FILE *stream, const char *mapped)
+{
+    assert (file != NULL && "pointer can't be null");
+    assert ((stream != NULL || mapped != NULL) && "no source of columns");
+
+    size_t size = columns_size (&file->header);
+
+    file->buffer = (char *) aligned_alloc (CACHE_LINE_SIZE, (size / CACHE_LINE_SIZE + 1) * CACHE_LINE_SIZE);
+    if (file->buffer == NULL) return ENOMEM;
+
+    if (mapped != NULL)
+    {
+        memcpy (file->buffer, mapped, size);
+        unmap_stream (&file->map);
+    }
+    else if (fread (file->buffer, 1, size, stream) != size)
+    {
+        return ferror (stream) ? EIO : EINVAL;
+    }
+
+    file->columns = file->buffer;
+
+    return 0;
+}
+
+///@brief Write header of current version for doubles
+static int write_header (FILE *stream, enum bin_kind kind, size_t count)
+{
+    assert (stream != NULL && "pointer can't be null");
+
+    bin_header header = {};
+
+    memcpy (header.magic, QUAD_BIN_MAGIC, sizeof (QUAD_BIN_MAGIC));
+    header.version   = QUAD_BIN_VERSION;
+    header.precision = DOUBLE_PRECISION;
+    header.kind      = (uint8_t) kind;
+    header.count     = count;
+
+    return fwrite (&header, sizeof (header), 1, stream) == 1 ? 0 : EIO;
+}
+
+///@brief Write column of count values and zero padding
+static int write_column (FILE *stream, const void *data, size_t count, size_t value_size)
+{
+    assert (stream != NULL && "pointer can't be null");
+    assert ((data != NULL || count == 0) && "pointer can't be null");
+
+    static const char PADDING[COLUMN_ALIGN] = {};
+
+    size_t size    = count * value_size;
+    size_t padding = column_size (count, value_size) - size;
+
+    if (size != 0 && fwrite (data, 1, size, stream) != size) return EIO;
+
+    if (padding != 0 && fwrite (PADDING, 1, padding, stream) != padding) return EIO;
+
+    return 0;
+}
+
+/**
+ * @brief Write text lines of all equations of binary file through large buffer
+ *
+ * @param[in] format_line  Function, which writes line of i-th equation to buffer of MAX_LINE_LEN characters
+ *
+ * @return Non zero value (errno value) on error
+ */
+static int print_lines (const bin_file *file, FILE *stream, enum solution_format format, line_formatter_t format_line)
+{
+    assert (file        != NULL && "pointer can't be null");
+    assert (stream      != NULL && "pointer can't be null");
+    assert (format_line != NULL && "pointer can't be null");
+
+    char *buffer = (char *) malloc (OUT_BUFFER_SIZE);
+    if (buffer == NULL) return ENOMEM;
+
+    size_t len = 0;
+    int    err = 0;
+
+    for (size_t i = 0; i < file->header.count; ++i)
+    {
+        if (OUT_BUFFER_SIZE - len < MAX_LINE_LEN)
+        {
+            if (fwrite (buffer, 1, len, stream) != len) err = EIO;
+            len = 0;
+        }
+
+        len += format_line (file, i, buffer + len, format);
+    }
+
+    if (fwrite (buffer, 1, len, stream) != len) err = EIO;
+
+    free (buffer);
+    return err;
+}
+
+///@brief Write coefficients of i-th equation of BIN_COEFFS file as "a b c" line
+static size_t format_coeffs (const bin_file *file, size_t i, char *buffer, enum solution_format)
+{
+    assert (file   != NULL && "pointer can't be null");
+    assert (buffer != NULL && "pointer can't be null");
+
+    size_t n = file->header.count;
+    const double *col = (const double *) file->columns;
+
+    char *pos = buffer;
+
+    for (size_t j = 0; j < 3; ++j)
+    {
+        pos = std::to_chars (pos, buffer + MAX_LINE_LEN, col[j * n + i]).ptr;
+        *pos++ = j < 2 ? ' ' : '\n';
+    }
+
+    return (size_t) (pos - buffer);
+}
+
+///@brief Write solution of i-th equation of checked BIN_ROOTS file
+static size_t format_roots (const bin_file *file, size_t i, char *buffer, enum solution_format format)
+{
+    assert (file   != NULL && "pointer can't be null");
+    assert (buffer != NULL && "pointer can't be null");
+
+    const int32_t *n_roots = (const int32_t *) file->columns;
+    const double  *x1      = (const double *) (file->columns + column_size (file->header.count, sizeof (int32_t)));
+    const double  *x2      = x1 + file->header.count;
+
+    double roots[2] = {x1[i], x2[i]};
+
+    return format_solution (buffer, (enum num_roots) n_roots[i], roots, format);
+}
+
+/**
+ * @brief Check that BIN_ROOTS columns can be printed: numbers of roots are num_roots values and used roots are finite
+ *
+ * @return EINVAL on invalid number of roots or non finite root
+ */
+static int check_roots (const bin_file *file)
+{
+    assert (file != NULL && "pointer can't be null");
+
+    size_t n = file->header.count;
+
+    const int32_t *n_roots = (const int32_t *) file->columns;
+    const double  *x1      = (const double *) (file->columns + column_size (n, sizeof (int32_t)));
+    const double  *x2      = x1 + n;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (n_roots[i] < COMPLEX_ROOTS || n_roots[i] > TWO_ROOTS) return EINVAL;
+
+        bool complex_roots = n_roots[i] == COMPLEX_ROOTS;
+
+        if (((n_roots[i] >= ONE_ROOT  || complex_roots) && !isfinite (x1[i])) ||
+            ((n_roots[i] == TWO_ROOTS || complex_roots) && !isfinite (x2[i])))
+        {
+            return EINVAL;
+        }
+    }
+
+    return 0;
+}
+
+///@brief Parse leading coefficients of line and append them to text_columns
+static int add_line (const char *line, const char *end, void *arg)
+{
+    assert (arg != NULL && "pointer can't be null");
+
+    text_columns *columns = (text_columns *) arg;
+    double coeffs[3] = {};
+
+    if (parse_leading_coeffs (line, end, columns->n_coeffs, coeffs, &line) != 0) return EINVAL;
+
+    if (columns->n_coeffs == 2)
+    {
+        coeffs[2] = coeffs[1];
+        coeffs[1] = coeffs[0];
+        coeffs[0] = 0;
+    }
+
+    if (columns->size == columns->capacity)
+    {
+        size_t capacity = columns->capacity == 0 ? OUT_BUFFER_SIZE : columns->capacity * 2;
+
+        for (int i = 0; i < 3; ++i)
+        {
+            double *col = (double *) realloc (columns->col[i], capacity * sizeof (double));
+            if (col == NULL) return ENOMEM;
+
+            columns->col[i] = col;
+        }
+
+        columns->capacity = capacity;
+    }
+
+    for (int i = 0; i < 3; ++i)
+    {
+        columns->col[i][columns->size] = coeffs[i];
+    }
+
+    columns->size++;
+
+    return 0;
+}
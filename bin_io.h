@@ -0,0 +1,82 @@
+#ifndef QUAD_BIN_IO_H
+#define QUAD_BIN_IO_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "equation_solver.h"
+#include "batch_io.h"
+
+/*
+ * Binary columnar format, all values are little-endian:
+ *
+ *     bin_header                            32 bytes
+ *     BIN_COEFFS: a[count], b[count], c[count]          doubles
+ *     BIN_ROOTS:  n_roots[count], x1[count], x2[count]  int32 (num_roots value), doubles, doubles
+ *
+ * COMPLEX_ROOTS solutions keep real part of roots in x1 and imaginary part in x2.
+ *
+ * Every column is padded with zeros to a multiple of 8 bytes, so all columns are aligned
+ * to 8 bytes relative to file begin and can be used right from mapped pages.
+ */
+
+///@brief First bytes of binary file
+const char QUAD_BIN_MAGIC[4] = {'Q', 'U', 'A', 'D'};
+
+///@brief Current version of binary format
+const uint16_t QUAD_BIN_VERSION = 1;
+
+///@brief Contents of binary file
+enum bin_kind {
+    BIN_COEFFS = 0, ///< Coefficients of quadratic equations: a, b, c columns
+    BIN_ROOTS  = 1  ///< Solutions: n_roots, x1, x2 columns
+};
+
+///@brief Header of binary file
+struct bin_header
+{
+    char     magic[4];      ///< QUAD_BIN_MAGIC
+    uint16_t version;       ///< QUAD_BIN_VERSION
+    uint8_t  precision;     ///< Size of floating point value in bytes, only 8 (double) is supported
+    uint8_t  kind;          ///< bin_kind value
+    uint64_t count;         ///< Number of equations
+    uint8_t  reserved[16];  ///< Zeros
+};
+
+static_assert (sizeof (bin_header) == 32, "binary header layout must not depend on compiler");
+
+/**
+ * @brief Solve equations from binary file with BIN_COEFFS columns
+ *
+ * Regular files are memory mapped and coefficients are used right from mapped pages,
+ * other streams are read into memory. Solutions are written as BIN_ROOTS file if bin_out is true,
+ * else as text, one line per equation, in opts->format.
+ *
+ * @return Non zero value (errno value) on error, EINVAL on bad header or truncated file
+ */
+int solve_bin (FILE *in_stream, FILE *out_stream, bool bin_out, const struct batch_opts *opts);
+
+/**
+ * @brief Convert text file with one equation per line to BIN_COEFFS file
+ *
+ * Only first n_coeffs columns of each line are used, so test files with expected solutions can be converted too.
+ * For n_coeffs == 2 lines are linear equations "k b", which are written as a = 0, b = k, c = b.
+ * Empty lines and lines beginning with '#' are skipped.
+ *
+ * @param[in]  n_coeffs  Number of coefficients in line: 2 or 3
+ * @param[out] n_lines   Number of equations converted, number of bad equation on error. May be NULL
+ *
+ * @return Non zero value (errno value) on error, EINVAL if some line can't be parsed
+ */
+int text_to_bin (FILE *in_stream, FILE *out_stream, int n_coeffs, size_t *n_lines);
+
+/**
+ * @brief Convert binary file to text
+ *
+ * BIN_COEFFS files are written as "a b c" lines, BIN_ROOTS files as solutions in given format.
+ * Values are written with shortest round trip representation.
+ *
+ * @return Non zero value (errno value) on error, EINVAL on bad header or truncated file
+ */
+int bin_to_text (FILE *in_stream, FILE *out_stream, enum solution_format format);
+
+#endif //QUAD_BIN_IO_H
@@ -2,16 +2,112 @@
 #define COMMON_EQUATION_SOLVER_H
 
 #include<math.h>
+#include<stdio.h>
+#include<float.h>
+#include<type_traits>
+#include "solver_stats.h"
+
+/**
+ * @brief Return ERANGE_SOLVE from solver if cond is false
+ *
+ * Solvers never do I/O: the error is reported by the returned value only, so batches can be solved
+ * in parallel without serializing on stderr. Callers turn it into row status (see eq_status in batch_io.h).
+ */
+#define _CHECK_RANGE(cond) { if (!(cond)) { _STAT (STAT_RANGE_CHECK); return ERANGE_SOLVE; } }
 
 ///@brief Floating point calculations accuracy
-const double DBL_ERROR = 1e-11;
+constexpr double DBL_ERROR = 1e-11;
+
+///@brief 2^exp for non negative exp, calculated at compile time
+template <typename T>
+constexpr T fp_pow2 (int exp)
+{
+    T res = 1;
+
+    for (; exp > 0; --exp) res *= 2;
+
+    return res;
+}
+
+/**
+ * @brief Compile time parameters of floating point type used by solvers
+ *
+ * error    -- zero tolerance of is_zero, about 70% of the decimal digits of the type
+ * safe_max -- coefficients up to this absolute value can't overflow b*b - 4*a*c: 2^(max_exp/2 - 12)
+ * min_exp  -- minimal binary exponent of normalized value (FLT_MIN_EXP, DBL_MIN_EXP, ...)
+ * mant_dig -- number of mantissa bits (FLT_MANT_DIG, DBL_MANT_DIG, ...)
+ * max      -- maximal finite value (FLT_MAX, DBL_MAX, ...)
+ */
+template <typename T> struct fp_traits;
+
+template <> struct fp_traits<float>
+{
+    static constexpr float error    = 1e-5f;
+    static constexpr float safe_max = fp_pow2<float> (FLT_MAX_EXP / 2 - 12);
+    static constexpr int   min_exp  = FLT_MIN_EXP;
+    static constexpr int   mant_dig = FLT_MANT_DIG;
+    static constexpr float max      = FLT_MAX;
+};
+
+template <> struct fp_traits<double>
+{
+    static constexpr double error    = DBL_ERROR;
+    static constexpr double safe_max = fp_pow2<double> (DBL_MAX_EXP / 2 - 12);
+    static constexpr int    min_exp  = DBL_MIN_EXP;
+    static constexpr int    mant_dig = DBL_MANT_DIG;
+    static constexpr double max      = DBL_MAX;
+};
+
+template <> struct fp_traits<long double>
+{
+    // x87 extended precision has 64 bit mantissa, IEEE quad (aarch64) has 113 bit one
+    static constexpr long double error    = LDBL_MANT_DIG > 64 ? 1e-24L : 1e-14L;
+    static constexpr long double safe_max = fp_pow2<long double> (LDBL_MAX_EXP / 2 - 12);
+    static constexpr int         min_exp  = LDBL_MIN_EXP;
+    static constexpr int         mant_dig = LDBL_MANT_DIG;
+    static constexpr long double max      = LDBL_MAX;
+};
+
+// IEEE quad precision type of GCC, FLT128_* constants are in quadmath.h
+#ifdef __SIZEOF_FLOAT128__
+
+template <> struct fp_traits<__float128>
+{
+    static constexpr __float128 error    = (__float128) 1e-24L;
+    static constexpr __float128 safe_max = fp_pow2<__float128> (16384 / 2 - 12);
+    static constexpr int        min_exp  = -16381;
+    static constexpr int        mant_dig = 113;
+    static constexpr __float128 max      = (2 - 1 / fp_pow2<__float128> (112)) * fp_pow2<__float128> (16383);
+};
+
+// Overloads of math.h functions, so templates can call them for every type
+static inline __float128 fabs     (__float128 x)           { return fabsf128  (x); }
+static inline __float128 sqrt     (__float128 x)           { return sqrtf128  (x); }
+static inline __float128 frexp    (__float128 x, int *exp) { return frexpf128 (x, exp); }
+static inline __float128 ldexp    (__float128 x, int exp)  { return ldexpf128 (x, exp); }
+static inline bool       isfinite (__float128 x)           { return __builtin_isfinite (x); }
+
+#endif
+
+///@brief Batch kernels solve equations with coefficients up to this absolute value, nothing overflows for them
+constexpr double BATCH_SAFE_MAX = fp_traits<double>::safe_max;
+
+///@brief Absolute value, can be calculated at compile time
+template <typename T>
+constexpr T fp_abs (T x)
+{
+    if (std::is_constant_evaluated ()) return x < 0 ? -x : x;
+
+    return fabs (x);
+}
 
 /**
- * @brief Compare double to zero, taking into account floating point calculation error
+ * @brief Compare value to zero, taking into account floating point calculation error of its type
  */
-static inline bool is_zero (double x)
+template <typename T>
+constexpr bool is_zero (T x)
 {
-    return fabs(x) < DBL_ERROR;
+    return fp_abs(x) < fp_traits<T>::error;
 }
 
-#endif
\ No newline at end of file
+#endif
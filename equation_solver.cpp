@@ -2,35 +2,165 @@
 #include <cfloat>
 #include <cstdio>
 #include <cerrno>
+#include <cctype>
+#include <cstring>
+#include <cstdint>
 #include <cassert>
+#include <type_traits>
 #include "common_equation_solver.h"
 #include "equation_solver.h"
+#include "equation_solver_tmpl.h"
+#include "equation_solver_const.h"
+#include "num_io.h"
 
-static int  read_double (double *x, const char *prompt, FILE *in_stream, FILE *out_stream);
-static void flush_input (FILE *stream);
+template <typename T> static void solve_quad_eq_batch_kernel  (size_t n, const T a[], const T b[], const T c[],
+                                                               T x1[], T x2[], enum num_roots n_roots[]);
+template <typename T> static void solve_quad_eq_batch_fixup_t (size_t n, const T a[], const T b[], const T c[],
+                                                               T x1[], T x2[], enum num_roots n_roots[]);
 
-#if defined(TEST) || defined(NDEBUG)
+static void solve_quad_eq_batch_complex_fixup (size_t n, const double a[], const double b[], const double c[],
+                                               double x1[], double x2[], enum num_roots n_roots[]);
 
-    #define _CHECK_RANGE(cond) { if (!(cond)) return ERANGE_SOLVE; }
+static int    read_double (double *x, const char *prompt, FILE *in_stream, FILE *out_stream);
+static size_t read_token  (char *buffer, size_t size, FILE *stream, int *delim);
+static void   flush_input (FILE *stream);
 
-#else
-    
-    #define _CHECK_RANGE(cond)                                                        \
-    {                                                                                \
-        if (!(cond))                                                                 \
-        {                                                                            \
-            fprintf (stderr, "\n-- Warning: Overflow in internal calculation -- \n");\
-            fprintf (stderr, "Condition: %s\n", #cond);                              \
-            fprintf (stderr, "Line: %d, File: %s, Func: %s\n\n",                     \
-                                __LINE__, __FILE__, __PRETTY_FUNCTION__);            \
-            return ERANGE_SOLVE;                                                     \
-        }                                                                            \
-    }                                                                                \
+/// Max length of number in interactive input
+static const size_t MAX_TOKEN_SIZE = 128;
+
+num_roots solve_quad_eq (double a, double b, double c, double *x1, double *x2)
+{
+    return solve_quad_eq_t (a, b, c, x1, x2);
+}
+
+num_roots solve_quad_eq_f (float a, float b, float c, float *x1, float *x2)
+{
+    return solve_quad_eq_t (a, b, c, x1, x2);
+}
+
+num_roots solve_quad_eq_l (long double a, long double b, long double c, long double *x1, long double *x2)
+{
+    return solve_quad_eq_t (a, b, c, x1, x2);
+}
+
+#ifdef __SIZEOF_FLOAT128__
+
+num_roots solve_quad_eq_q (__float128 a, __float128 b, __float128 c, __float128 *x1, __float128 *x2)
+{
+    return solve_quad_eq_t (a, b, c, x1, x2);
+}
 
 #endif
 
+template <typename T>
+num_roots solve_quad_eq_t (T a, T b, T c, T *x1, T *x2)
+{
+    assert (isfinite(a) && "parameter must be finite");
+    assert (isfinite(b) && "parameter must be finite");
+    assert (isfinite(c) && "parameter must be finite");
+    assert (x1 != NULL  && "pointer can't be null");
+    assert (x2 != NULL  && "pointer can't be null");
+    assert (x1 != x2    && "pointers can't be same");
 
-num_roots solve_quad_eq (double a, double b, double c, double *x1, double *x2)
+    eq_solution<T> sol = solve_quad_eq_const (a, b, c);
+
+    _CHECK_RANGE (sol.n_roots != ERANGE_SOLVE);
+
+    if (sol.n_roots >= ONE_ROOT)  *x1 = sol.x1;
+    if (sol.n_roots == TWO_ROOTS) *x2 = sol.x2;
+
+    return sol.n_roots;
+}
+
+num_roots solve_quad_eq_complex (double a, double b, double c, double *x1, double *x2)
+{
+    assert (isfinite(a) && "parameter must be finite");
+    assert (isfinite(b) && "parameter must be finite");
+    assert (isfinite(c) && "parameter must be finite");
+    assert (x1 != NULL  && "pointer can't be null");
+    assert (x2 != NULL  && "pointer can't be null");
+    assert (x1 != x2    && "pointers can't be same");
+
+    eq_solution<double> sol = solve_quad_eq_const<double, true> (a, b, c);
+
+    _CHECK_RANGE (sol.n_roots != ERANGE_SOLVE);
+
+    if (sol.n_roots >= ONE_ROOT || sol.n_roots == COMPLEX_ROOTS) *x1 = sol.x1;
+    if (sol.n_roots == TWO_ROOTS || sol.n_roots == COMPLEX_ROOTS) *x2 = sol.x2;
+
+    return sol.n_roots;
+}
+
+/**
+ * @brief Select t if cond is true and f otherwise with bit masks
+ *
+ * Compiler keeps ?: of doubles as a branch, when it can skip calculation of one of the values.
+ */
+static inline double select_double (bool cond, double t, double f)
+{
+    uint64_t t_bits = 0, f_bits = 0;
+
+    memcpy (&t_bits, &t, sizeof (t));
+    memcpy (&f_bits, &f, sizeof (f));
+
+    uint64_t mask = 0 - (uint64_t) cond;
+    uint64_t bits = (t_bits & mask) | (f_bits & ~mask);
+
+    double res = 0;
+    memcpy (&res, &bits, sizeof (res));
+
+    return res;
+}
+
+/**
+ * @brief Branch-free solution of equation with coefficients not bigger than BATCH_SAFE_MAX by absolute value
+ *
+ * Roots are calculated with numerically stable formula: q = -(b + sign(b) * sqrt(disc)) / 2, x1 = q / a, x2 = c / q,
+ * number of roots is calculated with arithmetic on comparison results. All branches of solve_quad_eq are evaluated
+ * and the result is selected. Unused roots are set to NAN, equations with bigger coefficients get ERANGE_SOLVE.
+ * Taken branch is added to counts by count_quad_eq_lanes.
+ */
+static inline int solve_quad_eq_stable (double a, double b, double c, double *x1, double *x2, uint64_t counts[])
+{
+    bool a_zero = is_zero (a);
+    bool b_zero = is_zero (b);
+    bool c_zero = is_zero (c);
+
+    bool in_range = (fabs (a) <= BATCH_SAFE_MAX) & (fabs (b) <= BATCH_SAFE_MAX) & (fabs (c) <= BATCH_SAFE_MAX);
+
+    double a_safe = select_double (a_zero, 1, a);
+    double b_safe = select_double (b_zero, 1, b);
+
+    double disc      = b*b - 4*a*c;
+    bool   disc_zero = is_zero (disc);
+    bool   disc_neg  = disc < 0;
+
+    // |q| >= sqrt(disc) / 2, so q is zero only if there are less than two roots
+    double q      = -(b + copysign (sqrt (select_double (disc_neg, 0, disc)), b)) / 2;
+    double q_safe = select_double (fabs (q) > 0, q, 1);
+
+    int lin_n_roots  = ONE_ROOT - b_zero * (1 + c_zero);
+    int quad_n_roots = TWO_ROOTS - disc_zero - 2 * (disc_neg & !disc_zero);
+    int res_n_roots  = quad_n_roots + a_zero * (lin_n_roots - quad_n_roots);
+
+    res_n_roots += !in_range * (ERANGE_SOLVE - res_n_roots);
+
+    // One division for x1: -c / b, -b/2 / a or q / a. Halving is exact, so -b/2 / a == -b / a / 2
+    double x1_num = select_double (a_zero, -c, select_double (quad_n_roots == ONE_ROOT, -b / 2, q));
+    double x1_den = select_double (a_zero, b_safe, a_safe);
+
+    double root1 = x1_num / x1_den;
+    double root2 = c / q_safe;
+
+    *x1 = select_double (res_n_roots >= ONE_ROOT,  root1, NAN);
+    *x2 = select_double (res_n_roots == TWO_ROOTS, root2, NAN);
+
+    count_quad_eq_lanes (counts, in_range, a_zero, b_zero, c_zero, disc_zero, disc_neg);
+
+    return res_n_roots;
+}
+
+num_roots solve_quad_eq_branchless (double a, double b, double c, double *x1, double *x2)
 {
     assert (isfinite(a) && "parameter must be finite");
     assert (isfinite(b) && "parameter must be finite");
@@ -39,121 +169,382 @@ num_roots solve_quad_eq (double a, double b, double c, double *x1, double *x2)
     assert (x2 != NULL  && "pointer can't be null");
     assert (x1 != x2    && "pointers can't be same");
 
-    // The equation is linear
+    uint64_t counts[N_SOLVER_STATS] = {};
+
+    int n_roots = solve_quad_eq_stable (a, b, c, x1, x2, counts);
+
+    // Rare and well predicted: big coefficients need scaling
+    if (n_roots == ERANGE_SOLVE) return solve_quad_eq (a, b, c, x1, x2);
+
+    add_quad_eq_counts (counts);
+
+    return (enum num_roots) n_roots;
+}
 
-    if (is_zero(a))
+void solve_quad_eq_batch_branchless (size_t n, const double a[], const double b[], const double c[],
+                                     double x1[], double x2[], enum num_roots n_roots[])
+{
+    assert (a       != NULL && "pointer can't be null");
+    assert (b       != NULL && "pointer can't be null");
+    assert (c       != NULL && "pointer can't be null");
+    assert (x1      != NULL && "pointer can't be null");
+    assert (x2      != NULL && "pointer can't be null");
+    assert (n_roots != NULL && "pointer can't be null");
+
+    uint64_t counts[N_SOLVER_STATS] = {};
+
+    for (size_t i = 0; i < n; ++i)
     {
-        return solve_lin_eq (b, c, x1);
+        n_roots[i] = (enum num_roots) solve_quad_eq_stable (a[i], b[i], c[i], &x1[i], &x2[i], counts);
     }
-    else
+
+    add_quad_eq_counts (counts);
+    solve_quad_eq_batch_fixup (n, a, b, c, x1, x2, n_roots);
+}
+
+num_roots solve_quad_eq_mode (enum solver_mode mode, double a, double b, double c, double *x1, double *x2)
+{
+    switch (mode)
     {
-        _CHECK_RANGE (!(fabs (b) > sqrt (DBL_MAX)));
-        _CHECK_RANGE (!(!is_zero (c) && fabs (a) > (DBL_MAX / fabs(c) / 4)));
-        _CHECK_RANGE (!(b*b > (DBL_MAX - 4*a*c)));
+        case SOLVER_CLASSIC:
+            return solve_quad_eq (a, b, c, x1, x2);
 
-        double disc = b*b - 4*a*c;
+        case SOLVER_BRANCHLESS:
+            return solve_quad_eq_branchless (a, b, c, x1, x2);
 
-        if (is_zero(disc))
-        {
-            *x1 = -b / a / 2;
-            return ONE_ROOT;
-        }
-        else if (disc < 0)
-        {
-            return ZERO_ROOTS;
-        }
-        else // disc > 0
-        {
-            assert (disc > 0 && "Unexpected disc value in else branch");
-
-            if (is_zero(b))
-            {
-                *x1 = -sqrt (-c / a);
-                *x2 = +sqrt (-c / a);
-            }
-            else if (is_zero(c))
-            {
-                *x1 = 0;
-                *x2 = -b / a;
-            }
-            else
-            {
-                double sq_disc = sqrt(disc);
-
-                *x1 = (-b + sq_disc) / a / 2;
-                *x2 = (-b - sq_disc) / a / 2;
-            }
-
-            return TWO_ROOTS;
-        }
+        case SOLVER_ACCURATE:
+            return solve_quad_eq_accurate (a, b, c, x1, x2);
+
+        default:
+            assert (0 && "Invalid enum member");
+            return ERANGE_SOLVE;
     }
 }
 
-enum num_roots solve_lin_eq (double k, double b, double *x)
+void solve_quad_eq_batch_mode (enum solver_mode mode, size_t n, const double a[], const double b[], const double c[],
+                               double x1[], double x2[], enum num_roots n_roots[])
 {
-    assert (isfinite(k) && "parameter must be finite");
-    assert (isfinite(b) && "parameter must be finite");
-    assert (x != NULL   && "pointer can't be null");
+    switch (mode)
+    {
+        case SOLVER_CLASSIC:
+            solve_quad_eq_batch (n, a, b, c, x1, x2, n_roots);
+            break;
+
+        case SOLVER_BRANCHLESS:
+            solve_quad_eq_batch_branchless (n, a, b, c, x1, x2, n_roots);
+            break;
+
+        case SOLVER_ACCURATE:
+            solve_quad_eq_batch_accurate (n, a, b, c, x1, x2, n_roots);
+            break;
+
+        default:
+            assert (0 && "Invalid enum member");
+            break;
+    }
+}
+
+void solve_quad_eq_batch_complex (size_t n, const double a[], const double b[], const double c[],
+                                  double x1[], double x2[], enum num_roots n_roots[])
+{
+    solve_quad_eq_batch_complex_mode (SOLVER_CLASSIC, n, a, b, c, x1, x2, n_roots);
+}
+
+void solve_quad_eq_batch_complex_mode (enum solver_mode mode, size_t n, const double a[], const double b[],
+                                       const double c[], double x1[], double x2[], enum num_roots n_roots[])
+{
+    solve_quad_eq_batch_mode (mode, n, a, b, c, x1, x2, n_roots);
+    solve_quad_eq_batch_complex_fixup (n, a, b, c, x1, x2, n_roots);
+}
 
-    // k = 0 and there are either no solutions or infinitely many (when b=0)
-    if (is_zero(k)) 
+/**
+ * @brief Replace ZERO_ROOTS of quadratic equations with complex roots
+ *
+ * Discriminant and roots are calculated with the same operations as in solve_quad_eq_direct
+ * and selected without branches, equations with coefficients bigger than BATCH_SAFE_MAX are
+ * solved by solve_quad_eq_complex.
+ */
+static void solve_quad_eq_batch_complex_fixup (size_t n, const double a[], const double b[], const double c[],
+                                               double x1[], double x2[], enum num_roots n_roots[])
+{
+    assert (a       != NULL && "pointer can't be null");
+    assert (b       != NULL && "pointer can't be null");
+    assert (c       != NULL && "pointer can't be null");
+    assert (x1      != NULL && "pointer can't be null");
+    assert (x2      != NULL && "pointer can't be null");
+    assert (n_roots != NULL && "pointer can't be null");
+
+    bool has_big = false;
+
+    for (size_t i = 0; i < n; ++i)
     {
-        if (is_zero(b))  return INF_ROOTS;
-        else             return ZERO_ROOTS;
+        bool a_zero   = is_zero (a[i]);
+        bool in_range = fabs (a[i]) <= BATCH_SAFE_MAX && fabs (b[i]) <= BATCH_SAFE_MAX && fabs (c[i]) <= BATCH_SAFE_MAX;
+        bool no_roots = n_roots[i] == ZERO_ROOTS && !a_zero;
+
+        double a_safe = a_zero ? 1 : a[i];
+        double disc   = b[i]*b[i] - 4*a[i]*c[i];
+
+        double re = -b[i] / a_safe / 2;
+        double im = sqrt (disc < 0 ? -disc : 0) / fabs (a_safe) / 2;
+
+        bool to_complex = no_roots & in_range;
+
+        x1[i]      = to_complex ? re : x1[i];
+        x2[i]      = to_complex ? im : x2[i];
+        n_roots[i] = to_complex ? COMPLEX_ROOTS : n_roots[i];
+
+        has_big |= no_roots & !in_range;
     }
-    else 
+
+    if (!has_big) return;
+
+    for (size_t i = 0; i < n; ++i)
     {
-        _CHECK_RANGE (fabs(b) < DBL_MAX*fabs(k));
+        if (n_roots[i] != ZERO_ROOTS || is_zero (a[i])) continue;
 
-        *x = -b / k;
-        return ONE_ROOT;
+        n_roots[i] = solve_quad_eq_complex (a[i], b[i], c[i], &x1[i], &x2[i]);
     }
 }
 
-void print_solution (enum num_roots n_roots, double roots[], FILE *stream)
+void solve_quad_eq_batch_generic (size_t n, const double a[], const double b[], const double c[],
+                                  double x1[], double x2[], enum num_roots n_roots[])
 {
-    assert (stream != NULL && "pointer can't be null");
-    assert (roots  != NULL && "pointer can't be null");
+    solve_quad_eq_batch_kernel (n, a, b, c, x1, x2, n_roots);
+}
 
-    for (int i = n_roots - 1; i >= 0; --i)
+void solve_quad_eq_batch_f (size_t n, const float a[], const float b[], const float c[],
+                            float x1[], float x2[], enum num_roots n_roots[])
+{
+    solve_quad_eq_batch_t (n, a, b, c, x1, x2, n_roots);
+}
+
+template <typename T>
+void solve_quad_eq_batch_t (size_t n, const T a[], const T b[], const T c[], T x1[], T x2[], enum num_roots n_roots[])
+{
+    if constexpr (std::is_same_v<T, double>)
+    {
+        solve_quad_eq_batch (n, a, b, c, x1, x2, n_roots);
+    }
+    else
+    {
+        solve_quad_eq_batch_kernel  (n, a, b, c, x1, x2, n_roots);
+        solve_quad_eq_batch_fixup_t (n, a, b, c, x1, x2, n_roots);
+    }
+}
+
+/**
+ * @brief Portable batch kernel for any floating point type (see solve_quad_eq_batch_generic)
+ */
+template <typename T>
+static void solve_quad_eq_batch_kernel (size_t n, const T a[], const T b[], const T c[],
+                                        T x1[], T x2[], enum num_roots n_roots[])
+{
+    assert (a       != NULL && "pointer can't be null");
+    assert (b       != NULL && "pointer can't be null");
+    assert (c       != NULL && "pointer can't be null");
+    assert (x1      != NULL && "pointer can't be null");
+    assert (x2      != NULL && "pointer can't be null");
+    assert (n_roots != NULL && "pointer can't be null");
+
+    const T *__restrict a_r = a;
+    const T *__restrict b_r = b;
+    const T *__restrict c_r = c;
+    T *__restrict x1_r = x1;
+    T *__restrict x2_r = x2;
+    enum num_roots *__restrict n_roots_r = n_roots;
+
+    const T safe_max = fp_traits<T>::safe_max;
+
+    uint64_t counts[N_SOLVER_STATS] = {};
+
+    // Every branch of solve_quad_eq is evaluated and the result is selected,
+    // divisors are replaced with 1 in lanes where they would be zero
+    for (size_t i = 0; i < n; ++i)
     {
-        assert (isfinite(roots[i]) && "parameter must be finite");
+        T ai = a_r[i], bi = b_r[i], ci = c_r[i];
+
+        bool a_zero = is_zero (ai);
+        bool b_zero = is_zero (bi);
+        bool c_zero = is_zero (ci);
+
+        T a_safe = a_zero ? 1 : ai;
+        T b_safe = b_zero ? 1 : bi;
 
-        if (is_zero(roots[i])) roots[i] = 0;
+        // Nothing overflows with smaller coefficients, the rest is left for solve_quad_eq_batch_fixup
+        // Bitwise operators instead of logical ones: no short circuit branches
+        bool in_range = (fabs (ai) <= safe_max) & (fabs (bi) <= safe_max) & (fabs (ci) <= safe_max);
+
+        // Linear branch (solve_lin_eq (b, c, x1))
+        T   lin_root     = -ci / b_safe;
+        int lin_n_roots  = b_zero ? (c_zero ? INF_ROOTS : ZERO_ROOTS) : ONE_ROOT;
+
+        // Quadratic branch
+        T    disc      = bi*bi - 4*ai*ci;
+        bool disc_zero = is_zero (disc);
+        bool disc_neg  = disc < 0;
+        T    sq_disc   = sqrt (disc > 0 ? disc : 0);
+
+        T ratio     = -ci / a_safe;
+        T sq_ratio  = sqrt (ratio > 0 ? ratio : 0);
+
+        T one_root  = -bi / a_safe / 2;
+        T two_root1 = b_zero ? -sq_ratio : c_zero ? 0            : (-bi + sq_disc) / a_safe / 2;
+        T two_root2 = b_zero ? +sq_ratio : c_zero ? -bi / a_safe : (-bi - sq_disc) / a_safe / 2;
+
+        int quad_n_roots = disc_zero ? ONE_ROOT   :
+                           disc_neg  ? ZERO_ROOTS : TWO_ROOTS;
+
+        int res_n_roots = !in_range ? ERANGE_SOLVE : a_zero ? lin_n_roots : quad_n_roots;
+        T   res_x1      = a_zero ? lin_root : (quad_n_roots == ONE_ROOT ? one_root : two_root1);
+
+        x1_r[i] = (res_n_roots >= ONE_ROOT)  ? res_x1    : (T) NAN;
+        x2_r[i] = (res_n_roots == TWO_ROOTS) ? two_root2 : (T) NAN;
+        n_roots_r[i] = (enum num_roots) res_n_roots;
+
+        count_quad_eq_lanes (counts, in_range, a_zero, b_zero, c_zero, disc_zero, disc_neg);
     }
 
-    switch (n_roots) {
-        case TWO_ROOTS:
-            fprintf (stream, "2 solutions: %.3e и %.3e\n", roots[0], roots[1]);
-            break;
+    add_quad_eq_counts (counts);
+}
 
-        case ONE_ROOT:
-            fprintf (stream, "1 solution: %.3e\n", roots[0]);
-            break;
+void solve_quad_eq_batch_fixup (size_t n, const double a[], const double b[], const double c[],
+                                double x1[], double x2[], enum num_roots n_roots[])
+{
+    solve_quad_eq_batch_fixup_t (n, a, b, c, x1, x2, n_roots);
+}
 
-        case ZERO_ROOTS:
-            fprintf (stream, "No solutions\n");
-            break;
+template <typename T>
+static void solve_quad_eq_batch_fixup_t (size_t n, const T a[], const T b[], const T c[],
+                                         T x1[], T x2[], enum num_roots n_roots[])
+{
+    assert (a       != NULL && "pointer can't be null");
+    assert (b       != NULL && "pointer can't be null");
+    assert (c       != NULL && "pointer can't be null");
+    assert (x1      != NULL && "pointer can't be null");
+    assert (x2      != NULL && "pointer can't be null");
+    assert (n_roots != NULL && "pointer can't be null");
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (n_roots[i] != ERANGE_SOLVE) continue;
 
-        case INF_ROOTS:
-            fprintf (stream, "Infinitive number of roots\n");
-            break;
+        x1[i] = x2[i] = (T) NAN;
 
-        case ERANGE_SOLVE:
-            fprintf (stream, "Failed to solve equation: Coefficients out of range\n");
-            break;
+        // Not finite coefficients stay out of range
+        if (!isfinite (a[i]) || !isfinite (b[i]) || !isfinite (c[i])) continue;
 
-        default:
-            assert (0 && "Invalid enum member");
-            break;
+        n_roots[i] = solve_quad_eq_t (a[i], b[i], c[i], &x1[i], &x2[i]);
     }
 }
 
+enum num_roots solve_lin_eq (double k, double b, double *x)
+{
+    return solve_lin_eq_t (k, b, x);
+}
+
+enum num_roots solve_lin_eq_f (float k, float b, float *x)
+{
+    return solve_lin_eq_t (k, b, x);
+}
+
+enum num_roots solve_lin_eq_l (long double k, long double b, long double *x)
+{
+    return solve_lin_eq_t (k, b, x);
+}
+
+#ifdef __SIZEOF_FLOAT128__
+
+enum num_roots solve_lin_eq_q (__float128 k, __float128 b, __float128 *x)
+{
+    return solve_lin_eq_t (k, b, x);
+}
+
+#endif
+
+template <typename T>
+enum num_roots solve_lin_eq_t (T k, T b, T *x)
+{
+    assert (isfinite(k) && "parameter must be finite");
+    assert (isfinite(b) && "parameter must be finite");
+    assert (x != NULL   && "pointer can't be null");
+
+    eq_solution<T> sol = solve_lin_eq_const (k, b);
+
+    _CHECK_RANGE (sol.n_roots != ERANGE_SOLVE);
+
+    if (sol.n_roots == ONE_ROOT) *x = sol.x1;
+
+    return sol.n_roots;
+}
+
+// Instantiations for other translation units (see equation_solver_tmpl.h)
+#define _INSTANTIATE_SOLVERS(T)                                                                \
+    template num_roots solve_lin_eq_t        (T k, T b, T *x);                                 \
+    template num_roots solve_quad_eq_t       (T a, T b, T c, T *x1, T *x2);                    \
+    template void      solve_quad_eq_batch_t (size_t n, const T a[], const T b[], const T c[], \
+                                              T x1[], T x2[], enum num_roots n_roots[]);
+
+_INSTANTIATE_SOLVERS (float)
+_INSTANTIATE_SOLVERS (double)
+_INSTANTIATE_SOLVERS (long double)
+
+#ifdef __SIZEOF_FLOAT128__
+_INSTANTIATE_SOLVERS (__float128)
+#endif
+
+#undef _INSTANTIATE_SOLVERS
+
+void print_solution (enum num_roots n_roots, const double roots[], FILE *stream)
+{
+    assert (stream != NULL && "pointer can't be null");
+    assert (roots  != NULL && "pointer can't be null");
+
+    char buffer[MAX_SOLUTION_LEN] = "";
+    size_t len = format_solution (buffer, n_roots, roots, FORMAT_HUMAN);
+
+    fwrite (buffer, 1, len, stream);
+}
+
 ///@brief Flush input stream to '\\n' symbol
 static void flush_input (FILE *stream)
 {
     assert (stream != NULL && "pointer can't be null");
-    while (getc(stream) != '\n') {}
+
+    int c = 0;
+    while ((c = getc(stream)) != '\n' && c != EOF) {}
+}
+
+/**
+ * @brief Skip whitespaces and read next whitespace separated token
+ *
+ * @param[out] buffer Buffer for token, it is truncated if it does not fit
+ * @param[in]  size   Buffer size
+ * @param[out] delim  Character after token (whitespace or EOF)
+ *
+ * @return Full length of token, 0 on EOF
+ */
+static size_t read_token (char *buffer, size_t size, FILE *stream, int *delim)
+{
+    assert (buffer != NULL && "pointer can't be null");
+    assert (stream != NULL && "pointer can't be null");
+    assert (delim  != NULL && "pointer can't be null");
+    assert (size > 0       && "buffer can't be empty");
+
+    int c = getc (stream);
+    while (c != EOF && isspace (c)) c = getc (stream);
+
+    size_t len = 0;
+
+    for (; c != EOF && !isspace (c); c = getc (stream), len++)
+    {
+        if (len < size - 1) buffer[len] = (char) c;
+    }
+
+    buffer[len < size - 1 ? len : size - 1] = '\0';
+    *delim = c;
+
+    return len;
 }
 
 /**
@@ -168,32 +559,32 @@ static int read_double (double *x, const char *prompt, FILE *in_stream, FILE *ou
     assert (in_stream    != NULL && "pointer can't be null");
     assert (out_stream   != NULL && "pointer can't be null");
 
-    errno = 0;
-    int scanf_res = 0;
+    char token[MAX_TOKEN_SIZE] = "";
 
     while (true)
     {
         fprintf (out_stream, "%s", prompt);
-        scanf_res = fscanf (in_stream, "%lf", x);
+
+        int    delim = 0;
+        size_t len   = read_token (token, sizeof (token), in_stream, &delim);
+
+        if (len == 0) return EIO;
+
+        const char *stop = token;
+        int err = len < sizeof (token) ? parse_double (token, token + len, x, &stop) : ERANGE;
 
         // For too large numbers or for non-numeric input, ask again
-        if (errno == ERANGE || (errno == 0 && scanf_res == 0))
+        if (err != 0 || stop != token + len)
         {
-            flush_input(in_stream); //Flush bad input
-            errno = 0;
+            if (delim != '\n' && delim != EOF) flush_input (in_stream); //Flush bad input
             fprintf (out_stream, "Bad input, please enter not very big number\n");
         }
-        else break;
-    }
-
-    if (errno != 0) {
-        return errno;
+        else
+        {
+            if (delim != EOF) ungetc (delim, in_stream);
+            return 0;
+        }
     }
-
-    assert (scanf_res == 1 || scanf_res == EOF);
-
-    if (scanf_res == 1)  return 0;
-    else                 return EIO;
 }
 
 int input_coeffs (int n_coeffs, double coeffs[], FILE *in_stream, FILE *out_stream)
@@ -227,13 +618,13 @@ int parse_coeffs (int n_coeffs, double coeffs[], char **strings)
     {
         assert (strings[i] != NULL && "pointer can't be null");
 
-        char *start = strings[i];
-        char **end = &strings[i];
+        const char *start = strings[i];
+        const char *stop  = start;
 
-        coeffs[i] = strtod (start, end);
+        int err = parse_double (start, start + strlen (start), &coeffs[i], &stop);
 
         //Nothing converted or bad input
-        if (start == *end || !isfinite(coeffs[i])) 
+        if (err == EINVAL || !isfinite(coeffs[i])) 
         {
             return -1;
         }
@@ -1,14 +1,21 @@
 #ifndef QUAD_EQUATION_SOLVER_H
 #define QUAD_EQUATION_SOLVER_H
 
+#include <stdio.h>
+#include <stddef.h>
+
 ///@brief Number of equation roots
 enum num_roots {
+    FOUR_ROOTS   =  4,
+    THREE_ROOTS  =  3,
     TWO_ROOTS    =  2,
     ONE_ROOT     =  1,
     ZERO_ROOTS   =  0,
     INF_ROOTS    = -1,
     /// Coefficient out of range
-    ERANGE_SOLVE = -2
+    ERANGE_SOLVE = -2,
+    /// Two complex conjugate roots x1 + i*x2 and x1 - i*x2, x2 is positive. Returned by complex solvers only
+    COMPLEX_ROOTS = -3
 };
 
 /**@brief Solve linear equation, write root into given variable (x) and return number of solutions found
@@ -16,19 +23,17 @@ enum num_roots {
  * @param [in] k Linear coefficient
  * @param [in] b Free coefficient
  * @param [out] x Variable to store equation root
- * @return Number of equation roots
+ * @return Number of equation roots, ERANGE_SOLVE if root is out of double range
  */
 enum num_roots solve_lin_eq (double k, double b, double *x);
 
 /**@brief Solve quadratic equation, write roots into given variables (x1&x2) and return number of solutions found or error
  *
  * Possible errors
- * 1. ERANGE_SOLVE -- overflow in internal calculations
+ * 1. ERANGE_SOLVE -- root is out of double range
  *
- * @note Overflow checks:
- * 1. b^2 < DOUBLE_MAX
- * 2. abs(4*a*c) < DOUBLE_MAX
- * 3. abs(b^2 - 4*a*c) < DOUBLE_MAX
+ * Coefficients bigger than BATCH_SAFE_MAX are scaled by powers of two, so intermediate values never overflow
+ * and any finite coefficients with representable roots are solved.
  *
  * If there are less than two solutions, unused variables do not change their value.
  * If there is one solution, it is written in x1.
@@ -43,8 +48,291 @@ enum num_roots solve_lin_eq (double k, double b, double *x);
  */
 enum num_roots solve_quad_eq (double a, double b, double c, double *x1, double *x2);
 
-///@brief Print solution to stream
-void print_solution (enum num_roots n_roots, double roots[], FILE *stream);
+/**@brief Same as solve_quad_eq, but negative discriminant gives complex roots
+ *
+ * Complex roots are calculated from the same discriminant: real part -b/(2a) is written to x1,
+ * imaginary part sqrt(-disc)/(2|a|) to x2 and COMPLEX_ROOTS is returned instead of ZERO_ROOTS.
+ * Other results are the same as of solve_quad_eq.
+ */
+enum num_roots solve_quad_eq_complex (double a, double b, double c, double *x1, double *x2);
+
+///@brief Same as solve_lin_eq for float (see solve_lin_eq_t)
+enum num_roots solve_lin_eq_f (float k, float b, float *x);
+
+///@brief Same as solve_lin_eq for long double (see solve_lin_eq_t)
+enum num_roots solve_lin_eq_l (long double k, long double b, long double *x);
+
+///@brief Same as solve_quad_eq for float, zero tolerance and scaling limit are of float (see solve_quad_eq_t)
+enum num_roots solve_quad_eq_f (float a, float b, float c, float *x1, float *x2);
+
+///@brief Same as solve_quad_eq for long double, zero tolerance and scaling limit are of long double (see solve_quad_eq_t)
+enum num_roots solve_quad_eq_l (long double a, long double b, long double c, long double *x1, long double *x2);
+
+#ifdef __SIZEOF_FLOAT128__
+
+///@brief Same as solve_lin_eq for quad precision (GCC __float128)
+enum num_roots solve_lin_eq_q (__float128 k, __float128 b, __float128 *x);
+
+///@brief Same as solve_quad_eq for quad precision (GCC __float128)
+enum num_roots solve_quad_eq_q (__float128 a, __float128 b, __float128 c, __float128 *x1, __float128 *x2);
+
+#endif
+
+/**@brief Branch-free variant of solve_quad_eq for inputs with unpredictable number of roots
+ *
+ * Discriminant and roots are calculated for every case and selected, number of roots is calculated
+ * with arithmetic instead of control flow. Roots are calculated with numerically stable formula
+ * q = -(b + sign(b)*sqrt(disc))/2, x1 = q/a, x2 = c/q, so they are more accurate than of solve_quad_eq
+ * when 4ac is small compared to b^2. Number of roots is the same as solve_quad_eq returns.
+ *
+ * Unlike solve_quad_eq, all outputs are written: unused roots are set to NAN.
+ * Only equations with coefficients bigger than BATCH_SAFE_MAX take a branch to the scaled solve_quad_eq.
+ */
+enum num_roots solve_quad_eq_branchless (double a, double b, double c, double *x1, double *x2);
+
+/**@brief Variant of solve_quad_eq with accurate discriminant and relative zero tolerance
+ *
+ * Discriminant is calculated with FMA error-free products (Kahan), so it doesn't lose digits to cancellation
+ * when roots are close. It is zero, if it is below 4*DBL_EPSILON^2 of b^2 + |4ac|, so the number of roots
+ * doesn't depend on the scale of coefficients, unlike the absolute DBL_ERROR tolerance of solve_quad_eq.
+ * Coefficients are scaled by powers of two as in solve_quad_eq, so big coefficients don't overflow and small
+ * ones don't underflow, whatever the spread of their exponents. Roots are calculated with numerically stable
+ * formula, only equations with a exactly zero are linear and solved by solve_lin_eq.
+ *
+ * @return Number of equation roots, ERANGE_SOLVE if root is out of double range
+ */
+enum num_roots solve_quad_eq_accurate (double a, double b, double c, double *x1, double *x2);
+
+///@brief Solve every equation with solve_quad_eq_accurate, unused roots are set to NAN
+void solve_quad_eq_batch_accurate (size_t n, const double a[], const double b[], const double c[],
+                                   double x1[], double x2[], enum num_roots n_roots[]);
+
+///@brief Scalar quadratic solver implementation
+enum solver_mode {
+    SOLVER_CLASSIC    = 0, ///< solve_quad_eq: branches per case, vectorized batch kernels
+    SOLVER_BRANCHLESS = 1, ///< solve_quad_eq_branchless: selects and stable formula
+    SOLVER_ACCURATE   = 2  ///< solve_quad_eq_accurate: FMA discriminant with relative tolerance
+};
+
+///@brief Solve quadratic equation with given solver (see solve_quad_eq)
+enum num_roots solve_quad_eq_mode (enum solver_mode mode, double a, double b, double c, double *x1, double *x2);
+
+///@brief Instruction set used by batch solver
+enum simd_isa {
+    SIMD_GENERIC = 0,
+    SIMD_SSE2    = 1,
+    SIMD_AVX2    = 2,
+    SIMD_AVX512  = 3
+};
+
+/**@brief Solve n quadratic equations a[i]*x^2 + b[i]*x + c[i] = 0 stored as structure of arrays
+ *
+ * Uses the widest instruction set supported by the running CPU (see simd_isa_detect).
+ * Classification of every equation is the same as solve_quad_eq returns for it.
+ * Unlike solve_quad_eq, all outputs are written: unused roots are set to NAN.
+ *
+ * @param [in]  n       Number of equations
+ * @param [in]  a       Quadratic coefficients
+ * @param [in]  b       Linear coefficients
+ * @param [in]  c       Free coefficients
+ * @param [out] x1      Array to store first roots
+ * @param [out] x2      Array to store second roots
+ * @param [out] n_roots Array to store number of roots of each equation
+ */
+void solve_quad_eq_batch (size_t n, const double a[], const double b[], const double c[],
+                          double x1[], double x2[], enum num_roots n_roots[]);
+
+/**@brief Same as solve_quad_eq_batch, but with given solver
+ *
+ * SOLVER_CLASSIC uses SIMD kernels, SOLVER_BRANCHLESS calls solve_quad_eq_branchless for every equation,
+ * SOLVER_ACCURATE calls solve_quad_eq_accurate.
+ */
+void solve_quad_eq_batch_mode (enum solver_mode mode, size_t n, const double a[], const double b[], const double c[],
+                               double x1[], double x2[], enum num_roots n_roots[]);
+
+/**@brief Same as solve_quad_eq_batch_mode, but equations with negative discriminant get complex roots
+ *
+ * Equations are solved by solve_quad_eq_batch_mode, then real and imaginary parts of roots of equations
+ * with ZERO_ROOTS are calculated by branch-free loop. Results are the same as of solve_quad_eq_complex.
+ */
+void solve_quad_eq_batch_complex_mode (enum solver_mode mode, size_t n, const double a[], const double b[],
+                                       const double c[], double x1[], double x2[], enum num_roots n_roots[]);
+
+///@brief Same as solve_quad_eq_batch_complex_mode with SOLVER_CLASSIC
+void solve_quad_eq_batch_complex (size_t n, const double a[], const double b[], const double c[],
+                                  double x1[], double x2[], enum num_roots n_roots[]);
+
+///@brief Solve every equation with solve_quad_eq_branchless, unused roots are set to NAN
+void solve_quad_eq_batch_branchless (size_t n, const double a[], const double b[], const double c[],
+                                     double x1[], double x2[], enum num_roots n_roots[]);
+
+///@brief Same as solve_quad_eq_batch for float, solved with portable kernel (see solve_quad_eq_batch_t)
+void solve_quad_eq_batch_f (size_t n, const float a[], const float b[], const float c[],
+                            float x1[], float x2[], enum num_roots n_roots[]);
+
+/**@brief Refine roots returned by quadratic solver with Newton steps
+ *
+ * Roots of nearly double roots and of equations with cancellation in b +- sqrt(disc) may lose many digits.
+ * Up to two Newton steps are made with the residual evaluated by compensated Horner scheme (FMA based),
+ * which is as accurate as if it was calculated in twice the precision. A step is taken only if it
+ * decreases the residual and moves the root less than half of the distance to the other one.
+ * Only TWO_ROOTS are polished: double roots and linear roots are left as is.
+ *
+ * @param [in]     n_roots Number of roots returned by solver
+ * @param [in,out] x1      Root to polish
+ * @param [in,out] x2      Root to polish
+ * @return true if any root has changed
+ */
+bool polish_quad_roots (double a, double b, double c, enum num_roots n_roots, double *x1, double *x2);
+
+/**@brief Polish roots of n equations solved by batch solver with polish_quad_roots
+ *
+ * @param [out] polished Whether roots of every equation have changed, can be NULL
+ * @return Number of equations with changed roots
+ */
+int polish_quad_eq_batch (size_t n, const double a[], const double b[], const double c[],
+                          const enum num_roots n_roots[], double x1[], double x2[], bool polished[]);
+
+/**@brief Solve cubic equation a*x^3 + b*x^2 + c*x + d = 0, write roots into given variables and return number of distinct real roots
+ *
+ * Equation is divided by a and reduced to t^3 + p*t + q = 0 with x = t - b/(3a). Three real roots are calculated
+ * with trigonometric form, the only real root with Cardano formula in form, which does not cancel.
+ * If discriminant is zero, there are a single root (x1) and a double root (x2), or one triple root. Discriminant
+ * and p are zero, if they are below their rounding errors, which scale with roots, so roots of any scale are
+ * classified the same way. Roots are polished by Newton iterations on the original equation.
+ * If a is zero, the equation is solved by solve_quad_eq (b, c, d, x1, x2).
+ *
+ * If there are less than three solutions, unused variables do not change their value.
+ * The order of roots is not guaranteed.
+ *
+ * @return Number of equation roots, ERANGE_SOLVE if root or intermediate value is out of double range
+ */
+enum num_roots solve_cubic_eq (double a, double b, double c, double d, double *x1, double *x2, double *x3);
+
+/**@brief Solve n cubic equations stored as structure of arrays
+ *
+ * Every case is evaluated for every equation without branches and the result is selected,
+ * quadratic equations (zero a) and overflowed ones are solved by solve_cubic_eq. Results are the same as
+ * of solve_cubic_eq. Unused roots are set to NAN, equations with not finite coefficients get ERANGE_SOLVE.
+ */
+void solve_cubic_eq_batch (size_t n, const double a[], const double b[], const double c[], const double d[],
+                           double x1[], double x2[], double x3[], enum num_roots n_roots[]);
+
+/**@brief Solve quartic equation a*x^4 + b*x^3 + c*x^2 + d*x + e = 0, write roots into given variables and return number
+ *        of distinct real roots
+ *
+ * Equation is divided by a and reduced to y^4 + p*y^2 + q*y + r = 0 with x = y - b/(4a). For zero q it is solved as
+ * quadratic equation of y^2, else it is factored into two quadratics with root of resolvent cubic (Ferrari method),
+ * which are solved by solve_cubic_eq and solve_quad_eq. Roots are polished by Newton iterations on the original equation.
+ * If a is zero, the equation is solved by solve_cubic_eq (b, c, d, e, x1, x2, x3).
+ *
+ * If there are less than four solutions, unused variables do not change their value.
+ * The order of roots is not guaranteed.
+ *
+ * @return Number of equation roots, ERANGE_SOLVE if root or intermediate value is out of double range
+ */
+enum num_roots solve_quartic_eq (double a, double b, double c, double d, double e,
+                                 double *x1, double *x2, double *x3, double *x4);
+
+/**@brief Solve n quartic equations stored as structure of arrays with solve_quartic_eq
+ *
+ * Unused roots are set to NAN, equations with not finite coefficients get ERANGE_SOLVE.
+ */
+void solve_quartic_eq_batch (size_t n, const double a[], const double b[], const double c[], const double d[],
+                             const double e[], double x1[], double x2[], double x3[], double x4[],
+                             enum num_roots n_roots[]);
+
+///@brief Size of scratch memory of solve_poly_eq in bytes, it is enough for any smaller degree too
+size_t poly_scratch_size (int degree);
+
+/**@brief Find all complex roots of polynomial coeffs[0]*x^degree + coeffs[1]*x^(degree-1) + ... + coeffs[degree]
+ *
+ * All roots are refined simultaneously by Aberth-Ehrlich iterations, O(degree^2) operations per iteration.
+ * Initial roots are placed on circles given by Newton polygon of coefficients (Bini), so iterations converge
+ * in few steps for any degree. Root is converged, when polynomial value is below its rounding error.
+ * Multiple roots are found with accuracy about DBL_EPSILON^(1/multiplicity).
+ *
+ * @param[in]  degree   Degree of polynomial
+ * @param[in]  coeffs   degree+1 coefficients, from biggest exponent (zero index) to lowest exponent
+ * @param[out] re       degree real parts of roots, order of roots is not defined
+ * @param[out] im       degree imaginary parts of roots
+ * @param      scratch  Memory of poly_scratch_size (degree) bytes aligned for double, nothing is allocated
+ *
+ * @return 0 on success, EINVAL if coeffs[0] is zero, ERANGE if coefficient is not finite or roots don't converge
+ */
+int solve_poly_eq (int degree, const double coeffs[], double re[], double im[], void *scratch);
+
+/**@brief Solve n polynomials of the same degree with one scratch memory
+ *
+ * Coefficients of polynomial i are coeffs[i*(degree+1) .. (i+1)*(degree+1)), its roots are written to
+ * re[i*degree .. (i+1)*degree) and im[i*degree .. (i+1)*degree), status[i] is the value returned by solve_poly_eq.
+ * Roots of failed polynomials are NAN.
+ *
+ * @return Number of failed polynomials
+ */
+int solve_poly_eq_batch (size_t n, int degree, const double coeffs[], double re[], double im[], void *scratch,
+                         int status[]);
+
+struct thread_pool;
+
+/**@brief Same as solve_quad_eq_batch, but equations are split into chunks solved by pool workers
+ *
+ * Results are written to the same positions as by solve_quad_eq_batch, so output does not depend on number of threads.
+ */
+void solve_quad_eq_batch_parallel (struct thread_pool *pool, size_t n, const double a[], const double b[], const double c[],
+                                   double x1[], double x2[], enum num_roots n_roots[]);
+
+///@brief Same as solve_quad_eq_batch_parallel, but with given solver
+void solve_quad_eq_batch_parallel_mode (struct thread_pool *pool, enum solver_mode mode, size_t n,
+                                        const double a[], const double b[], const double c[],
+                                        double x1[], double x2[], enum num_roots n_roots[]);
+
+///@brief Same as solve_quad_eq_batch_complex_mode, but equations are split into chunks solved by pool workers
+void solve_quad_eq_batch_complex_parallel_mode (struct thread_pool *pool, enum solver_mode mode, size_t n,
+                                                const double a[], const double b[], const double c[],
+                                                double x1[], double x2[], enum num_roots n_roots[]);
+
+///@brief Same as solve_cubic_eq_batch, but equations are split into chunks solved by pool workers
+void solve_cubic_eq_batch_parallel (struct thread_pool *pool, size_t n,
+                                    const double a[], const double b[], const double c[], const double d[],
+                                    double x1[], double x2[], double x3[], enum num_roots n_roots[]);
+
+/**@brief Same as solve_quad_eq_batch, but with given instruction set
+ *
+ * @note Unsupported instruction set is replaced with SIMD_GENERIC
+ */
+void solve_quad_eq_batch_isa (enum simd_isa isa, size_t n, const double a[], const double b[], const double c[],
+                              double x1[], double x2[], enum num_roots n_roots[]);
+
+/**@brief Portable kernel of solve_quad_eq_batch
+ *
+ * Equations with a coefficient bigger than BATCH_SAFE_MAX by absolute value (or NaN) are left as ERANGE_SOLVE,
+ * they are solved by solve_quad_eq_batch_fixup.
+ *
+ * @note Loop body has no branches and no calls except sqrt, so it can be auto-vectorized
+ * (requires -fno-math-errno for vector sqrt)
+ */
+void solve_quad_eq_batch_generic (size_t n, const double a[], const double b[], const double c[],
+                                  double x1[], double x2[], enum num_roots n_roots[]);
+
+/**@brief Solve equations, which batch kernel left as ERANGE_SOLVE, with solve_quad_eq
+ *
+ * Equations with not finite coefficients stay ERANGE_SOLVE.
+ */
+void solve_quad_eq_batch_fixup (size_t n, const double a[], const double b[], const double c[],
+                                double x1[], double x2[], enum num_roots n_roots[]);
+
+///@brief Widest instruction set supported by the running CPU
+enum simd_isa simd_isa_detect (void);
+
+///@brief Check if the running CPU supports given instruction set
+bool simd_isa_supported (enum simd_isa isa);
+
+///@brief Instruction set name
+const char *simd_isa_name (enum simd_isa isa);
+
+///@brief Print solution to stream in human readable format (see format_solution), roots are not modified
+void print_solution (enum num_roots n_roots, const double roots[], FILE *stream);
 
 /**
  * @brief Read coefficients from in_stream and write them to given variables using out_stream for asking question.
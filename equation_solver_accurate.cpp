@@ -0,0 +1,144 @@
+#include <math.h>
+#include <cassert>
+#include "common_equation_solver.h"
+#include "equation_solver.h"
+#include "equation_solver_const.h"
+
+/// Discriminant is zero, if it is below this part of b^2 + |4ac|. It is about the error of accurate discriminant,
+/// so roots, which differ only in the last bits, are one double root
+static const double DISC_REL_ERROR = 4 * DBL_EPSILON * DBL_EPSILON;
+
+///@brief Discriminant and magnitude of its terms
+struct quad_disc
+{
+    double value; ///< b^2 - 4ac
+    double scale; ///< b^2 + |4ac|
+};
+
+static inline quad_disc disc_accurate (double a, double b, double c);
+
+num_roots solve_quad_eq_accurate (double a, double b, double c, double *x1, double *x2)
+{
+    assert (isfinite(a) && "parameter must be finite");
+    assert (isfinite(b) && "parameter must be finite");
+    assert (isfinite(c) && "parameter must be finite");
+    assert (x1 != NULL  && "pointer can't be null");
+    assert (x2 != NULL  && "pointer can't be null");
+    assert (x1 != x2    && "pointers can't be same");
+
+    _STAT (STAT_QUAD_CALLS);
+
+    // The equation is linear only if a is exactly zero: a tiny a still gives a huge root -b/a
+
+    if (!(fabs (a) > 0))
+    {
+        _STAT (STAT_LINEAR);
+        return solve_lin_eq (b, c, x1);
+    }
+
+    // Coefficients are split into mantissas and exponents, as in solve_quad_eq_scaled, the discriminant is
+    // scaled by 2^(-2e), where 2^e is the scale of the biggest of b and sqrt(4ac). Mantissas never underflow,
+    // so a coefficient much smaller than others is not flushed to zero, and roots are scaled back with ldexp.
+    int a_e = 0, b_e = 0, c_e = 0;
+
+    double a_m = split_exp (a, &a_e);
+    double b_m = split_exp (b, &b_e);
+    double c_m = split_exp (c, &c_e);
+
+    // e >= (a_e + c_e) / 2, rounded up
+    int ac_e = a_e + c_e;
+    int e    = b_e > (ac_e + (ac_e & 1)) / 2 ? b_e : (ac_e + (ac_e & 1)) / 2;
+
+    // 4ac is scaled by 2^(ac_e - 2e) <= 1, the shift is split between a and c, so their product underflows
+    // only if it is below 2^-1000 of b^2, much less than the tolerance
+    int shift = 2*e - ac_e;
+
+    double b_s = ldexp (b_m, b_e - e);
+    double a_s = ldexp (a_m, -(shift / 2));
+    double c_s = ldexp (c_m, -(shift - shift / 2));
+
+    // b_s^2 + |4ac_s| is in [1/4, 5] unless b = c = 0, so the relative tolerance doesn't underflow
+    quad_disc disc = disc_accurate (a_s, b_s, c_s);
+
+    double root1 = 0, root2 = 0;
+
+    if (fabs (disc.value) <= DISC_REL_ERROR * disc.scale)
+    {
+        _STAT (STAT_DISC_ZERO);
+
+        root1 = ldexp (-b_m / a_m / 2, b_e - a_e);
+
+        _CHECK_RANGE (isfinite (root1));
+
+        *x1 = root1;
+        return ONE_ROOT;
+    }
+    else if (disc.value < 0)
+    {
+        _STAT (STAT_DISC_NEG);
+        return ZERO_ROOTS;
+    }
+
+    _STAT (STAT_GENERAL);
+
+    // Stable formula, |q| >= sqrt(disc) / 2 > 0, q is scaled by 2^(-e)
+    double q = -(b_s + copysign (sqrt (disc.value), b_s)) / 2;
+
+    root1 = ldexp (q / a_m, e - a_e);
+    root2 = ldexp (c_m / q, c_e - e);
+
+    _CHECK_RANGE (isfinite (root1) && isfinite (root2));
+
+    *x1 = root1;
+    *x2 = root2;
+    return TWO_ROOTS;
+}
+
+void solve_quad_eq_batch_accurate (size_t n, const double a[], const double b[], const double c[],
+                                   double x1[], double x2[], enum num_roots n_roots[])
+{
+    assert (a       != NULL && "pointer can't be null");
+    assert (b       != NULL && "pointer can't be null");
+    assert (c       != NULL && "pointer can't be null");
+    assert (x1      != NULL && "pointer can't be null");
+    assert (x2      != NULL && "pointer can't be null");
+    assert (n_roots != NULL && "pointer can't be null");
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        double root1 = NAN, root2 = NAN;
+
+        if (!isfinite (a[i]) || !isfinite (b[i]) || !isfinite (c[i]))
+        {
+            n_roots[i] = ERANGE_SOLVE;
+        }
+        else
+        {
+            n_roots[i] = solve_quad_eq_accurate (a[i], b[i], c[i], &root1, &root2);
+        }
+
+        // Unused roots are NAN, as in other batch solvers
+        x1[i] = n_roots[i] >= ONE_ROOT  ? root1 : NAN;
+        x2[i] = n_roots[i] == TWO_ROOTS ? root2 : NAN;
+    }
+}
+
+/**
+ * @brief b^2 - 4ac with FMA error-free products (Kahan)
+ *
+ * Rounding errors of b*b and 4a*c are found exactly with fma and added to the rounded difference, which
+ * cancels when roots are close. The result is accurate to a few ulps of itself plus about DBL_EPSILON^2
+ * of the terms, instead of DBL_EPSILON of the terms of plain b*b - 4*a*c. Cost is two fma per equation.
+ */
+static inline quad_disc disc_accurate (double a, double b, double c)
+{
+    double four_a = 4 * a;
+
+    double prod_b  = b * b;
+    double prod_ac = four_a * c;
+
+    double err_b  = fma (b, b, -prod_b);
+    double err_ac = fma (four_a, c, -prod_ac);
+
+    return {(prod_b - prod_ac) + (err_b - err_ac), prod_b + fabs (prod_ac)};
+}
@@ -0,0 +1,400 @@
+#ifndef QUAD_EQUATION_SOLVER_CONST_H
+#define QUAD_EQUATION_SOLVER_CONST_H
+
+#include <type_traits>
+#include "common_equation_solver.h"
+#include "equation_solver.h"
+
+/*
+ * Core of solve_lin_eq and solve_quad_eq, which can be evaluated at compile time, so tables of roots
+ * for fixed coefficients can be built into the binary:
+ *
+ *     constexpr eq_solution<double> sol = solve_quad_eq_const (1.0, -3.0, 2.0);
+ *
+ * Math functions are replaced with loops and Newton iterations in constant evaluation only,
+ * at run time math.h functions are called, so run time solvers (solve_quad_eq_t and its wrappers)
+ * are implemented with these functions and return the same results.
+ */
+
+///@brief Solution of equation returned by value
+template <typename T>
+struct eq_solution
+{
+    enum num_roots n_roots;
+    T x1; ///< Root if n_roots >= ONE_ROOT, real part of roots if n_roots == COMPLEX_ROOTS, else zero
+    T x2; ///< Root if n_roots == TWO_ROOTS, imaginary part of roots if n_roots == COMPLEX_ROOTS, else zero
+};
+
+///@brief Exponent of zero in split_exp, it is less than exponent of any T value, but its doubled sums do not overflow int
+template <typename T>
+constexpr int ZERO_EXP = 4 * fp_traits<T>::min_exp;
+
+///@brief isfinite, which can be calculated at compile time
+template <typename T>
+constexpr bool fp_isfinite (T x)
+{
+    if (std::is_constant_evaluated ()) return fp_abs (x) <= fp_traits<T>::max;
+
+    return isfinite (x);
+}
+
+/**
+ * @brief ldexp, which can be calculated at compile time (result is exact unless it is subnormal)
+ *
+ * Overflow is not a constant expression, so infinity is returned before it.
+ */
+template <typename T>
+constexpr T fp_ldexp (T x, int exp)
+{
+    if (!std::is_constant_evaluated ()) return ldexp (x, exp);
+
+    for (; exp > 0; --exp)
+    {
+        if (fp_abs (x) > fp_traits<T>::max / 2) return x > 0 ? (T) __builtin_huge_val () : (T) -__builtin_huge_val ();
+        x *= 2;
+    }
+
+    for (; exp < 0; ++exp) x /= 2;
+
+    return x;
+}
+
+///@brief frexp, which can be calculated at compile time
+template <typename T>
+constexpr T fp_frexp (T x, int *exp)
+{
+    if (!std::is_constant_evaluated ()) return frexp (x, exp);
+
+    *exp = 0;
+
+    if (!(fp_abs (x) > 0) || !fp_isfinite (x)) return x;
+
+    for (; fp_abs (x) >= 1;   ++*exp) x /= 2;
+    for (; fp_abs (x) <  0.5; --*exp) x *= 2;
+
+    return x;
+}
+
+/**
+ * @brief sqrt, which can be calculated at compile time
+ *
+ * In constant evaluation the argument is scaled to [1, 4) by powers of 4, Newton iterations give root with
+ * error of an ulp, the last step uses exact residual x - r*r (Dekker's product), so the root is rounded
+ * like one of sqrt.
+ */
+template <typename T>
+constexpr T fp_sqrt (T x)
+{
+    if (!std::is_constant_evaluated ()) return sqrt (x);
+
+    // Zero or infinity, x is never negative in solvers
+    if (!(x > 0) || !fp_isfinite (x)) return x;
+
+    int exp = 0;
+    for (; x >= 4; exp++) x /= 4;
+    for (; x <  1; exp--) x *= 4;
+
+    // Relative error is below 1/2 and it is squared on every step, 8 steps are enough for 113 bit mantissa
+    T root = 1.5;
+    for (int i = 0; i < 8; ++i) root = (root + x / root) / 2;
+
+    // root * root = prod + prod_err exactly: Veltkamp split of root into halves, exact in [1, 2]
+    const T split = fp_pow2<T> ((fp_traits<T>::mant_dig + 1) / 2) + 1;
+
+    T tmp  = split * root;
+    T high = tmp - (tmp - root);
+    T low  = root - high;
+
+    T prod     = root * root;
+    T prod_err = ((high * high - prod) + 2 * high * low) + low * low;
+
+    root += ((x - prod) - prod_err) / (2 * root);
+
+    return exp >= 0 ? root * fp_pow2<T> (exp) : root / fp_pow2<T> (-exp);
+}
+
+/**
+ * @brief Split x into mantissa in [0.5, 1) and power of two exponent (see frexp)
+ *
+ * Exponent of zero is far below exponents of all other values, so zero never defines scale.
+ */
+template <typename T>
+constexpr T split_exp (T x, int *exp)
+{
+    T mant = fp_frexp (x, exp);
+
+    if (!(fp_abs (x) > 0)) *exp = ZERO_EXP<T>;
+
+    return mant;
+}
+
+///@brief Same as solve_lin_eq, ERANGE_SOLVE is returned if root is out of range of T
+template <typename T>
+constexpr eq_solution<T> solve_lin_eq_const (T k, T b)
+{
+    // k = 0 and there are either no solutions or infinitely many (when b=0)
+    if (is_zero(k))
+    {
+        _STAT (STAT_LIN_DEGENERATE);
+
+        if (is_zero(b))  return {INF_ROOTS,  0, 0};
+        else             return {ZERO_ROOTS, 0, 0};
+    }
+
+    // Overflow is not a constant expression, |k| < 1 here, so k * max is finite
+    if (std::is_constant_evaluated () && fp_abs (k) < 1 && fp_abs (b) > fp_abs (k) * fp_traits<T>::max)
+    {
+        return {ERANGE_SOLVE, 0, 0};
+    }
+
+    // Division is correctly rounded, so it overflows only if the root is not representable
+    T root = -b / k;
+
+    if (!fp_isfinite (root))
+    {
+        _STAT (STAT_RANGE_LIN_ROOT);
+        return {ERANGE_SOLVE, 0, 0};
+    }
+
+    return {ONE_ROOT, root, 0};
+}
+
+/**
+ * @brief Solve quadratic equation with nonzero a and coefficients up to fp_traits<T>::safe_max by absolute value
+ *
+ * If COMPLEX is true, negative discriminant gives COMPLEX_ROOTS instead of ZERO_ROOTS.
+ */
+template <typename T, bool COMPLEX = false>
+constexpr eq_solution<T> solve_quad_eq_direct (T a, T b, T c)
+{
+    T disc = b*b - 4*a*c;
+
+    if (is_zero(disc))
+    {
+        _STAT (STAT_DISC_ZERO);
+        return {ONE_ROOT, -b / a / 2, 0};
+    }
+    else if (disc < 0)
+    {
+        _STAT (STAT_DISC_NEG);
+
+        if constexpr (COMPLEX) return {COMPLEX_ROOTS, -b / a / 2, fp_sqrt (-disc) / fp_abs (a) / 2};
+
+        return {ZERO_ROOTS, 0, 0};
+    }
+
+    if (is_zero(b))
+    {
+        _STAT (STAT_B_ZERO);
+        return {TWO_ROOTS, -fp_sqrt (-c / a), +fp_sqrt (-c / a)};
+    }
+    else if (is_zero(c))
+    {
+        _STAT (STAT_C_ZERO);
+        return {TWO_ROOTS, 0, -b / a};
+    }
+
+    _STAT (STAT_GENERAL);
+
+    T sq_disc = fp_sqrt(disc);
+
+    return {TWO_ROOTS, (-b + sq_disc) / a / 2, (-b - sq_disc) / a / 2};
+}
+
+/**
+ * @brief Solve quadratic equation with nonzero a and any finite coefficients
+ *
+ * If COMPLEX is true, negative discriminant gives COMPLEX_ROOTS instead of ZERO_ROOTS.
+ */
+template <typename T, bool COMPLEX = false>
+constexpr eq_solution<T> solve_quad_eq_scaled (T a, T b, T c)
+{
+    // Everything is calculated with mantissas and power of two exponents: a = a_m * 2^a_e, ...
+    // Discriminant is scaled by 2^(-2*e), where 2^e is the scale of the biggest of b and sqrt(4ac),
+    // so it can't overflow. Scaling by powers of two is exact, so without overflow and underflow
+    // results are the same as of unscaled formulas.
+    int a_e = 0, b_e = 0, c_e = 0;
+
+    T a_m = split_exp (a, &a_e);
+    T b_m = split_exp (b, &b_e);
+    T c_m = split_exp (c, &c_e);
+
+    // e >= (a_e + c_e) / 2, rounded up
+    int ac_e = a_e + c_e;
+    int e    = b_e > (ac_e + (ac_e & 1)) / 2 ? b_e : (ac_e + (ac_e & 1)) / 2;
+
+    T b_s  = fp_ldexp (b_m, b_e - e);
+    T disc = b_s*b_s - 4 * fp_ldexp (a_m * c_m, ac_e - 2*e);
+
+    T root1 = 0, root2 = 0;
+
+    if (fp_abs (disc) < fp_ldexp (fp_traits<T>::error, -2*e))
+    {
+        _STAT (STAT_DISC_ZERO);
+
+        root1 = fp_ldexp (-b_m / a_m / 2, b_e - a_e);
+
+        if (!fp_isfinite (root1))
+        {
+            _STAT (STAT_RANGE_ONE_ROOT);
+            return {ERANGE_SOLVE, 0, 0};
+        }
+
+        return {ONE_ROOT, root1, 0};
+    }
+    else if (disc < 0)
+    {
+        _STAT (STAT_DISC_NEG);
+
+        if constexpr (COMPLEX)
+        {
+            // Square root of scaled discriminant is scaled by 2^(-e)
+            root1 = fp_ldexp (-b_m / a_m / 2, b_e - a_e);
+            root2 = fp_ldexp (fp_sqrt (-disc) / fp_abs (a_m) / 2, e - a_e);
+
+            if (!fp_isfinite (root1) || !fp_isfinite (root2))
+            {
+                _STAT (STAT_RANGE_TWO_ROOTS);
+                return {ERANGE_SOLVE, 0, 0};
+            }
+
+            return {COMPLEX_ROOTS, root1, root2};
+        }
+
+        return {ZERO_ROOTS, 0, 0};
+    }
+
+    if (is_zero(b))
+    {
+        _STAT (STAT_B_ZERO);
+
+        // sqrt (-c / a) with even exponent
+        int ratio_e = c_e - a_e;
+        T   ratio_m = -c_m / a_m;
+
+        if (ratio_e & 1)
+        {
+            ratio_m *= 2;
+            ratio_e -= 1;
+        }
+
+        root2 = fp_ldexp (fp_sqrt (ratio_m), ratio_e / 2);
+        root1 = -root2;
+    }
+    else if (is_zero(c))
+    {
+        _STAT (STAT_C_ZERO);
+
+        root1 = 0;
+        root2 = fp_ldexp (-b_m / a_m, b_e - a_e);
+    }
+    else
+    {
+        _STAT (STAT_GENERAL);
+
+        T sq_disc = fp_sqrt(disc);
+
+        root1 = fp_ldexp ((-b_s + sq_disc) / a_m / 2, e - a_e);
+        root2 = fp_ldexp ((-b_s - sq_disc) / a_m / 2, e - a_e);
+    }
+
+    if (!fp_isfinite (root1) || !fp_isfinite (root2))
+    {
+        _STAT (STAT_RANGE_TWO_ROOTS);
+        return {ERANGE_SOLVE, 0, 0};
+    }
+
+    return {TWO_ROOTS, root1, root2};
+}
+
+///@brief Same as solve_quad_eq (solve_quad_eq_complex if COMPLEX is true), coefficients must be finite
+template <typename T, bool COMPLEX = false>
+constexpr eq_solution<T> solve_quad_eq_const (T a, T b, T c)
+{
+    _STAT (STAT_QUAD_CALLS);
+
+    // The equation is linear
+    if (is_zero(a))
+    {
+        _STAT (STAT_LINEAR);
+        return solve_lin_eq_const (b, c);
+    }
+
+    const T safe_max = fp_traits<T>::safe_max;
+
+    // Nothing overflows with smaller coefficients, so they don't need scaling
+    if (fp_abs (a) <= safe_max && fp_abs (b) <= safe_max && fp_abs (c) <= safe_max)
+    {
+        return solve_quad_eq_direct<T, COMPLEX> (a, b, c);
+    }
+
+    _STAT (STAT_SCALED);
+    return solve_quad_eq_scaled<T, COMPLEX> (a, b, c);
+}
+
+/**
+ * @brief Number of set bits in mask of at most 8 lanes
+ *
+ * Without -mpopcnt __builtin_popcount is a library call, which costs more than the kernel itself.
+ */
+constexpr uint64_t count_lanes (unsigned mask)
+{
+    mask &= 0xFF;
+    mask  = mask - ((mask >> 1) & 0x55);
+    mask  = (mask & 0x33) + ((mask >> 2) & 0x33);
+
+    return (mask + (mask >> 4)) & 0x0F;
+}
+
+/**
+ * @brief Count branches of solve_quad_eq taken by lanes of branch-free batch kernel
+ *
+ * Bit i of every mask is the condition of lane i, as computed by the kernel, so no second pass over coefficients
+ * is needed. Branches are selected with the same conditions as in solve_quad_eq_direct by bitwise operations and
+ * counted with count_lanes. Lanes out of range are skipped, they are counted by scalar solver in fixup.
+ * Nothing without QUAD_STATS.
+ */
+inline void count_quad_eq_lanes (uint64_t counts[], unsigned in_range, unsigned a_zero, unsigned b_zero,
+                                 unsigned c_zero, unsigned disc_zero, unsigned disc_neg)
+{
+#ifdef QUAD_STATS
+
+    unsigned lin  = in_range & a_zero;
+    unsigned quad = in_range & ~a_zero;
+    unsigned pos  = quad & ~disc_zero & ~disc_neg;
+
+    counts[STAT_QUAD_CALLS]     += count_lanes (in_range);
+    counts[STAT_LINEAR]         += count_lanes (lin);
+    counts[STAT_LIN_DEGENERATE] += count_lanes (lin & b_zero);
+    counts[STAT_DISC_ZERO]      += count_lanes (quad & disc_zero);
+    counts[STAT_DISC_NEG]       += count_lanes (quad & ~disc_zero & disc_neg);
+    counts[STAT_B_ZERO]         += count_lanes (pos & b_zero);
+    counts[STAT_C_ZERO]         += count_lanes (pos & ~b_zero & c_zero);
+    counts[STAT_GENERAL]        += count_lanes (pos & ~b_zero & ~c_zero);
+
+#else
+
+    (void) counts, (void) in_range, (void) a_zero, (void) b_zero, (void) c_zero, (void) disc_zero, (void) disc_neg;
+
+#endif
+}
+
+///@brief Add counts of count_quad_eq_lanes to counters of calling thread, once per batch. Zero counts are added too:
+///       adding is a load and a store of thread counter, cheaper than a branch per counter in scalar solver
+inline void add_quad_eq_counts (const uint64_t counts[])
+{
+#ifdef QUAD_STATS
+
+    for (int i = 0; i < N_SOLVER_STATS; ++i)
+    {
+        _STAT_ADD ((enum solver_stat) i, counts[i]);
+    }
+
+#else
+
+    (void) counts;
+
+#endif
+}
+
+#endif //QUAD_EQUATION_SOLVER_CONST_H
@@ -0,0 +1,320 @@
+#include <math.h>
+#include <cassert>
+#include "common_equation_solver.h"
+#include "equation_solver.h"
+
+/// 2*pi/3, angle between trigonometric roots
+static const double THIRD_TURN = 2.0943951023931954923;
+
+/// Relative rounding error of p and q: they are sums of a few rounded products of monic coefficients
+static const double DEPRESS_ERROR = 8 * DBL_EPSILON;
+
+/// Max number of Newton steps of polishing
+static const int POLISH_STEPS = 2;
+
+/// Max Newton step relative to the scale of roots: the error of cubic root of triple root is about DBL_EPSILON^(1/3)
+static const double POLISH_MAX_STEP = 3e-5;
+
+///@brief Depressed cubic t^3 + p*t + q = 0 of a*x^3 + b*x^2 + c*x + d = 0, x = t - shift
+struct depressed_cubic
+{
+    double b;          ///< Coefficients of monic cubic x^3 + b*x^2 + c*x + d
+    double c;
+    double d;
+    double shift;
+    double p;
+    double q;
+    double half_q;
+    double third_p;
+    double disc;       ///< (q/2)^2 + (p/3)^3: three real roots if negative, one if positive
+    double p_error;    ///< Rounding error of p, relative to its terms c and shift^2, not to p, which cancels
+    double disc_error; ///< Rounding error of disc caused by errors of p and q
+    double root_scale; ///< Upper bound of |x|
+};
+
+static inline void   depress_cubic     (double a, double b, double c, double d, depressed_cubic *cubic);
+static inline double cubic_one_root    (const depressed_cubic *cubic);
+static inline void   cubic_three_roots (const depressed_cubic *cubic, double *x1, double *x2, double *x3);
+static inline void   cubic_two_roots   (const depressed_cubic *cubic, double *x1, double *x2);
+static inline double cubic_polish      (const depressed_cubic *cubic, double x);
+
+num_roots solve_cubic_eq (double a, double b, double c, double d, double *x1, double *x2, double *x3)
+{
+    assert (isfinite(a) && "parameter must be finite");
+    assert (isfinite(b) && "parameter must be finite");
+    assert (isfinite(c) && "parameter must be finite");
+    assert (isfinite(d) && "parameter must be finite");
+    assert (x1 != NULL  && "pointer can't be null");
+    assert (x2 != NULL  && "pointer can't be null");
+    assert (x3 != NULL  && "pointer can't be null");
+    assert (x1 != x2 && x1 != x3 && x2 != x3 && "pointers can't be same");
+
+    // The equation is quadratic
+
+    if (is_zero(a))
+    {
+        return solve_quad_eq (b, c, d, x1, x2);
+    }
+
+    depressed_cubic cubic = {};
+    depress_cubic (a, b, c, d, &cubic);
+
+    _CHECK_RANGE (isfinite (cubic.disc));
+
+    double root1 = 0, root2 = 0, root3 = 0;
+
+    // Zero checks are relative to rounding errors of p and q, which scale with roots, not to DBL_ERROR
+    if (fabs (cubic.disc) <= cubic.disc_error)
+    {
+        if (fabs (cubic.p) <= cubic.p_error)
+        {
+            root1 = cubic_polish (&cubic, -cubic.shift);
+
+            _CHECK_RANGE (isfinite (root1));
+
+            *x1 = root1;
+            return ONE_ROOT;
+        }
+
+        cubic_two_roots (&cubic, &root1, &root2);
+
+        root1 = cubic_polish (&cubic, root1);
+        root2 = cubic_polish (&cubic, root2);
+
+        _CHECK_RANGE (isfinite (root1) && isfinite (root2));
+
+        *x1 = root1;
+        *x2 = root2;
+        return TWO_ROOTS;
+    }
+    else if (cubic.disc > 0)
+    {
+        root1 = cubic_polish (&cubic, cubic_one_root (&cubic));
+
+        _CHECK_RANGE (isfinite (root1));
+
+        *x1 = root1;
+        return ONE_ROOT;
+    }
+
+    cubic_three_roots (&cubic, &root1, &root2, &root3);
+
+    root1 = cubic_polish (&cubic, root1);
+    root2 = cubic_polish (&cubic, root2);
+    root3 = cubic_polish (&cubic, root3);
+
+    _CHECK_RANGE (isfinite (root1) && isfinite (root2) && isfinite (root3));
+
+    *x1 = root1;
+    *x2 = root2;
+    *x3 = root3;
+    return THREE_ROOTS;
+}
+
+/**
+ * @brief Divide by a and substitute x = t - b/(3a)
+ *
+ * p and q cancel for clustered roots far from zero, so their errors are bounded by their terms, and the error
+ * of disc is the first order change of (q/2)^2 + (p/3)^3 by these errors: |q|/2 * q_error + (p/3)^2 * p_error.
+ * All bounds scale with roots as p, q and disc do, so roots of any scale get the same classification.
+ *
+ * @note a must not be zero
+ */
+static inline void depress_cubic (double a, double b, double c, double d, depressed_cubic *cubic)
+{
+    assert (cubic != NULL && "pointer can't be null");
+
+    double p2 = b / a;
+    double p1 = c / a;
+    double p0 = d / a;
+
+    cubic->b = p2;
+    cubic->c = p1;
+    cubic->d = p0;
+
+    double shift    = p2 / 3;
+    double sq_shift = shift * shift;
+
+    cubic->shift = shift;
+    cubic->p     = p1 - p2 * shift;
+    cubic->q     = (2 * sq_shift - p1) * shift + p0;
+
+    cubic->half_q  = cubic->q / 2;
+    cubic->third_p = cubic->p / 3;
+    cubic->disc    = cubic->half_q * cubic->half_q + cubic->third_p * cubic->third_p * cubic->third_p;
+
+    double q_error = DEPRESS_ERROR * ((2 * sq_shift + fabs (p1)) * fabs (shift) + fabs (p0));
+
+    cubic->p_error    = DEPRESS_ERROR * (fabs (p1) + 3 * sq_shift);
+    cubic->disc_error = fabs (cubic->half_q) * q_error + cubic->third_p * cubic->third_p * cubic->p_error;
+
+    // |t| <= 2 * max (sqrt (|p|), cbrt (|q|))
+    cubic->root_scale = fabs (shift) + 2 * (sqrt (fabs (cubic->p)) + cbrt (fabs (cubic->q)));
+}
+
+/**
+ * @brief The only real root for positive discriminant (Cardano)
+ *
+ * t = u + v, where u^3 = -q/2 - sign(q) * sqrt(disc) (no cancellation) and v = -p/(3u). For p > 0
+ * u and v have different signs and u + v cancels, so t is calculated as -q / (u^2 - uv + v^2),
+ * which follows from u^3 + v^3 = -q and has only positive terms in denominator.
+ */
+static inline double cubic_one_root (const depressed_cubic *cubic)
+{
+    assert (cubic != NULL && "pointer can't be null");
+
+    double sq_disc = sqrt (cubic->disc > 0 ? cubic->disc : 0);
+
+    double u = -cbrt (cubic->half_q + copysign (sq_disc, cubic->half_q));
+
+    // u is zero only if disc and q are zero, which is not the case of one root
+    double u_safe = fabs (u) > 0 ? u : 1;
+    double v      = -cubic->third_p / u_safe;
+
+    return -cubic->q / (u_safe*u_safe - u_safe*v + v*v) - cubic->shift;
+}
+
+/**
+ * @brief Three real roots for negative discriminant (trigonometric form)
+ *
+ * t = 2r * cos (phi/3 - 2*pi*k/3), where r = sqrt(-p/3), cos (phi) = -(q/2) / r^3
+ */
+static inline void cubic_three_roots (const depressed_cubic *cubic, double *x1, double *x2, double *x3)
+{
+    assert (cubic != NULL && "pointer can't be null");
+    assert (x1    != NULL && "pointer can't be null");
+    assert (x2    != NULL && "pointer can't be null");
+    assert (x3    != NULL && "pointer can't be null");
+
+    // p is negative, if discriminant is negative
+    double r      = sqrt (cubic->third_p < 0 ? -cubic->third_p : 0);
+    double r_safe = r > 0 ? r : 1;
+
+    double cos_phi = -cubic->half_q / (r_safe * r_safe * r_safe);
+
+    // Rounding can move cosine out of [-1, 1]
+    cos_phi = cos_phi > 1 ? 1 : cos_phi < -1 ? -1 : cos_phi;
+
+    double angle = acos (cos_phi) / 3;
+
+    *x1 = 2 * r * cos (angle)              - cubic->shift;
+    *x2 = 2 * r * cos (angle - THIRD_TURN) - cubic->shift;
+    *x3 = 2 * r * cos (angle + THIRD_TURN) - cubic->shift;
+}
+
+/**
+ * @brief Single root (x1) and double root (x2) for zero discriminant and nonzero p
+ *
+ * t1 = 3q/p, t2 = -3q/(2p)
+ */
+static inline void cubic_two_roots (const depressed_cubic *cubic, double *x1, double *x2)
+{
+    assert (cubic != NULL && "pointer can't be null");
+    assert (x1    != NULL && "pointer can't be null");
+    assert (x2    != NULL && "pointer can't be null");
+
+    double p_safe = fabs (cubic->p) > 0 ? cubic->p : 1;
+    double t1     = 3 * cubic->q / p_safe;
+
+    *x1 =  t1     - cubic->shift;
+    *x2 = -t1 / 2 - cubic->shift;
+}
+
+/**
+ * @brief Newton iterations on monic cubic, step is taken only if it is small and decreases the residual
+ *
+ * Roots of depressed cubic have absolute error of its terms, so small roots of equation with big ones
+ * lose relative precision, residual of the original equation has no such error. Derivative is zero at multiple
+ * roots and its value is rounding noise near them, so without the checks steps could jump to another root.
+ * Rejected step is rejected again by the next iteration, so steps are selected without branches and
+ * the same function is used by batch solver.
+ */
+static inline double cubic_polish (const depressed_cubic *cubic, double x)
+{
+    assert (cubic != NULL && "pointer can't be null");
+
+    double max_step = POLISH_MAX_STEP * cubic->root_scale;
+    double value    = ((x + cubic->b) * x + cubic->c) * x + cubic->d;
+
+    for (int step = 0; step < POLISH_STEPS; ++step)
+    {
+        double deriv      = (3 * x + 2 * cubic->b) * x + cubic->c;
+        double deriv_safe = fabs (deriv) > 0 ? deriv : 1;
+
+        double x_new     = x - value / deriv_safe;
+        double value_new = ((x_new + cubic->b) * x_new + cubic->c) * x_new + cubic->d;
+
+        bool take = fabs (deriv) > 0 && fabs (x_new - x) <= max_step && fabs (value_new) < fabs (value);
+
+        x     = take ? x_new     : x;
+        value = take ? value_new : value;
+    }
+
+    return x;
+}
+
+void solve_cubic_eq_batch (size_t n, const double a[], const double b[], const double c[], const double d[],
+                           double x1[], double x2[], double x3[], enum num_roots n_roots[])
+{
+    assert (a       != NULL && "pointer can't be null");
+    assert (b       != NULL && "pointer can't be null");
+    assert (c       != NULL && "pointer can't be null");
+    assert (d       != NULL && "pointer can't be null");
+    assert (x1      != NULL && "pointer can't be null");
+    assert (x2      != NULL && "pointer can't be null");
+    assert (x3      != NULL && "pointer can't be null");
+    assert (n_roots != NULL && "pointer can't be null");
+
+    // Every case of solve_cubic_eq is evaluated with the same functions and the result is selected
+    for (size_t i = 0; i < n; ++i)
+    {
+        bool a_zero = is_zero (a[i]);
+
+        depressed_cubic cubic = {};
+        depress_cubic (a_zero ? 1 : a[i], b[i], c[i], d[i], &cubic);
+
+        bool disc_zero = fabs (cubic.disc) <= cubic.disc_error;
+        bool disc_pos  = cubic.disc > 0;
+        bool p_zero    = fabs (cubic.p) <= cubic.p_error;
+
+        double one_root = cubic_one_root (&cubic);
+
+        double two_root1 = 0, two_root2 = 0;
+        cubic_two_roots (&cubic, &two_root1, &two_root2);
+
+        double three_root1 = 0, three_root2 = 0, three_root3 = 0;
+        cubic_three_roots (&cubic, &three_root1, &three_root2, &three_root3);
+
+        double triple_root = -cubic.shift;
+
+        int res_n_roots = disc_zero ? (p_zero ? ONE_ROOT : TWO_ROOTS) : disc_pos ? ONE_ROOT : THREE_ROOTS;
+
+        double res_x1 = disc_zero ? (p_zero ? triple_root : two_root1) : disc_pos ? one_root : three_root1;
+        double res_x2 = disc_zero ? two_root2 : three_root2;
+
+        res_x1      = cubic_polish (&cubic, res_x1);
+        res_x2      = cubic_polish (&cubic, res_x2);
+        three_root3 = cubic_polish (&cubic, three_root3);
+
+        // Quadratic and overflowed equations are left for solve_cubic_eq
+        bool in_range = !a_zero & isfinite (cubic.disc) & isfinite (res_x1) &
+                        (res_n_roots < TWO_ROOTS || isfinite (res_x2)) & (res_n_roots < THREE_ROOTS || isfinite (three_root3));
+
+        res_n_roots = in_range ? res_n_roots : ERANGE_SOLVE;
+
+        x1[i] = res_n_roots >= ONE_ROOT    ? res_x1      : NAN;
+        x2[i] = res_n_roots >= TWO_ROOTS   ? res_x2      : NAN;
+        x3[i] = res_n_roots == THREE_ROOTS ? three_root3 : NAN;
+        n_roots[i] = (enum num_roots) res_n_roots;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (n_roots[i] != ERANGE_SOLVE) continue;
+
+        // Not finite coefficients stay out of range
+        if (!isfinite (a[i]) || !isfinite (b[i]) || !isfinite (c[i]) || !isfinite (d[i])) continue;
+
+        n_roots[i] = solve_cubic_eq (a[i], b[i], c[i], d[i], &x1[i], &x2[i], &x3[i]);
+    }
+}
@@ -0,0 +1,124 @@
+#include <cstdio>
+#include <cassert>
+#include "equation_solver.h"
+#include "thread_pool.h"
+
+/// Equations per chunk: multiple of cache line for every output array, so threads never write to same line
+static const size_t BATCH_CHUNK_SIZE = 8192;
+
+static_assert (BATCH_CHUNK_SIZE * sizeof (double) % CACHE_LINE_SIZE == 0 &&
+               BATCH_CHUNK_SIZE * sizeof (enum num_roots) % CACHE_LINE_SIZE == 0, "chunk must be cache line aligned");
+
+///@brief Arguments of solve_quad_eq_batch_parallel and solve_cubic_eq_batch_parallel, passed to chunk function
+struct batch_args
+{
+    enum solver_mode mode;
+    bool complex_roots; ///< Solve quadratic equations with solve_quad_eq_batch_complex_mode
+    size_t n;
+    const double *a;
+    const double *b;
+    const double *c;
+    const double *d; ///< NULL for quadratic equations
+    double *x1;
+    double *x2;
+    double *x3;      ///< NULL for quadratic equations
+    enum num_roots *n_roots;
+};
+
+static void solve_chunk       (void *arg, size_t chunk, int thread_id);
+static void solve_cubic_chunk (void *arg, size_t chunk, int thread_id);
+
+void solve_quad_eq_batch_parallel (struct thread_pool *pool, size_t n, const double a[], const double b[], const double c[],
+                                   double x1[], double x2[], enum num_roots n_roots[])
+{
+    solve_quad_eq_batch_parallel_mode (pool, SOLVER_CLASSIC, n, a, b, c, x1, x2, n_roots);
+}
+
+void solve_quad_eq_batch_parallel_mode (struct thread_pool *pool, enum solver_mode mode, size_t n,
+                                        const double a[], const double b[], const double c[],
+                                        double x1[], double x2[], enum num_roots n_roots[])
+{
+    assert (pool != NULL && "pointer can't be null");
+
+    if (thread_pool_size (pool) == 1 || n <= BATCH_CHUNK_SIZE)
+    {
+        solve_quad_eq_batch_mode (mode, n, a, b, c, x1, x2, n_roots);
+        return;
+    }
+
+    batch_args args = {mode, false, n, a, b, c, NULL, x1, x2, NULL, n_roots};
+
+    thread_pool_run (pool, (n + BATCH_CHUNK_SIZE - 1) / BATCH_CHUNK_SIZE, solve_chunk, &args);
+}
+
+void solve_quad_eq_batch_complex_parallel_mode (struct thread_pool *pool, enum solver_mode mode, size_t n,
+                                                const double a[], const double b[], const double c[],
+                                                double x1[], double x2[], enum num_roots n_roots[])
+{
+    assert (pool != NULL && "pointer can't be null");
+
+    if (thread_pool_size (pool) == 1 || n <= BATCH_CHUNK_SIZE)
+    {
+        solve_quad_eq_batch_complex_mode (mode, n, a, b, c, x1, x2, n_roots);
+        return;
+    }
+
+    batch_args args = {mode, true, n, a, b, c, NULL, x1, x2, NULL, n_roots};
+
+    thread_pool_run (pool, (n + BATCH_CHUNK_SIZE - 1) / BATCH_CHUNK_SIZE, solve_chunk, &args);
+}
+
+void solve_cubic_eq_batch_parallel (struct thread_pool *pool, size_t n,
+                                    const double a[], const double b[], const double c[], const double d[],
+                                    double x1[], double x2[], double x3[], enum num_roots n_roots[])
+{
+    assert (pool != NULL && "pointer can't be null");
+
+    if (thread_pool_size (pool) == 1 || n <= BATCH_CHUNK_SIZE)
+    {
+        solve_cubic_eq_batch (n, a, b, c, d, x1, x2, x3, n_roots);
+        return;
+    }
+
+    batch_args args = {SOLVER_CLASSIC, false, n, a, b, c, d, x1, x2, x3, n_roots};
+
+    thread_pool_run (pool, (n + BATCH_CHUNK_SIZE - 1) / BATCH_CHUNK_SIZE, solve_cubic_chunk, &args);
+}
+
+///@brief Solve equations of one chunk. Each chunk writes only to its own part of output arrays
+static void solve_chunk (void *arg, size_t chunk, int thread_id)
+{
+    assert (arg != NULL && "pointer can't be null");
+    (void) thread_id;
+
+    const batch_args *args = (const batch_args *) arg;
+
+    size_t begin = chunk * BATCH_CHUNK_SIZE;
+    size_t size  = args->n - begin < BATCH_CHUNK_SIZE ? args->n - begin : BATCH_CHUNK_SIZE;
+
+    if (args->complex_roots)
+    {
+        solve_quad_eq_batch_complex_mode (args->mode, size, &args->a[begin], &args->b[begin], &args->c[begin],
+                                          &args->x1[begin], &args->x2[begin], &args->n_roots[begin]);
+    }
+    else
+    {
+        solve_quad_eq_batch_mode (args->mode, size, &args->a[begin], &args->b[begin], &args->c[begin],
+                                  &args->x1[begin], &args->x2[begin], &args->n_roots[begin]);
+    }
+}
+
+///@brief Solve cubic equations of one chunk
+static void solve_cubic_chunk (void *arg, size_t chunk, int thread_id)
+{
+    assert (arg != NULL && "pointer can't be null");
+    (void) thread_id;
+
+    const batch_args *args = (const batch_args *) arg;
+
+    size_t begin = chunk * BATCH_CHUNK_SIZE;
+    size_t size  = args->n - begin < BATCH_CHUNK_SIZE ? args->n - begin : BATCH_CHUNK_SIZE;
+
+    solve_cubic_eq_batch (size, &args->a[begin], &args->b[begin], &args->c[begin], &args->d[begin],
+                          &args->x1[begin], &args->x2[begin], &args->x3[begin], &args->n_roots[begin]);
+}
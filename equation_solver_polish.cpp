@@ -0,0 +1,120 @@
+#include <math.h>
+#include <cassert>
+#include "common_equation_solver.h"
+#include "equation_solver.h"
+
+/// Max number of Newton steps, they start from roots correct to about half of the digits, so two steps are enough
+static const int POLISH_STEPS = 2;
+
+static inline double two_sum_err    (double x, double y, double sum);
+static inline double quad_value_comp (double a, double b, double c, double x);
+static inline bool   polish_root     (double a, double b, double c, double max_step, double *x);
+
+bool polish_quad_roots (double a, double b, double c, enum num_roots n_roots, double *x1, double *x2)
+{
+    assert (x1 != NULL && "pointer can't be null");
+    assert (x2 != NULL && "pointer can't be null");
+    assert (x1 != x2   && "pointers can't be same");
+
+    // Newton steps are not defined for double roots and they don't change exact linear roots
+    if (n_roots != TWO_ROOTS) return false;
+
+    if (!isfinite (a) || !isfinite (b) || !isfinite (c) || !isfinite (*x1) || !isfinite (*x2)) return false;
+
+    // Step of each root is less than half of the distance to the other one, so they can't swap or merge
+    double max_step = fabs (*x1 - *x2) / 2;
+
+    bool polished1 = polish_root (a, b, c, max_step, x1);
+    bool polished2 = polish_root (a, b, c, max_step, x2);
+
+    return polished1 || polished2;
+}
+
+int polish_quad_eq_batch (size_t n, const double a[], const double b[], const double c[],
+                          const enum num_roots n_roots[], double x1[], double x2[], bool polished[])
+{
+    assert (a       != NULL && "pointer can't be null");
+    assert (b       != NULL && "pointer can't be null");
+    assert (c       != NULL && "pointer can't be null");
+    assert (n_roots != NULL && "pointer can't be null");
+    assert (x1      != NULL && "pointer can't be null");
+    assert (x2      != NULL && "pointer can't be null");
+
+    int n_polished = 0;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        bool res = polish_quad_roots (a[i], b[i], c[i], n_roots[i], &x1[i], &x2[i]);
+
+        if (polished != NULL) polished[i] = res;
+
+        n_polished += res;
+    }
+
+    return n_polished;
+}
+
+/**
+ * @brief Newton iterations with compensated residual, step is taken only if it is less than max_step
+ *        and decreases the residual
+ *
+ * @return true if the root has changed
+ */
+static inline bool polish_root (double a, double b, double c, double max_step, double *x)
+{
+    assert (x != NULL && "pointer can't be null");
+
+    double root  = *x;
+    double value = quad_value_comp (a, b, c, root);
+
+    for (int step = 0; step < POLISH_STEPS && fabs (value) > 0; ++step)
+    {
+        double deriv = fma (2 * a, root, b);
+
+        if (!(fabs (deriv) > 0)) break;
+
+        double root_new = root - value / deriv;
+
+        if (!(fabs (root_new - root) < max_step)) break;
+
+        double value_new = quad_value_comp (a, b, c, root_new);
+
+        if (!(fabs (value_new) < fabs (value))) break;
+
+        root  = root_new;
+        value = value_new;
+    }
+
+    bool changed = fabs (root - *x) > 0;
+
+    *x = root;
+    return changed;
+}
+
+/**
+ * @brief a*x^2 + b*x + c by compensated Horner scheme (Graillat, Langlois, Louvet)
+ *
+ * Rounding errors of every product (fma) and sum (two_sum_err) are found exactly and evaluated as
+ * a separate polynomial, so the result is as accurate as if it was calculated in twice the working
+ * precision and rounded to double. It is small near roots, where plain Horner value is rounding noise.
+ */
+static inline double quad_value_comp (double a, double b, double c, double x)
+{
+    double prod1 = a * x;
+    double sum1  = prod1 + b;
+    double err1  = fma (a, x, -prod1) + two_sum_err (prod1, b, sum1);
+
+    double prod2 = sum1 * x;
+    double sum2  = prod2 + c;
+    double err2  = fma (sum1, x, -prod2) + two_sum_err (prod2, c, sum2);
+
+    return sum2 + (err1 * x + err2);
+}
+
+///@brief Rounding error of sum = x + y, so x + y = sum + error exactly (Knuth's TwoSum)
+static inline double two_sum_err (double x, double y, double sum)
+{
+    double y_part = sum - x;
+
+    return (x - (sum - y_part)) + (y - y_part);
+}
@@ -0,0 +1,316 @@
+#include <math.h>
+#include <cerrno>
+#include <cassert>
+#include "common_equation_solver.h"
+#include "equation_solver.h"
+
+/// Max number of Aberth iterations, convergence is cubic, so usually there are less than 20 of them
+static const int POLY_MAX_ITERS = 100;
+
+/// Angle of the first initial root on every circle, it breaks symmetry of polynomials with real coefficients (Bini)
+static const double POLY_START_ANGLE = 0.7;
+
+static const double TWO_PI = 6.283185307179586477;
+
+///@brief Complex number
+struct cplx
+{
+    double re;
+    double im;
+};
+
+///@brief Value of polynomial divided by its derivative in a point
+struct newton_step
+{
+    cplx step;      ///< p(z) / p'(z)
+    bool converged; ///< |p(z)| is below its rounding error bound
+};
+
+static inline cplx cplx_mul (cplx x, cplx y);
+static inline cplx cplx_div (cplx x, cplx y);
+static inline newton_step poly_newton_step (int degree, const double coeffs[], cplx z);
+static int  upper_hull     (int n_points, const double y[], int hull[]);
+static void initial_roots  (int degree, const double coeffs[], double log_abs[], int hull[], double re[], double im[]);
+
+size_t poly_scratch_size (int degree)
+{
+    assert (degree >= 0 && "degree can't be negative");
+
+    size_t n = (size_t) degree + 1;
+
+    return n * (sizeof (double) + sizeof (int) + sizeof (bool));
+}
+
+int solve_poly_eq (int degree, const double coeffs[], double re[], double im[], void *scratch)
+{
+    assert (degree  >= 0    && "degree can't be negative");
+    assert (coeffs  != NULL && "pointer can't be null");
+    assert (re      != NULL && "pointer can't be null");
+    assert (im      != NULL && "pointer can't be null");
+    assert (scratch != NULL && "pointer can't be null");
+
+    for (int i = 0; i <= degree; ++i)
+    {
+        if (!isfinite (coeffs[i])) return ERANGE;
+    }
+
+    if (!(fabs (coeffs[0]) > 0)) return EINVAL;
+
+    // Zero lowest coefficients give zero roots, the rest are roots of the polynomial divided by x^n_zeros,
+    // which has the same coefficients without the last ones
+    int n_zeros = 0;
+    while (n_zeros < degree && !(fabs (coeffs[degree - n_zeros]) > 0)) n_zeros++;
+
+    for (int i = degree - n_zeros; i < degree; ++i)
+    {
+        re[i] = 0;
+        im[i] = 0;
+    }
+
+    degree -= n_zeros;
+
+    if (degree == 0) return 0;
+
+    // Scratch layout: log_abs[degree+1], hull[degree+1], done[degree+1]
+    double *log_abs = (double *) scratch;
+    int    *hull    = (int *)  (log_abs + degree + 1);
+    bool   *done    = (bool *) (hull    + degree + 1);
+
+    initial_roots (degree, coeffs, log_abs, hull, re, im);
+
+    for (int i = 0; i < degree; ++i) done[i] = false;
+
+    // Aberth-Ehrlich iteration, updated roots are used right away (Gauss-Seidel style)
+    for (int iter = 0; iter < POLY_MAX_ITERS; ++iter)
+    {
+        int n_active = 0;
+
+        for (int i = 0; i < degree; ++i)
+        {
+            if (done[i]) continue;
+
+            cplx z = {re[i], im[i]};
+            newton_step newton = poly_newton_step (degree, coeffs, z);
+
+            if (newton.converged)
+            {
+                done[i] = true;
+                continue;
+            }
+
+            n_active++;
+
+            // sum 1 / (z - z_j) for all other roots
+            cplx sum = {0, 0};
+
+            for (int j = 0; j < degree; ++j)
+            {
+                double dre = re[i] - re[j];
+                double dim = im[i] - im[j];
+                double sq  = dre * dre + dim * dim;
+
+                if (j == i || !(sq > 0)) continue;
+
+                sum.re += dre / sq;
+                sum.im -= dim / sq;
+            }
+
+            // w = N / (1 - N * sum), where N is Newton step
+            cplx prod  = cplx_mul (newton.step, sum);
+            cplx denom = {1 - prod.re, -prod.im};
+            cplx w     = cplx_div (newton.step, denom);
+
+            re[i] -= w.re;
+            im[i] -= w.im;
+
+            if (!isfinite (re[i]) || !isfinite (im[i])) return ERANGE;
+        }
+
+        if (n_active == 0) return 0;
+    }
+
+    return ERANGE;
+}
+
+int solve_poly_eq_batch (size_t n, int degree, const double coeffs[], double re[], double im[], void *scratch,
+                         int status[])
+{
+    assert (degree  >= 0    && "degree can't be negative");
+    assert (coeffs  != NULL && "pointer can't be null");
+    assert (re      != NULL && "pointer can't be null");
+    assert (im      != NULL && "pointer can't be null");
+    assert (scratch != NULL && "pointer can't be null");
+    assert (status  != NULL && "pointer can't be null");
+
+    size_t n_coeffs = (size_t) degree + 1;
+    size_t n_roots  = (size_t) degree;
+    int    n_failed = 0;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        status[i] = solve_poly_eq (degree, &coeffs[i * n_coeffs], &re[i * n_roots], &im[i * n_roots], scratch);
+
+        if (status[i] != 0)
+        {
+            n_failed++;
+
+            for (size_t j = i * n_roots; j < (i + 1) * n_roots; ++j) re[j] = im[j] = NAN;
+        }
+    }
+
+    return n_failed;
+}
+
+/**
+ * @brief Newton step p(z) / p'(z) with convergence check
+ *
+ * For |z| > 1 reversed polynomial q(w) = w^n * p(1/w) is evaluated in w = 1/z, so powers of z don't overflow:
+ * p(z) / p'(z) = z / (n - w * q'(w) / q(w)). Root is converged, when |p(z)| is below the bound of Horner
+ * rounding error 2n * DBL_EPSILON * sum |a_k| |z|^k (for q it is the same bound divided by |z|^n).
+ */
+static inline newton_step poly_newton_step (int degree, const double coeffs[], cplx z)
+{
+    assert (coeffs != NULL && "pointer can't be null");
+
+    double sq_abs  = z.re * z.re + z.im * z.im;
+    bool   reverse = sq_abs > 1;
+
+    // Point of evaluation and coefficients order
+    cplx   x     = reverse ? cplx_div ({1, 0}, z) : z;
+    double x_abs = sqrt (x.re * x.re + x.im * x.im);
+
+    int first = reverse ? degree : 0;
+    int delta = reverse ? -1 : 1;
+
+    cplx   val   = {coeffs[first], 0};
+    cplx   deriv = {0, 0};
+    double bound = fabs (coeffs[first]);
+
+    for (int k = 1; k <= degree; ++k)
+    {
+        double a = coeffs[first + delta * k];
+
+        deriv    = cplx_mul (deriv, x);
+        deriv.re += val.re;
+        deriv.im += val.im;
+
+        val     = cplx_mul (val, x);
+        val.re += a;
+
+        bound = bound * x_abs + fabs (a);
+    }
+
+    newton_step res = {{0, 0}, false};
+
+    double val_abs = sqrt (val.re * val.re + val.im * val.im);
+
+    res.converged = val_abs <= 2 * degree * DBL_EPSILON * bound;
+
+    if (res.converged) return res;
+
+    if (!reverse)
+    {
+        res.step = cplx_div (val, deriv);
+        return res;
+    }
+
+    // z / (n - w * q'(w) / q(w))
+    cplx ratio = cplx_mul (x, cplx_div (deriv, val));
+    cplx denom = {degree - ratio.re, -ratio.im};
+
+    res.step = cplx_div (z, denom);
+    return res;
+}
+
+/**
+ * @brief Initial roots on circles of Newton polygon (Bini)
+ *
+ * Upper convex hull of points (k, log |a_k|) gives radii of root clusters: edge from i to j holds j-i roots
+ * with modulus about (|a_i| / |a_j|)^(1/(j-i)). Roots are spread uniformly on circles of these radii.
+ */
+static void initial_roots (int degree, const double coeffs[], double log_abs[], int hull[], double re[], double im[])
+{
+    assert (coeffs  != NULL && "pointer can't be null");
+    assert (log_abs != NULL && "pointer can't be null");
+    assert (hull    != NULL && "pointer can't be null");
+    assert (re      != NULL && "pointer can't be null");
+    assert (im      != NULL && "pointer can't be null");
+
+    // Point k is coefficient of x^k, zero coefficients are below any line
+    for (int k = 0; k <= degree; ++k)
+    {
+        double a = fabs (coeffs[degree - k]);
+        log_abs[k] = a > 0 ? log (a) : -HUGE_VAL;
+    }
+
+    int n_hull = upper_hull (degree + 1, log_abs, hull);
+    int root   = 0;
+
+    for (int h = 0; h + 1 < n_hull; ++h)
+    {
+        int    i      = hull[h];
+        int    j      = hull[h + 1];
+        int    n_edge = j - i;
+        double radius = exp ((log_abs[i] - log_abs[j]) / n_edge);
+
+        for (int t = 0; t < n_edge; ++t, ++root)
+        {
+            double angle = TWO_PI * t / n_edge + TWO_PI * i / degree + POLY_START_ANGLE;
+
+            re[root] = radius * cos (angle);
+            im[root] = radius * sin (angle);
+        }
+    }
+
+    assert (root == degree && "Error in logic: hull does not cover all roots");
+}
+
+/**
+ * @brief Upper convex hull of points (k, y[k]), k = 0..n_points-1 (monotone chain)
+ *
+ * Points with y = -inf are skipped, first and last points must be finite.
+ *
+ * @return Number of hull points, their indices are written to hull in ascending order
+ */
+static int upper_hull (int n_points, const double y[], int hull[])
+{
+    assert (y    != NULL && "pointer can't be null");
+    assert (hull != NULL && "pointer can't be null");
+
+    int n_hull = 0;
+
+    for (int k = 0; k < n_points; ++k)
+    {
+        if (!isfinite (y[k])) continue;
+
+        // Remove last point while it is not above the line from the point before it to k
+        while (n_hull >= 2)
+        {
+            int i = hull[n_hull - 2];
+            int j = hull[n_hull - 1];
+
+            if ((y[j] - y[i]) * (k - i) > (y[k] - y[i]) * (j - i)) break;
+
+            n_hull--;
+        }
+
+        hull[n_hull++] = k;
+    }
+
+    return n_hull;
+}
+
+static inline cplx cplx_mul (cplx x, cplx y)
+{
+    return {x.re * y.re - x.im * y.im, x.re * y.im + x.im * y.re};
+}
+
+///@brief x / y, result is infinite for zero y
+static inline cplx cplx_div (cplx x, cplx y)
+{
+    double sq = y.re * y.re + y.im * y.im;
+
+    if (!(sq > 0)) return {HUGE_VAL, HUGE_VAL};
+
+    return {(x.re * y.re + x.im * y.im) / sq, (x.im * y.re - x.re * y.im) / sq};
+}
@@ -0,0 +1,312 @@
+#include <math.h>
+#include <cassert>
+#include "common_equation_solver.h"
+#include "equation_solver.h"
+
+/// Max number of Newton steps of polishing
+static const int POLISH_STEPS = 2;
+
+/// Relative distance of roots merged into one multiple root. Rounding splits root of multiplicity k by about
+/// DBL_EPSILON^(1/k), this is the distance of roots, which solve_quad_eq merges with zero discriminant tolerance
+static const double MULTIPLE_ROOT_ERROR = 3e-6;
+
+/// Bound of relative rounding error of quartic evaluated by Horner scheme
+static const double QUARTIC_VALUE_ERROR = 8 * DBL_EPSILON;
+
+///@brief Monic quartic x^4 + b*x^3 + c*x^2 + d*x + e = 0
+struct monic_quartic
+{
+    double b;
+    double c;
+    double d;
+    double e;
+};
+
+static inline double quartic_value    (const monic_quartic *quartic, double x);
+static inline double quartic_polish   (const monic_quartic *quartic, double x);
+static inline int    add_root         (double roots[], int n_roots, double x);
+static inline int    add_quad_roots   (double roots[], int *n_roots, double b, double c);
+static inline bool   is_multiple_root (const monic_quartic *quartic, double x1, double x2);
+static inline int    merge_roots      (const monic_quartic *quartic, double roots[], int n_roots);
+
+num_roots solve_quartic_eq (double a, double b, double c, double d, double e,
+                            double *x1, double *x2, double *x3, double *x4)
+{
+    assert (isfinite(a) && "parameter must be finite");
+    assert (isfinite(b) && "parameter must be finite");
+    assert (isfinite(c) && "parameter must be finite");
+    assert (isfinite(d) && "parameter must be finite");
+    assert (isfinite(e) && "parameter must be finite");
+    assert (x1 != NULL  && "pointer can't be null");
+    assert (x2 != NULL  && "pointer can't be null");
+    assert (x3 != NULL  && "pointer can't be null");
+    assert (x4 != NULL  && "pointer can't be null");
+    assert (x1 != x2 && x1 != x3 && x1 != x4 && x2 != x3 && x2 != x4 && x3 != x4 && "pointers can't be same");
+
+    // The equation is cubic
+
+    if (is_zero(a))
+    {
+        return solve_cubic_eq (b, c, d, e, x1, x2, x3);
+    }
+
+    monic_quartic quartic = {b / a, c / a, d / a, e / a};
+
+    // x = y - shift gives y^4 + p*y^2 + q*y + r = 0
+    double shift = quartic.b / 4;
+    double sq_shift = shift * shift;
+
+    double p = quartic.c - 6 * sq_shift;
+    double q = quartic.d - 2 * quartic.c * shift + 8 * sq_shift * shift;
+    double r = quartic.e - quartic.d * shift + quartic.c * sq_shift - 3 * sq_shift * sq_shift;
+
+    _CHECK_RANGE (isfinite (p) && isfinite (q) && isfinite (r));
+
+    double roots[4] = {};
+    int    n_found  = 0;
+
+    if (is_zero(q))
+    {
+        // Biquadratic equation: z^2 + p*z + r = 0, y = +-sqrt(z)
+        double z1 = NAN, z2 = NAN;
+        num_roots n_z = solve_quad_eq (1, p, r, &z1, &z2);
+
+        _CHECK_RANGE (n_z != ERANGE_SOLVE);
+
+        for (int i = 0; i < n_z; ++i)
+        {
+            double z = i == 0 ? z1 : z2;
+
+            if (is_zero(z))
+            {
+                n_found = add_root (roots, n_found, 0);
+            }
+            else if (z > 0)
+            {
+                n_found = add_root (roots, n_found, -sqrt (z));
+                n_found = add_root (roots, n_found, +sqrt (z));
+            }
+        }
+    }
+    else
+    {
+        // Ferrari: y^4 + p*y^2 + q*y + r = (y^2 + p/2 + m)^2 - (2m*y^2 - q*y + m^2 + p*m + p^2/4 - r),
+        // the second term is a square for roots of resolvent cubic 8m^3 + 8p*m^2 + (2p^2 - 8r)*m - q^2 = 0.
+        // It is negative at m = 0 and has a positive root, the biggest root is taken
+        double m[3] = {NAN, NAN, NAN};
+        num_roots n_m = solve_cubic_eq (8, 8 * p, 2 * p * p - 8 * r, -q * q, &m[0], &m[1], &m[2]);
+
+        _CHECK_RANGE (n_m >= ONE_ROOT);
+
+        double m_max = m[0];
+        for (int i = 1; i < n_m; ++i) m_max = m[i] > m_max ? m[i] : m_max;
+
+        // Rounding can make tiny root of resolvent non positive
+        double s      = sqrt (m_max > 0 ? 2 * m_max : 0);
+        double s_safe = s > 0 ? s : 1;
+
+        // (y^2 + s*y + p/2 + m - q/(2s)) * (y^2 - s*y + p/2 + m + q/(2s)) = 0
+        double half_sum = p / 2 + m_max;
+        double half_dif = q / (2 * s_safe);
+
+        _CHECK_RANGE (isfinite (half_sum) && isfinite (half_dif));
+
+        _CHECK_RANGE (add_quad_roots (roots, &n_found,  s, half_sum - half_dif) == 0);
+        _CHECK_RANGE (add_quad_roots (roots, &n_found, -s, half_sum + half_dif) == 0);
+    }
+
+    // Roots are polished on the original equation, so error of resolvent is not accumulated
+    for (int i = 0; i < n_found; ++i)
+    {
+        roots[i] = quartic_polish (&quartic, roots[i] - shift);
+
+        _CHECK_RANGE (isfinite (roots[i]));
+    }
+
+    int n_distinct = merge_roots (&quartic, roots, n_found);
+
+    double *outs[4] = {x1, x2, x3, x4};
+    for (int i = 0; i < n_distinct; ++i) *outs[i] = roots[i];
+
+    return (num_roots) n_distinct;
+}
+
+/// @brief Value of monic quartic at x by Horner scheme
+static inline double quartic_value (const monic_quartic *quartic, double x)
+{
+    assert (quartic != NULL && "pointer can't be null");
+
+    return (((x + quartic->b) * x + quartic->c) * x + quartic->d) * x + quartic->e;
+}
+
+/**
+ * @brief Newton iterations on monic quartic, step is taken only if it is small and decreases the residual
+ *
+ * Derivative is zero at multiple roots and its value is rounding noise near them, so without the checks
+ * steps could jump to another root.
+ */
+static inline double quartic_polish (const monic_quartic *quartic, double x)
+{
+    assert (quartic != NULL && "pointer can't be null");
+
+    double value = quartic_value (quartic, x);
+
+    for (int step = 0; step < POLISH_STEPS && fabs (value) > 0; ++step)
+    {
+        double deriv = ((4 * x + 3 * quartic->b) * x + 2 * quartic->c) * x + quartic->d;
+
+        if (!(fabs (deriv) > 0)) break;
+
+        double x_new = x - value / deriv;
+
+        if (!(fabs (x_new - x) < MULTIPLE_ROOT_ERROR * fmax (1, fabs (x)))) break;
+
+        double value_new = quartic_value (quartic, x_new);
+
+        if (!(fabs (value_new) < fabs (value))) break;
+
+        x     = x_new;
+        value = value_new;
+    }
+
+    return x;
+}
+
+/**
+ * @brief Append x to roots[0..n_roots), if there is no root equal to it
+ *
+ * @return New number of roots
+ */
+static inline int add_root (double roots[], int n_roots, double x)
+{
+    assert (roots != NULL && "pointer can't be null");
+
+    for (int i = 0; i < n_roots; ++i)
+    {
+        if (is_zero (roots[i] - x)) return n_roots;
+    }
+
+    roots[n_roots] = x;
+    return n_roots + 1;
+}
+
+/**
+ * @brief Check that close roots x1 and x2 approximate one multiple root of quartic
+ *
+ * Between close distinct roots residual is of order of squared distance, so roots are merged only if residual
+ * at their mean is within rounding error of Horner scheme or not bigger than residuals at them.
+ */
+static inline bool is_multiple_root (const monic_quartic *quartic, double x1, double x2)
+{
+    assert (quartic != NULL && "pointer can't be null");
+
+    if (!(fabs (x1 - x2) < MULTIPLE_ROOT_ERROR * fmax (1, fabs (x2)))) return false;
+
+    double mean  = (x1 + x2) / 2;
+    double x_abs = fabs (mean);
+
+    double value_error = QUARTIC_VALUE_ERROR *
+                         ((((x_abs + fabs (quartic->b)) * x_abs + fabs (quartic->c)) * x_abs + fabs (quartic->d)) * x_abs +
+                          fabs (quartic->e));
+
+    double value = fabs (quartic_value (quartic, mean));
+
+    return value <= value_error ||
+           value <= fmin (fabs (quartic_value (quartic, x1)), fabs (quartic_value (quartic, x2)));
+}
+
+/**
+ * @brief Replace roots, which approximate one multiple root, by their mean
+ *
+ * Roots of different factors may approximate one multiple root, Newton iterations converge to it slowly.
+ *
+ * @return Number of distinct roots, they are moved to the beginning of array
+ */
+static inline int merge_roots (const monic_quartic *quartic, double roots[], int n_roots)
+{
+    assert (quartic != NULL && "pointer can't be null");
+    assert (roots   != NULL && "pointer can't be null");
+
+    int n_distinct = 0;
+
+    for (int i = 0; i < n_roots; ++i)
+    {
+        int j = 0;
+        while (j < n_distinct && !is_multiple_root (quartic, roots[j], roots[i])) j++;
+
+        if (j < n_distinct) roots[j] = (roots[j] + roots[i]) / 2;
+        else                roots[n_distinct++] = roots[i];
+    }
+
+    return n_distinct;
+}
+
+/**
+ * @brief Append real roots of y^2 + b*y + c = 0 to roots[0..*n_roots) and update *n_roots
+ *
+ * Factor of a multiple root may get small negative discriminant from rounding of resolvent root, so discriminant
+ * which is zero relative to its terms gives double root -b/2. Small positive discriminant gives two close roots,
+ * they are merged later only if they approximate one multiple root.
+ *
+ * @return Non zero value if roots are out of range
+ */
+static inline int add_quad_roots (double roots[], int *n_roots, double b, double c)
+{
+    assert (roots   != NULL && "pointer can't be null");
+    assert (n_roots != NULL && "pointer can't be null");
+
+    double disc = b*b - 4*c;
+
+    if (!isfinite (disc)) return -1;
+
+    if (disc > 0)
+    {
+        // Stable formula: no cancellation of -b and sqrt(disc)
+        double y1 = -(b + copysign (sqrt (disc), b)) / 2;
+
+        *n_roots = add_root (roots, *n_roots, y1);
+        *n_roots = add_root (roots, *n_roots, c / y1);
+    }
+    else if (disc > -DBL_ERROR * (b*b + 4 * fabs (c)))
+    {
+        *n_roots = add_root (roots, *n_roots, -b / 2);
+    }
+
+    return 0;
+}
+
+void solve_quartic_eq_batch (size_t n, const double a[], const double b[], const double c[], const double d[],
+                             const double e[], double x1[], double x2[], double x3[], double x4[],
+                             enum num_roots n_roots[])
+{
+    assert (a       != NULL && "pointer can't be null");
+    assert (b       != NULL && "pointer can't be null");
+    assert (c       != NULL && "pointer can't be null");
+    assert (d       != NULL && "pointer can't be null");
+    assert (e       != NULL && "pointer can't be null");
+    assert (x1      != NULL && "pointer can't be null");
+    assert (x2      != NULL && "pointer can't be null");
+    assert (x3      != NULL && "pointer can't be null");
+    assert (x4      != NULL && "pointer can't be null");
+    assert (n_roots != NULL && "pointer can't be null");
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        double roots[4] = {NAN, NAN, NAN, NAN};
+
+        if (!isfinite (a[i]) || !isfinite (b[i]) || !isfinite (c[i]) || !isfinite (d[i]) || !isfinite (e[i]))
+        {
+            n_roots[i] = ERANGE_SOLVE;
+        }
+        else
+        {
+            n_roots[i] = solve_quartic_eq (a[i], b[i], c[i], d[i], e[i], &roots[0], &roots[1], &roots[2], &roots[3]);
+        }
+
+        // Unused roots are NAN, as in other batch solvers
+        x1[i] = n_roots[i] >= ONE_ROOT    ? roots[0] : NAN;
+        x2[i] = n_roots[i] >= TWO_ROOTS   ? roots[1] : NAN;
+        x3[i] = n_roots[i] >= THREE_ROOTS ? roots[2] : NAN;
+        x4[i] = n_roots[i] == FOUR_ROOTS  ? roots[3] : NAN;
+    }
+}
@@ -0,0 +1,464 @@
+#include <math.h>
+#include <cfloat>
+#include <cstdio>
+#include <cstdint>
+#include <cassert>
+#include "common_equation_solver.h"
+#include "equation_solver.h"
+#include "equation_solver_const.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define _SIMD_X86
+#endif
+
+static_assert (sizeof (enum num_roots) == sizeof (int32_t), "num_roots is stored as int32 vector");
+
+/*
+ * Kernels follow solve_quad_eq_batch_generic line by line: all branches of solve_quad_eq are
+ * evaluated with the same operations in the same order and results are selected by masks,
+ * so every lane gets exactly the same classification as scalar solver.
+ *
+ * Build with -ffp-contract=off: otherwise GCC fuses vector mul and sub into FMA and roots differ.
+ *
+ * Range check is an ordered comparison, so lanes with NaN coefficients are out of range too.
+ */
+
+#ifdef _SIMD_X86
+
+static void solve_quad_eq_batch_sse2 (size_t n, const double a[], const double b[], const double c[],
+                                      double x1[], double x2[], enum num_roots n_roots[])
+{
+    const __m128d zero     = _mm_set1_pd (0);
+    const __m128d one      = _mm_set1_pd (1);
+    const __m128d two      = _mm_set1_pd (2);
+    const __m128d four     = _mm_set1_pd (4);
+    const __m128d nan      = _mm_set1_pd (NAN);
+    const __m128d error    = _mm_set1_pd (DBL_ERROR);
+    const __m128d safe_max = _mm_set1_pd (BATCH_SAFE_MAX);
+    const __m128d sign     = _mm_set1_pd (-0.0);
+
+    const __m128d n_two    = _mm_set1_pd (TWO_ROOTS);
+    const __m128d n_one    = _mm_set1_pd (ONE_ROOT);
+    const __m128d n_zero   = _mm_set1_pd (ZERO_ROOTS);
+    const __m128d n_inf    = _mm_set1_pd (INF_ROOTS);
+    const __m128d n_erange = _mm_set1_pd (ERANGE_SOLVE);
+
+    #define _ABS(x)          _mm_andnot_pd (sign, x)
+    #define _NEG(x)          _mm_xor_pd    (sign, x)
+    #define _IS_ZERO(x)      _mm_cmplt_pd  (_ABS (x), error)
+    #define _SELECT(m, t, f) _mm_or_pd     (_mm_and_pd (m, t), _mm_andnot_pd (m, f))
+    #define _MASK(m)         (unsigned) _mm_movemask_pd (m)
+
+    size_t n_vec = n - n % 2;
+
+    uint64_t counts[N_SOLVER_STATS] = {};
+
+    for (size_t i = 0; i < n_vec; i += 2)
+    {
+        __m128d ai = _mm_loadu_pd (&a[i]);
+        __m128d bi = _mm_loadu_pd (&b[i]);
+        __m128d ci = _mm_loadu_pd (&c[i]);
+
+        __m128d a_zero = _IS_ZERO (ai);
+        __m128d b_zero = _IS_ZERO (bi);
+        __m128d c_zero = _IS_ZERO (ci);
+
+        __m128d a_safe = _SELECT (a_zero, one, ai);
+        __m128d b_safe = _SELECT (b_zero, one, bi);
+
+        __m128d in_range = _mm_and_pd (_mm_cmple_pd (_ABS (ai), safe_max),
+                           _mm_and_pd (_mm_cmple_pd (_ABS (bi), safe_max), _mm_cmple_pd (_ABS (ci), safe_max)));
+
+        // Linear branch
+        __m128d lin_root     = _mm_div_pd (_NEG (ci), b_safe);
+        __m128d lin_n_roots  = _SELECT (b_zero, _SELECT (c_zero, n_inf, n_zero), n_one);
+
+        // Quadratic branch
+        __m128d four_ac   = _mm_mul_pd (_mm_mul_pd (four, ai), ci);
+        __m128d b_sqr     = _mm_mul_pd (bi, bi);
+
+        __m128d disc      = _mm_sub_pd (b_sqr, four_ac);
+        __m128d disc_zero = _IS_ZERO (disc);
+        __m128d disc_neg  = _mm_cmplt_pd (disc, zero);
+        __m128d sq_disc   = _mm_sqrt_pd (_SELECT (_mm_cmpgt_pd (disc, zero), disc, zero));
+
+        __m128d ratio     = _mm_div_pd (_NEG (ci), a_safe);
+        __m128d sq_ratio  = _mm_sqrt_pd (_SELECT (_mm_cmpgt_pd (ratio, zero), ratio, zero));
+
+        __m128d one_root  = _mm_div_pd (_mm_div_pd (_NEG (bi), a_safe), two);
+        __m128d two_root1 = _SELECT (b_zero, _NEG (sq_ratio),
+                            _SELECT (c_zero, zero,
+                                     _mm_div_pd (_mm_div_pd (_mm_add_pd (_NEG (bi), sq_disc), a_safe), two)));
+        __m128d two_root2 = _SELECT (b_zero, sq_ratio,
+                            _SELECT (c_zero, _mm_div_pd (_NEG (bi), a_safe),
+                                     _mm_div_pd (_mm_div_pd (_mm_sub_pd (_NEG (bi), sq_disc), a_safe), two)));
+
+        __m128d quad_n_roots = _SELECT (disc_zero, n_one, _SELECT (disc_neg, n_zero, n_two));
+
+        __m128d res_n_roots  = _SELECT (in_range, _SELECT (a_zero, lin_n_roots, quad_n_roots), n_erange);
+        __m128d res_x1       = _SELECT (a_zero, lin_root,
+                                        _SELECT (_mm_cmpeq_pd (quad_n_roots, n_one), one_root, two_root1));
+
+        _mm_storeu_pd (&x1[i], _SELECT (_mm_cmpge_pd (res_n_roots, n_one), res_x1,    nan));
+        _mm_storeu_pd (&x2[i], _SELECT (_mm_cmpeq_pd (res_n_roots, n_two), two_root2, nan));
+        _mm_storel_epi64 ((__m128i *) &n_roots[i], _mm_cvtpd_epi32 (res_n_roots));
+
+        count_quad_eq_lanes (counts, _MASK (in_range), _MASK (a_zero), _MASK (b_zero), _MASK (c_zero),
+                             _MASK (disc_zero), _MASK (disc_neg));
+    }
+
+    add_quad_eq_counts (counts);
+
+    #undef _ABS
+    #undef _NEG
+    #undef _IS_ZERO
+    #undef _SELECT
+    #undef _MASK
+
+    solve_quad_eq_batch_generic (n - n_vec, &a[n_vec], &b[n_vec], &c[n_vec], &x1[n_vec], &x2[n_vec], &n_roots[n_vec]);
+}
+
+__attribute__((target("avx2")))
+static void solve_quad_eq_batch_avx2 (size_t n, const double a[], const double b[], const double c[],
+                                      double x1[], double x2[], enum num_roots n_roots[])
+{
+    const __m256d zero     = _mm256_set1_pd (0);
+    const __m256d one      = _mm256_set1_pd (1);
+    const __m256d two      = _mm256_set1_pd (2);
+    const __m256d four     = _mm256_set1_pd (4);
+    const __m256d nan      = _mm256_set1_pd (NAN);
+    const __m256d error    = _mm256_set1_pd (DBL_ERROR);
+    const __m256d safe_max = _mm256_set1_pd (BATCH_SAFE_MAX);
+    const __m256d sign     = _mm256_set1_pd (-0.0);
+
+    const __m256d n_two    = _mm256_set1_pd (TWO_ROOTS);
+    const __m256d n_one    = _mm256_set1_pd (ONE_ROOT);
+    const __m256d n_zero   = _mm256_set1_pd (ZERO_ROOTS);
+    const __m256d n_inf    = _mm256_set1_pd (INF_ROOTS);
+    const __m256d n_erange = _mm256_set1_pd (ERANGE_SOLVE);
+
+    #define _ABS(x)          _mm256_andnot_pd (sign, x)
+    #define _NEG(x)          _mm256_xor_pd    (sign, x)
+    #define _CMP(x, y, op)   _mm256_cmp_pd    (x, y, _CMP_ ## op)
+    #define _IS_ZERO(x)      _CMP (_ABS (x), error, LT_OQ)
+    #define _SELECT(m, t, f) _mm256_blendv_pd (f, t, m)
+    #define _MASK(m)         (unsigned) _mm256_movemask_pd (m)
+
+    size_t n_vec = n - n % 4;
+
+    uint64_t counts[N_SOLVER_STATS] = {};
+
+    for (size_t i = 0; i < n_vec; i += 4)
+    {
+        __m256d ai = _mm256_loadu_pd (&a[i]);
+        __m256d bi = _mm256_loadu_pd (&b[i]);
+        __m256d ci = _mm256_loadu_pd (&c[i]);
+
+        __m256d a_zero = _IS_ZERO (ai);
+        __m256d b_zero = _IS_ZERO (bi);
+        __m256d c_zero = _IS_ZERO (ci);
+
+        __m256d a_safe = _SELECT (a_zero, one, ai);
+        __m256d b_safe = _SELECT (b_zero, one, bi);
+
+        __m256d in_range = _mm256_and_pd (_CMP (_ABS (ai), safe_max, LE_OQ),
+                           _mm256_and_pd (_CMP (_ABS (bi), safe_max, LE_OQ), _CMP (_ABS (ci), safe_max, LE_OQ)));
+
+        // Linear branch
+        __m256d lin_root     = _mm256_div_pd (_NEG (ci), b_safe);
+        __m256d lin_n_roots  = _SELECT (b_zero, _SELECT (c_zero, n_inf, n_zero), n_one);
+
+        // Quadratic branch
+        __m256d four_ac   = _mm256_mul_pd (_mm256_mul_pd (four, ai), ci);
+        __m256d b_sqr     = _mm256_mul_pd (bi, bi);
+
+        __m256d disc      = _mm256_sub_pd (b_sqr, four_ac);
+        __m256d disc_zero = _IS_ZERO (disc);
+        __m256d disc_neg  = _CMP (disc, zero, LT_OQ);
+        __m256d sq_disc   = _mm256_sqrt_pd (_SELECT (_CMP (disc, zero, GT_OQ), disc, zero));
+
+        __m256d ratio     = _mm256_div_pd (_NEG (ci), a_safe);
+        __m256d sq_ratio  = _mm256_sqrt_pd (_SELECT (_CMP (ratio, zero, GT_OQ), ratio, zero));
+
+        __m256d one_root  = _mm256_div_pd (_mm256_div_pd (_NEG (bi), a_safe), two);
+        __m256d two_root1 = _SELECT (b_zero, _NEG (sq_ratio),
+                            _SELECT (c_zero, zero,
+                                     _mm256_div_pd (_mm256_div_pd (_mm256_add_pd (_NEG (bi), sq_disc), a_safe), two)));
+        __m256d two_root2 = _SELECT (b_zero, sq_ratio,
+                            _SELECT (c_zero, _mm256_div_pd (_NEG (bi), a_safe),
+                                     _mm256_div_pd (_mm256_div_pd (_mm256_sub_pd (_NEG (bi), sq_disc), a_safe), two)));
+
+        __m256d quad_n_roots = _SELECT (disc_zero, n_one, _SELECT (disc_neg, n_zero, n_two));
+
+        __m256d res_n_roots  = _SELECT (in_range, _SELECT (a_zero, lin_n_roots, quad_n_roots), n_erange);
+        __m256d res_x1       = _SELECT (a_zero, lin_root,
+                                        _SELECT (_CMP (quad_n_roots, n_one, EQ_OQ), one_root, two_root1));
+
+        _mm256_storeu_pd (&x1[i], _SELECT (_CMP (res_n_roots, n_one, GE_OQ), res_x1,    nan));
+        _mm256_storeu_pd (&x2[i], _SELECT (_CMP (res_n_roots, n_two, EQ_OQ), two_root2, nan));
+        _mm_storeu_si128 ((__m128i *) &n_roots[i], _mm256_cvtpd_epi32 (res_n_roots));
+
+        count_quad_eq_lanes (counts, _MASK (in_range), _MASK (a_zero), _MASK (b_zero), _MASK (c_zero),
+                             _MASK (disc_zero), _MASK (disc_neg));
+    }
+
+    add_quad_eq_counts (counts);
+
+    #undef _ABS
+    #undef _NEG
+    #undef _CMP
+    #undef _IS_ZERO
+    #undef _SELECT
+    #undef _MASK
+
+    solve_quad_eq_batch_generic (n - n_vec, &a[n_vec], &b[n_vec], &c[n_vec], &x1[n_vec], &x2[n_vec], &n_roots[n_vec]);
+}
+
+/*
+ * AVX-512 kernel is split into branches: zmm temporaries of one function take more than 8 KB of stack
+ * in debug build with sanitizers. Helpers are inlined with optimization, code is the same.
+ */
+
+#define _ABS(x)          _mm512_abs_pd (x)
+#define _NEG(x)          _mm512_castsi512_pd (_mm512_xor_si512 (_mm512_set1_epi64 (INT64_MIN), _mm512_castpd_si512 (x)))
+#define _CMP(x, y, op)   _mm512_cmp_pd_mask (x, y, _CMP_ ## op)
+#define _IS_ZERO(x)      _CMP (_ABS (x), _mm512_set1_pd (DBL_ERROR), LT_OQ)
+#define _SELECT(m, t, f) _mm512_mask_blend_pd (m, f, t)
+
+///@brief Linear branch of AVX-512 kernel, returns root and sets its number of roots
+__attribute__((target("avx512f")))
+static inline __m512d avx512_lin_branch (__m512d bi, __m512d ci, __mmask8 b_zero, __mmask8 c_zero,
+                                         __m512d *lin_n_roots)
+{
+    const __m512d n_one  = _mm512_set1_pd (ONE_ROOT);
+    const __m512d n_zero = _mm512_set1_pd (ZERO_ROOTS);
+    const __m512d n_inf  = _mm512_set1_pd (INF_ROOTS);
+
+    __m512d b_safe = _SELECT (b_zero, _mm512_set1_pd (1), bi);
+
+    *lin_n_roots = _SELECT (b_zero, _SELECT (c_zero, n_inf, n_zero), n_one);
+
+    return _mm512_div_pd (_NEG (ci), b_safe);
+}
+
+///@brief Roots of quadratic branch of AVX-512 kernel for positive discriminant
+__attribute__((target("avx512f")))
+static inline void avx512_two_roots (__m512d bi, __m512d ci, __m512d a_safe, __m512d disc,
+                                     __mmask8 b_zero, __mmask8 c_zero, __m512d *two_root1, __m512d *two_root2)
+{
+    const __m512d zero = _mm512_set1_pd (0);
+    const __m512d two  = _mm512_set1_pd (2);
+
+    __m512d sq_disc   = _mm512_sqrt_pd (_SELECT (_CMP (disc, zero, GT_OQ), disc, zero));
+
+    __m512d ratio     = _mm512_div_pd (_NEG (ci), a_safe);
+    __m512d sq_ratio  = _mm512_sqrt_pd (_SELECT (_CMP (ratio, zero, GT_OQ), ratio, zero));
+
+    *two_root1 = _SELECT (b_zero, _NEG (sq_ratio),
+                 _SELECT (c_zero, zero,
+                          _mm512_div_pd (_mm512_div_pd (_mm512_add_pd (_NEG (bi), sq_disc), a_safe), two)));
+    *two_root2 = _SELECT (b_zero, sq_ratio,
+                 _SELECT (c_zero, _mm512_div_pd (_NEG (bi), a_safe),
+                          _mm512_div_pd (_mm512_div_pd (_mm512_sub_pd (_NEG (bi), sq_disc), a_safe), two)));
+}
+
+///@brief Quadratic branch of AVX-512 kernel, returns number of roots and sets roots and discriminant masks
+__attribute__((target("avx512f")))
+static inline __m512d avx512_quad_branch (__m512d ai, __m512d bi, __m512d ci, __m512d a_safe,
+                                          __mmask8 b_zero, __mmask8 c_zero, __mmask8 *disc_zero, __mmask8 *disc_neg,
+                                          __m512d *quad_root1, __m512d *two_root2)
+{
+    const __m512d n_two  = _mm512_set1_pd (TWO_ROOTS);
+    const __m512d n_one  = _mm512_set1_pd (ONE_ROOT);
+    const __m512d n_zero = _mm512_set1_pd (ZERO_ROOTS);
+
+    __m512d four_ac   = _mm512_mul_pd (_mm512_mul_pd (_mm512_set1_pd (4), ai), ci);
+    __m512d b_sqr     = _mm512_mul_pd (bi, bi);
+
+    __m512d  disc     = _mm512_sub_pd (b_sqr, four_ac);
+    *disc_zero        = _IS_ZERO (disc);
+    *disc_neg         = _CMP (disc, _mm512_set1_pd (0), LT_OQ);
+
+    __m512d one_root  = _mm512_div_pd (_mm512_div_pd (_NEG (bi), a_safe), _mm512_set1_pd (2));
+    __m512d two_root1 = _mm512_set1_pd (0);
+
+    avx512_two_roots (bi, ci, a_safe, disc, b_zero, c_zero, &two_root1, two_root2);
+
+    __m512d quad_n_roots = _SELECT (*disc_zero, n_one, _SELECT (*disc_neg, n_zero, n_two));
+
+    *quad_root1 = _SELECT (_CMP (quad_n_roots, n_one, EQ_OQ), one_root, two_root1);
+
+    return quad_n_roots;
+}
+
+__attribute__((target("avx512f")))
+static void solve_quad_eq_batch_avx512 (size_t n, const double a[], const double b[], const double c[],
+                                        double x1[], double x2[], enum num_roots n_roots[])
+{
+    const __m512d one      = _mm512_set1_pd (1);
+    const __m512d nan      = _mm512_set1_pd (NAN);
+    const __m512d safe_max = _mm512_set1_pd (BATCH_SAFE_MAX);
+
+    const __m512d n_two    = _mm512_set1_pd (TWO_ROOTS);
+    const __m512d n_one    = _mm512_set1_pd (ONE_ROOT);
+    const __m512d n_erange = _mm512_set1_pd (ERANGE_SOLVE);
+
+    size_t n_vec = n - n % 8;
+
+    uint64_t counts[N_SOLVER_STATS] = {};
+
+    for (size_t i = 0; i < n_vec; i += 8)
+    {
+        __m512d ai = _mm512_loadu_pd (&a[i]);
+        __m512d bi = _mm512_loadu_pd (&b[i]);
+        __m512d ci = _mm512_loadu_pd (&c[i]);
+
+        __mmask8 a_zero = _IS_ZERO (ai);
+        __mmask8 b_zero = _IS_ZERO (bi);
+        __mmask8 c_zero = _IS_ZERO (ci);
+
+        __m512d a_safe = _SELECT (a_zero, one, ai);
+
+        __mmask8 in_range = _CMP (_ABS (ai), safe_max, LE_OQ) & _CMP (_ABS (bi), safe_max, LE_OQ) &
+                            _CMP (_ABS (ci), safe_max, LE_OQ);
+
+        __m512d lin_n_roots = n_one;
+        __m512d lin_root    = avx512_lin_branch (bi, ci, b_zero, c_zero, &lin_n_roots);
+
+        __mmask8 disc_zero  = 0;
+        __mmask8 disc_neg   = 0;
+        __m512d  quad_root1 = one;
+        __m512d  two_root2  = one;
+        __m512d  quad_n_roots = avx512_quad_branch (ai, bi, ci, a_safe, b_zero, c_zero, &disc_zero, &disc_neg,
+                                                    &quad_root1, &two_root2);
+
+        __m512d res_n_roots  = _SELECT (in_range, _SELECT (a_zero, lin_n_roots, quad_n_roots), n_erange);
+        __m512d res_x1       = _SELECT (a_zero, lin_root, quad_root1);
+
+        _mm512_storeu_pd (&x1[i], _SELECT (_CMP (res_n_roots, n_one, GE_OQ), res_x1,    nan));
+        _mm512_storeu_pd (&x2[i], _SELECT (_CMP (res_n_roots, n_two, EQ_OQ), two_root2, nan));
+        _mm256_storeu_si256 ((__m256i *) &n_roots[i], _mm512_cvtpd_epi32 (res_n_roots));
+
+        count_quad_eq_lanes (counts, in_range, a_zero, b_zero, c_zero, disc_zero, disc_neg);
+    }
+
+    add_quad_eq_counts (counts);
+
+    solve_quad_eq_batch_generic (n - n_vec, &a[n_vec], &b[n_vec], &c[n_vec], &x1[n_vec], &x2[n_vec], &n_roots[n_vec]);
+}
+
+#undef _ABS
+#undef _NEG
+#undef _CMP
+#undef _IS_ZERO
+#undef _SELECT
+
+#endif // _SIMD_X86
+
+bool simd_isa_supported (enum simd_isa isa)
+{
+    switch (isa)
+    {
+        case SIMD_GENERIC:
+            return true;
+
+#ifdef _SIMD_X86
+        case SIMD_SSE2:
+            return __builtin_cpu_supports ("sse2");
+
+        case SIMD_AVX2:
+            return __builtin_cpu_supports ("avx2");
+
+        case SIMD_AVX512:
+            return __builtin_cpu_supports ("avx512f");
+#else
+        case SIMD_SSE2:
+        case SIMD_AVX2:
+        case SIMD_AVX512:
+            return false;
+#endif
+
+        default:
+            assert (0 && "Invalid enum member");
+            return false;
+    }
+}
+
+enum simd_isa simd_isa_detect (void)
+{
+    if (simd_isa_supported (SIMD_AVX512)) return SIMD_AVX512;
+    if (simd_isa_supported (SIMD_AVX2))   return SIMD_AVX2;
+    if (simd_isa_supported (SIMD_SSE2))   return SIMD_SSE2;
+
+    return SIMD_GENERIC;
+}
+
+const char *simd_isa_name (enum simd_isa isa)
+{
+    switch (isa)
+    {
+        case SIMD_GENERIC: return "generic";
+        case SIMD_SSE2:    return "sse2";
+        case SIMD_AVX2:    return "avx2";
+        case SIMD_AVX512:  return "avx512";
+
+        default:
+            assert (0 && "Invalid enum member");
+            return "invalid";
+    }
+}
+
+void solve_quad_eq_batch_isa (enum simd_isa isa, size_t n, const double a[], const double b[], const double c[],
+                              double x1[], double x2[], enum num_roots n_roots[])
+{
+    assert (a       != NULL && "pointer can't be null");
+    assert (b       != NULL && "pointer can't be null");
+    assert (c       != NULL && "pointer can't be null");
+    assert (x1      != NULL && "pointer can't be null");
+    assert (x2      != NULL && "pointer can't be null");
+    assert (n_roots != NULL && "pointer can't be null");
+
+    if (!simd_isa_supported (isa)) isa = SIMD_GENERIC;
+
+    switch (isa)
+    {
+#ifdef _SIMD_X86
+        case SIMD_SSE2:
+            solve_quad_eq_batch_sse2   (n, a, b, c, x1, x2, n_roots);
+            break;
+
+        case SIMD_AVX2:
+            solve_quad_eq_batch_avx2   (n, a, b, c, x1, x2, n_roots);
+            break;
+
+        case SIMD_AVX512:
+            solve_quad_eq_batch_avx512 (n, a, b, c, x1, x2, n_roots);
+            break;
+#else
+        case SIMD_SSE2:
+        case SIMD_AVX2:
+        case SIMD_AVX512:
+#endif
+        case SIMD_GENERIC:
+            solve_quad_eq_batch_generic (n, a, b, c, x1, x2, n_roots);
+            break;
+
+        default:
+            assert (0 && "Invalid enum member");
+            break;
+    }
+
+    solve_quad_eq_batch_fixup (n, a, b, c, x1, x2, n_roots);
+}
+
+void solve_quad_eq_batch (size_t n, const double a[], const double b[], const double c[],
+                          double x1[], double x2[], enum num_roots n_roots[])
+{
+    // Detected once, CPU does not change during run
+    static const enum simd_isa best_isa = simd_isa_detect ();
+
+    solve_quad_eq_batch_isa (best_isa, n, a, b, c, x1, x2, n_roots);
+}
+
+#undef _SIMD_X86
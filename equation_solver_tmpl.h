@@ -0,0 +1,31 @@
+#ifndef QUAD_EQUATION_SOLVER_TMPL_H
+#define QUAD_EQUATION_SOLVER_TMPL_H
+
+#include "equation_solver.h"
+
+/*
+ * Solvers templated over floating point type. Zero tolerance and coefficient limit of scaling
+ * are taken from fp_traits<T> (see common_equation_solver.h) at compile time.
+ *
+ * Templates are instantiated in equation_solver.cpp for float, double, long double and
+ * __float128 (if compiler supports it). C-style functions (solve_quad_eq, solve_quad_eq_f, ...)
+ * are thin wrappers of these instantiations.
+ */
+
+///@brief Same as solve_lin_eq for any floating point type
+template <typename T>
+enum num_roots solve_lin_eq_t (T k, T b, T *x);
+
+///@brief Same as solve_quad_eq for any floating point type
+template <typename T>
+enum num_roots solve_quad_eq_t (T a, T b, T c, T *x1, T *x2);
+
+/**@brief Same as solve_quad_eq_batch for any floating point type
+ *
+ * double equations are solved with SIMD kernels of solve_quad_eq_batch, other types use the portable kernel
+ * of solve_quad_eq_batch_generic and solve_quad_eq_t for equations it leaves as ERANGE_SOLVE.
+ */
+template <typename T>
+void solve_quad_eq_batch_t (size_t n, const T a[], const T b[], const T c[], T x1[], T x2[], enum num_roots n_roots[]);
+
+#endif //QUAD_EQUATION_SOLVER_TMPL_H
@@ -0,0 +1,292 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <cassert>
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "equation_solver.h"
+#include "serve.h"
+
+/*
+ * Load generator of solver daemon (quad --serve). Every client connects to the socket, keeps up to depth
+ * requests in flight and measures latency of each request from its send to receipt of its response.
+ * Requests are sent and responses are received by two threads of the client, so the client never stops
+ * reading while it is blocked in send.
+ *
+ *     quad_load <socket> [-c clients] [-n requests per client] [-s equations per request] [-p depth]
+ *
+ * Prints p50, p99 and max latency, requests and equations per second.
+ */
+
+///@brief Options of load generator
+struct load_opts
+{
+    const char *socket_path = NULL;
+    size_t      n_clients   = 4;
+    size_t      n_requests  = 10000; ///< Requests per client
+    size_t      size        = 16;    ///< Equations per request
+    size_t      depth       = 1;     ///< Requests in flight per client
+};
+
+///@brief Columns of one client, latencies[i] is latency of request i in ns
+struct load_client
+{
+    std::vector<double>         a          = {};
+    std::vector<double>         b          = {};
+    std::vector<double>         c          = {};
+    std::vector<double>         x1         = {};
+    std::vector<double>         x2         = {};
+    std::vector<enum num_roots> n_roots    = {};
+    std::vector<uint64_t>       latencies  = {};
+    int                         err        = 0;
+};
+
+///@brief Requests in flight of one client, shared by its sending and receiving threads
+struct load_flight
+{
+    std::mutex              lock       {};
+    std::condition_variable cond       {}; ///< Signaled when a response is received or a thread fails
+    std::vector<uint64_t>   sent       {}; ///< Send times of requests in flight, request i is in slot i % depth
+    size_t                  n_received = 0;
+    int                     err        = 0;
+};
+
+static int      parse_load_opts (int argc, char **argv, load_opts *opts);
+static int      parse_count     (const char *str, size_t *value);
+static void     run_client      (const load_opts *opts, load_client *client);
+static void     recv_responses  (const load_opts *opts, load_client *client, load_flight *flight, int fd);
+static void     fail_flight     (load_flight *flight, int fd, int err);
+static uint64_t now_ns          (void);
+static double   rand_range      (unsigned *seed, double min, double max);
+
+int main (int argc, char **argv)
+{
+    load_opts opts = {};
+
+    if (parse_load_opts (argc, argv, &opts) != 0)
+    {
+        printf ("Usage: quad_load <socket> [-c clients] [-n requests] [-s equations per request] [-p depth]\n");
+        return -1;
+    }
+
+    std::vector<load_client> clients (opts.n_clients);
+    std::vector<std::thread> threads;
+
+    uint64_t start = now_ns ();
+
+    for (size_t i = 0; i < opts.n_clients; ++i) threads.emplace_back (run_client, &opts, &clients[i]);
+    for (std::thread &thread : threads) thread.join ();
+
+    double seconds = (double) (now_ns () - start) / 1e9;
+
+    std::vector<uint64_t> latencies;
+
+    for (const load_client &client : clients)
+    {
+        if (client.err != 0)
+        {
+            printf ("Client failed: %s\n", strerror (client.err));
+            return -1;
+        }
+
+        latencies.insert (latencies.end (), client.latencies.begin (), client.latencies.end ());
+    }
+
+    std::sort (latencies.begin (), latencies.end ());
+
+    size_t n_total = latencies.size ();
+
+    printf ("clients %zu, requests %zu, equations per request %zu, depth %zu\n",
+            opts.n_clients, n_total, opts.size, opts.depth);
+    printf ("latency: p50 %.1f us, p99 %.1f us, max %.1f us\n",
+            (double) latencies[n_total / 2]         / 1e3,
+            (double) latencies[n_total * 99 / 100]  / 1e3,
+            (double) latencies[n_total - 1]         / 1e3);
+    printf ("throughput: %.0f requests/s, %.0f equations/s\n",
+            (double) n_total / seconds, (double) (n_total * opts.size) / seconds);
+
+    return 0;
+}
+
+///@brief Send opts->n_requests requests keeping opts->depth of them in flight, check answers of the first one
+static void run_client (const load_opts *opts, load_client *client)
+{
+    assert (opts   != NULL && "pointer can't be null");
+    assert (client != NULL && "pointer can't be null");
+
+    size_t size = opts->size;
+
+    client->a.resize (size);
+    client->b.resize (size);
+    client->c.resize (size);
+    client->x1.resize (size);
+    client->x2.resize (size);
+    client->n_roots.resize (size);
+    client->latencies.resize (opts->n_requests);
+
+    unsigned seed = (unsigned) (uintptr_t) client;
+
+    for (size_t i = 0; i < size; ++i)
+    {
+        client->a[i] = rand_range (&seed, -100, 100);
+        client->b[i] = rand_range (&seed, -100, 100);
+        client->c[i] = rand_range (&seed, -100, 100);
+    }
+
+    int fd = serve_connect (opts->socket_path);
+
+    if (fd < 0)
+    {
+        client->err = errno;
+        return;
+    }
+
+    // Server stops reading a connection, which has too many unread responses, so responses are received
+    // by another thread: sending and receiving in turn blocks in send, when depth requests don't fit in buffers
+    load_flight flight = {};
+    flight.sent.resize (opts->depth);
+
+    std::thread receiver (recv_responses, opts, client, &flight, fd);
+
+    for (size_t n_sent = 0; n_sent < opts->n_requests; ++n_sent)
+    {
+        {
+            std::unique_lock<std::mutex> guard (flight.lock);
+
+            flight.cond.wait (guard, [&] { return n_sent - flight.n_received < opts->depth || flight.err != 0; });
+
+            if (flight.err != 0) break;
+
+            flight.sent[n_sent % opts->depth] = now_ns ();
+        }
+
+        int err = serve_send (fd, size, client->a.data (), client->b.data (), client->c.data ());
+
+        if (err != 0)
+        {
+            fail_flight (&flight, fd, err);
+            break;
+        }
+    }
+
+    receiver.join ();
+    close (fd);
+
+    client->err = flight.err;
+}
+
+///@brief Receive responses to all requests of client and calculate their latencies
+static void recv_responses (const load_opts *opts, load_client *client, load_flight *flight, int fd)
+{
+    assert (opts   != NULL && "pointer can't be null");
+    assert (client != NULL && "pointer can't be null");
+    assert (flight != NULL && "pointer can't be null");
+
+    for (size_t i = 0; i < opts->n_requests; ++i)
+    {
+        int err = serve_recv (fd, opts->size, client->x1.data (), client->x2.data (), client->n_roots.data ());
+
+        if (err != 0)
+        {
+            fail_flight (flight, fd, err);
+            return;
+        }
+
+        uint64_t received = now_ns ();
+
+        std::lock_guard<std::mutex> guard (flight->lock);
+
+        // Sender has already failed, responses are not waited for
+        if (flight->err != 0) return;
+
+        client->latencies[i] = received - flight->sent[i % opts->depth];
+        flight->n_received++;
+        flight->cond.notify_one ();
+    }
+}
+
+///@brief Save the first error and wake both threads: waiting sender and receiver blocked in recv
+static void fail_flight (load_flight *flight, int fd, int err)
+{
+    assert (flight != NULL && "pointer can't be null");
+
+    {
+        std::lock_guard<std::mutex> guard (flight->lock);
+
+        if (flight->err == 0) flight->err = err;
+    }
+
+    flight->cond.notify_one ();
+    shutdown (fd, SHUT_RDWR);
+}
+
+static int parse_load_opts (int argc, char **argv, load_opts *opts)
+{
+    assert (argv != NULL && "pointer can't be null");
+    assert (opts != NULL && "pointer can't be null");
+
+    if (argc < 2) return EINVAL;
+
+    opts->socket_path = argv[1];
+
+    for (int pos = 2; pos < argc; pos += 2)
+    {
+        if (pos + 1 >= argc || argv[pos][0] != '-' || strlen (argv[pos]) != 2) return EINVAL;
+
+        size_t *value = NULL;
+
+        switch (argv[pos][1])
+        {
+            case 'c': value = &opts->n_clients;  break;
+            case 'n': value = &opts->n_requests; break;
+            case 's': value = &opts->size;       break;
+            case 'p': value = &opts->depth;      break;
+            default:  return EINVAL;
+        }
+
+        if (parse_count (argv[pos + 1], value) != 0) return EINVAL;
+    }
+
+    if (opts->size > SERVE_MAX_COUNT) return EINVAL;
+
+    return 0;
+}
+
+///@brief Parse positive integer
+static int parse_count (const char *str, size_t *value)
+{
+    assert (str   != NULL && "pointer can't be null");
+    assert (value != NULL && "pointer can't be null");
+
+    char *end = NULL;
+    errno = 0;
+
+    unsigned long long parsed = strtoull (str, &end, 10);
+
+    if (errno != 0 || end == str || *end != '\0' || parsed == 0 || str[0] == '-') return EINVAL;
+
+    *value = (size_t) parsed;
+    return 0;
+}
+
+static uint64_t now_ns (void)
+{
+    timespec time = {};
+    clock_gettime (CLOCK_MONOTONIC, &time);
+
+    return (uint64_t) time.tv_sec * 1000000000 + (uint64_t) time.tv_nsec;
+}
+
+static double rand_range (unsigned *seed, double min, double max)
+{
+    assert (seed != NULL && "pointer can't be null");
+
+    return min + (max - min) * rand_r (seed) / RAND_MAX;
+}
@@ -1,33 +1,127 @@
 #include <cstdio>
 #include <cstring>
+#include <cerrno>
 #include <cmath>
 #include <stdlib.h>
 #include <time.h>
+#include <signal.h>
 #include <assert.h>
 #include "equation_solver.h"
+#include "thread_pool.h"
+#include "batch_io.h"
+#include "bin_io.h"
+#include "solution_cache.h"
+#include "solver_stats.h"
+#include "serve.h"
+#include "pipeline.h"
 
 #ifdef TEST
 #include "test_equation_solver.h"
 #endif
 
-int parse_argv (int argc, char *argv[], int n_coeffs, double *coeffs);
-int test_main  (int argc, char *argv[]);
+/// What to do with input file
+enum input_mode
+{
+    INPUT_TEXT,         ///< Solve equations from text file (-f file)
+    INPUT_BIN,          ///< Solve equations from binary file (-b file)
+    CONVERT_TO_BIN,     ///< Convert "a b c" text file to binary (--to-bin file)
+    CONVERT_LIN_TO_BIN, ///< Convert "k b" text file to binary (--lin-to-bin file)
+    CONVERT_TO_TEXT     ///< Convert binary file to text (--to-text file)
+};
+
+/// Command line options
+struct cli_opts
+{
+    int    n_threads;       ///< Number of threads for batch solving (-j N)
+    char  *input_file;      ///< Input file, "-" for stdin
+    input_mode input;       ///< What to do with input file
+    bool   bin_out;         ///< Write solutions of binary input in binary format (--bin-out)
+    solver_mode solver;     ///< Solver implementation (--solver name)
+    solution_format format; ///< Output format (--machine)
+    bool   cubic;           ///< Solve cubic equations "a b c d" (--cubic)
+    bool   complex_roots;   ///< Print complex roots of quadratic equations (--complex)
+    bool   polish;          ///< Refine roots of quadratic equations with Newton steps (--polish)
+    size_t cache_size;      ///< Capacity of solutions cache, 0 to disable (--cache N)
+    bool   stats;           ///< Print counters of solver branches after solving (--stats)
+    bool   errors;          ///< Print summary of equations with errors after solving (--errors)
+    char  *serve_path;      ///< Socket of solver daemon (--serve path)
+    size_t mem_limit;       ///< Memory limit of pipelined file solving in MiB, 0 for default (--mem N)
+    int    n_args;          ///< Number of arguments after options
+    char **args;            ///< Arguments after options
+};
+
+bool find_input_mode (const char *option, input_mode *mode);
+bool find_solver_mode (const char *name, solver_mode *mode);
+int parse_opts  (int argc, char *argv[], cli_opts *opts);
+int parse_argv  (const cli_opts *opts, int n_coeffs, double *coeffs);
+int solve_batch (const cli_opts *opts, int n_coeffs);
+int solve_file  (const cli_opts *opts);
+int solve_input (const cli_opts *opts, FILE *in_stream, const batch_opts *solve_opts, const pipeline_opts *popts);
+int serve_socket (const cli_opts *opts);
+int create_cache (const cli_opts *opts, batch_opts *solve_opts, int n_shards);
+void destroy_cache (batch_opts *solve_opts);
+void print_stats (const cli_opts *opts);
+int test_main   (int argc, char *argv[]);
 
 /// Number of coefficients in quadric equation
 static const int NUM_COEFFS = 3;
 
+/// Number of coefficients in cubic equation
+static const int NUM_CUBIC_COEFFS = 4;
+
 int main (int argc, char *argv[])
 {
 #ifdef TEST
     return test_main (argc, argv);
 #endif
 
-    double coeffs[NUM_COEFFS]     = {NAN, NAN, NAN};
-    double  roots[NUM_COEFFS - 1] = {NAN, NAN};
+    double coeffs[NUM_CUBIC_COEFFS]     = {NAN, NAN, NAN, NAN};
+    double  roots[NUM_CUBIC_COEFFS - 1] = {NAN, NAN, NAN};
+
+    cli_opts opts = {};
+
+    if (parse_opts (argc, argv, &opts) != 0) return -1;
+
+    int n_coeffs = opts.cubic ? NUM_CUBIC_COEFFS : NUM_COEFFS;
+
+    if (opts.serve_path != NULL)
+    {
+        return serve_socket (&opts);
+    }
+
+    if (opts.input_file != NULL)
+    {
+        return solve_file (&opts);
+    }
+
+    if (opts.n_args > n_coeffs && opts.n_args % n_coeffs == 0)
+    {
+        return solve_batch (&opts, n_coeffs);
+    }
+
+    if (parse_argv (&opts, n_coeffs, coeffs) != 0) return -1;
+
+    num_roots n_roots = ERANGE_SOLVE;
 
-    if (parse_argv (argc, argv, NUM_COEFFS, coeffs) != 0) return -1;
+    if (opts.cubic)
+    {
+        n_roots = solve_cubic_eq (coeffs[0], coeffs[1], coeffs[2], coeffs[3], &roots[0], &roots[1], &roots[2]);
+    }
+    else if (opts.complex_roots)
+    {
+        // Batch of one equation, so the selected solver is used, as in solve_batch and solve_file
+        solve_quad_eq_batch_complex_mode (opts.solver, 1, &coeffs[0], &coeffs[1], &coeffs[2],
+                                          &roots[0], &roots[1], &n_roots);
+    }
+    else
+    {
+        n_roots = solve_quad_eq_mode (opts.solver, coeffs[0], coeffs[1], coeffs[2], &roots[0], &roots[1]);
+    }
 
-    num_roots n_roots = solve_quad_eq (coeffs[0], coeffs[1], coeffs[2], &roots[0], &roots[1]);
+    if (opts.polish && !opts.cubic)
+    {
+        polish_quad_roots (coeffs[0], coeffs[1], coeffs[2], n_roots, &roots[0], &roots[1]);
+    }
 
     if (n_roots == ERANGE_SOLVE)
     {
@@ -86,32 +180,296 @@ int test_main (int argc, char *argv[])
 }
 #endif
 
+/**
+ * @brief      Find mode of option, which takes input file
+ *
+ * @param[in]  option  Option name
+ * @param[out] mode    Mode of the option, not changed if option is not found
+ *
+ * @return     True if option takes input file
+ */
+bool find_input_mode (const char *option, input_mode *mode)
+{
+    assert (option != NULL && "pointer can't be null");
+    assert (mode   != NULL && "pointer can't be null");
+
+    static const struct
+    {
+        const char *name;
+        input_mode  mode;
+    } INPUT_OPTS[] = {
+        {"-f",           INPUT_TEXT},
+        {"-b",           INPUT_BIN},
+        {"--to-bin",     CONVERT_TO_BIN},
+        {"--lin-to-bin", CONVERT_LIN_TO_BIN},
+        {"--to-text",    CONVERT_TO_TEXT},
+    };
+
+    for (size_t i = 0; i < sizeof (INPUT_OPTS) / sizeof (INPUT_OPTS[0]); ++i)
+    {
+        if (strcmp (option, INPUT_OPTS[i].name) == 0)
+        {
+            *mode = INPUT_OPTS[i].mode;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief      Find solver by name
+ *
+ * @param[in]  name  Solver name
+ * @param[out] mode  Solver, not changed if name is not found
+ *
+ * @return     True if solver is found
+ */
+bool find_solver_mode (const char *name, solver_mode *mode)
+{
+    assert (name != NULL && "pointer can't be null");
+    assert (mode != NULL && "pointer can't be null");
+
+    static const struct
+    {
+        const char *name;
+        solver_mode mode;
+    } SOLVERS[] = {
+        {"classic",    SOLVER_CLASSIC},
+        {"branchless", SOLVER_BRANCHLESS},
+        {"accurate",   SOLVER_ACCURATE},
+    };
+
+    for (size_t i = 0; i < sizeof (SOLVERS) / sizeof (SOLVERS[0]); ++i)
+    {
+        if (strcmp (name, SOLVERS[i].name) == 0)
+        {
+            *mode = SOLVERS[i].mode;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief      Parse options, which go before coefficients
+ *
+ * @param[in]  argc  The count of arguments
+ * @param[in]  argv  The arguments array
+ * @param[out] opts  Parsed options and arguments left
+ *
+ * @return     Non zero value on error
+ */
+int parse_opts (int argc, char *argv[], cli_opts *opts)
+{
+    assert (argv != NULL && "pointer can't be null");
+    assert (opts != NULL && "pointer can't be null");
+
+    opts->n_threads = 1;
+
+    int pos = 1;
+
+    while (pos < argc)
+    {
+        if (strcmp (argv[pos], "-j") == 0 && pos + 1 < argc)
+        {
+            char *end = NULL;
+            long n_threads = strtol (argv[pos + 1], &end, 10);
+
+            if (end == argv[pos + 1] || *end != '\0' || n_threads < 0 || n_threads > 4096)
+            {
+                printf ("Invalid number of threads: %s\n", argv[pos + 1]);
+                return -1;
+            }
+
+            opts->n_threads = (int) n_threads;
+            pos += 2;
+        }
+        else if (strcmp (argv[pos], "--cache") == 0 && pos + 1 < argc)
+        {
+            char *end = NULL;
+            long long cache_size = strtoll (argv[pos + 1], &end, 10);
+
+            if (end == argv[pos + 1] || *end != '\0' || cache_size < 0 || cache_size > (1ll << 32))
+            {
+                printf ("Invalid cache size: %s\n", argv[pos + 1]);
+                return -1;
+            }
+
+            opts->cache_size = (size_t) cache_size;
+            pos += 2;
+        }
+        else if (strcmp (argv[pos], "--mem") == 0 && pos + 1 < argc)
+        {
+            char *end = NULL;
+            long long mem_limit = strtoll (argv[pos + 1], &end, 10);
+            long long min_limit = (long long) ((pipeline_min_mem () + (1 << 20) - 1) >> 20);
+
+            if (end == argv[pos + 1] || *end != '\0' || mem_limit < min_limit || mem_limit > (1ll << 30))
+            {
+                printf ("Invalid memory limit: %s, it must be at least %lld MiB\n", argv[pos + 1], min_limit);
+                return -1;
+            }
+
+            opts->mem_limit = (size_t) mem_limit;
+            pos += 2;
+        }
+        else if (strcmp (argv[pos], "--serve") == 0 && pos + 1 < argc)
+        {
+            opts->serve_path = argv[pos + 1];
+            pos += 2;
+        }
+        else if (strcmp (argv[pos], "--solver") == 0 && pos + 1 < argc)
+        {
+            if (!find_solver_mode (argv[pos + 1], &opts->solver))
+            {
+                printf ("Unknown solver: %s\n", argv[pos + 1]);
+                return -1;
+            }
+
+            pos += 2;
+        }
+        else if (strcmp (argv[pos], "--machine") == 0)
+        {
+            opts->format = FORMAT_MACHINE;
+            pos += 1;
+        }
+        else if (strcmp (argv[pos], "--complex") == 0)
+        {
+            opts->complex_roots = true;
+            pos += 1;
+        }
+        else if (strcmp (argv[pos], "--polish") == 0)
+        {
+            opts->polish = true;
+            pos += 1;
+        }
+        else if (strcmp (argv[pos], "--stats") == 0)
+        {
+            opts->stats = true;
+            pos += 1;
+        }
+        else if (strcmp (argv[pos], "--errors") == 0)
+        {
+            opts->errors = true;
+            pos += 1;
+        }
+        else if (strcmp (argv[pos], "--cubic") == 0)
+        {
+            opts->cubic = true;
+            pos += 1;
+        }
+        else if (strcmp (argv[pos], "--bin-out") == 0)
+        {
+            opts->bin_out = true;
+            pos += 1;
+        }
+        else if (pos + 1 < argc && find_input_mode (argv[pos], &opts->input))
+        {
+            opts->input_file = argv[pos + 1];
+            pos += 2;
+        }
+        else break;
+    }
+
+    opts->n_args = argc - pos;
+    opts->args   = &argv[pos];
+
+    // Binary format stores quadratic equations only
+    if (opts->cubic && opts->input_file != NULL && opts->input != INPUT_TEXT)
+    {
+        printf ("--cubic can be used with text input only\n");
+        return -1;
+    }
+
+    if (opts->cubic && opts->complex_roots)
+    {
+        printf ("--complex can be used with quadratic equations only\n");
+        return -1;
+    }
+
+    if (opts->cubic && opts->polish)
+    {
+        printf ("--polish can be used with quadratic equations only\n");
+        return -1;
+    }
+
+    if (opts->cubic && opts->cache_size > 0)
+    {
+        printf ("--cache can be used with quadratic equations only\n");
+        return -1;
+    }
+
+    if (opts->cubic && opts->serve_path != NULL)
+    {
+        printf ("--serve can be used with quadratic equations only\n");
+        return -1;
+    }
+
+    if (opts->stats && !solver_stats_enabled ())
+    {
+        printf ("--stats requires build with QUAD_STATS defined\n");
+        return -1;
+    }
+
+    return 0;
+}
+
 /**
  * @brief      Get coefficients from CLI args or from interactive mode
  *
- * @param[in]  argc      The count of arguments
- * @param[in]  argv      The arguments array
+ * @param[in]  opts      Parsed options
  * @param[in]  n_coeffs  Number of coefficients
  * @param[out] coeffs    Array of coefficients
  *
  * @return     Non zero value on error
  */
-int parse_argv (int argc, char *argv[], int n_coeffs, double *coeffs)
+int parse_argv (const cli_opts *opts, int n_coeffs, double *coeffs)
 {
+    assert (opts   != NULL && "pointer can't be null");
+    assert (coeffs != NULL && "pointer can't be null");
+
     int input_res = 0;
+    int n_args    = opts->n_args;
+    char **args   = opts->args;
 
-    if ((argc == 2 && strcmp (argv[1],"-h") == 0) || (argc != 2 && argc != n_coeffs + 1))
+    if ((n_args == 1 && strcmp (args[0],"-h") == 0) || (n_args != 1 && n_args != n_coeffs))
     {
         printf (
             "Quadratic equation solver\n"                                       
             "Usage:\n"                                                          
             "    * `quad -i` for interactive mode\n"                            
             "    * `quad a b c` for normal mode (solve ax^2 + bx + c = 0)\n"
+            "    * `quad --cubic a b c d` to solve ax^3 + bx^2 + cx + d = 0, `--cubic` works with `-i`, `-f` and\n"
+            "      several equations too\n"
+            "    * `quad [-j N] a1 b1 c1 a2 b2 c2 ...` to solve several equations using N threads (0 for all CPUs)\n"
+            "    * `quad [-j N] -f <file|->` to solve equations from file or stdin, one `a b c` per line\n"
+            "    * `quad [-j N] [--bin-out] -b <file|->` to solve equations from binary file or stdin\n"
+            "    * `quad --to-bin <file|->` to convert `a b c` lines to binary, extra columns are ignored\n"
+            "    * `quad --lin-to-bin <file|->` to convert `k b` lines (kx + b = 0) to binary\n"
+            "    * `quad --to-text <file|->` to convert binary equations or solutions to text\n"
+            "    * `quad [-j N] --serve <socket>` to run solver daemon on Unix domain socket until SIGINT or SIGTERM\n"
+            "Batch options:\n"
+            "    * `--machine` print `num_roots x1 x2` with full precision instead of text\n"
+            "    * `--bin-out` write solutions of binary input in binary format\n"
+            "    * `--errors` print number of equations, which failed to parse or to solve, to stderr\n"
+            "    * `--mem N` limit memory of pipelined `-j N -f` solving to N MiB (64 by default)\n"
+            "Solver options:\n"
+            "    * `--solver classic|branchless|accurate` select solver: vectorized classic one (default), branch-free\n"
+            "      one with numerically stable roots for inputs with unpredictable number of roots or accurate one\n"
+            "      with FMA discriminant and relative tolerance for nearly double roots of any scale\n"
+            "    * `--polish` refine two roots with Newton steps on FMA compensated residual, for nearly double\n"
+            "      roots and cancellation\n"
+            "    * `--cache N` reuse solutions of repeated equations from cache of N entries, print hit and miss\n"
+            "      counters to stderr\n"
+            "    * `--stats` print counters of solver branches to stderr after solving (build with QUAD_STATS)\n"
+            "    * `--complex` print complex roots `re ± imi` instead of no solutions (`-3 re im` with `--machine`)\n"
             );
 
         return -1;
     }
-    else if (argc == 2 && strcmp (argv[1], "-i") == 0)
+    else if (n_args == 1 && strcmp (args[0], "-i") == 0)
     {
         input_res = input_coeffs (n_coeffs, coeffs, stdin, stdout);
     
@@ -123,9 +481,9 @@ int parse_argv (int argc, char *argv[], int n_coeffs, double *coeffs)
     }
     else
     {
-        assert (argc == (n_coeffs + 1) && "Error in logic: unexpected argc value");
+        assert (n_args == n_coeffs && "Error in logic: unexpected number of arguments");
 
-        input_res = parse_coeffs (n_coeffs, coeffs, &argv[1]);
+        input_res = parse_coeffs (n_coeffs, coeffs, args);
 
         if (input_res != 0)
         {
@@ -135,4 +493,369 @@ int parse_argv (int argc, char *argv[], int n_coeffs, double *coeffs)
     }
 
     return 0;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief      Solve several equations given in arguments and print one solution per line
+ *
+ * @param[in]  opts      Parsed options
+ * @param[in]  n_coeffs  Number of coefficients in one equation
+ *
+ * @return     Non zero value on error
+ */
+int solve_batch (const cli_opts *opts, int n_coeffs)
+{
+    assert (opts != NULL && "pointer can't be null");
+    assert (n_coeffs == (opts->cubic ? NUM_CUBIC_COEFFS : NUM_COEFFS) && "Unexpected number of coefficients");
+
+    size_t n_eq = (size_t) (opts->n_args / n_coeffs);
+
+    eq_batch   batch      = {};
+    batch_opts solve_opts = {};
+    solve_opts.solver = opts->solver;
+    solve_opts.format = opts->format;
+    solve_opts.cubic  = opts->cubic;
+    solve_opts.complex_roots = opts->complex_roots;
+    solve_opts.polish = opts->polish;
+
+    batch_errors errors = {};
+    solve_opts.errors = opts->errors ? &errors : NULL;
+
+    if (eq_batch_ctor (&batch, n_eq) != 0)
+    {
+        printf ("Failed to allocate memory\n");
+        return -1;
+    }
+
+    for (size_t i = 0; i < n_eq; ++i)
+    {
+        double coeffs[NUM_CUBIC_COEFFS] = {};
+
+        if (parse_coeffs (n_coeffs, coeffs, &opts->args[i * (size_t) n_coeffs]) != 0)
+        {
+            printf ("Failed to parse coefficients of equation #%zu, please use not very bin numbers\n", i + 1);
+            eq_batch_dtor (&batch);
+            return -1;
+        }
+
+        batch.a[i] = coeffs[0];
+        batch.b[i] = coeffs[1];
+        batch.c[i] = coeffs[2];
+        batch.d[i] = coeffs[3];
+        batch.parse_failed[i] = false;
+    }
+
+    batch.size = n_eq;
+    solve_opts.pool = thread_pool_create (opts->n_threads);
+
+    if (solve_opts.pool == NULL)
+    {
+        printf ("Failed to start threads\n");
+        eq_batch_dtor (&batch);
+        return -1;
+    }
+
+    if (create_cache (opts, &solve_opts, thread_pool_size (solve_opts.pool)) != 0)
+    {
+        thread_pool_destroy (solve_opts.pool);
+        eq_batch_dtor (&batch);
+        return -1;
+    }
+
+    eq_batch_solve (&batch, &solve_opts);
+    eq_batch_print (&batch, &solve_opts, stdout);
+
+    destroy_cache (&solve_opts);
+    print_stats (opts);
+
+    if (solve_opts.errors != NULL) print_batch_errors (solve_opts.errors, stderr);
+    thread_pool_destroy (solve_opts.pool);
+    eq_batch_dtor (&batch);
+
+    return 0;
+}
+
+/**
+ * @brief      Solve or convert equations from file or stdin, write result to stdout
+ *
+ * @param[in]  opts  Parsed options
+ *
+ * @return     Non zero value on error
+ */
+int solve_file (const cli_opts *opts)
+{
+    assert (opts             != NULL && "pointer can't be null");
+    assert (opts->input_file != NULL && "pointer can't be null");
+
+    /// Size of stdout buffer
+    static const size_t OUT_BUFFER_SIZE = 1 << 20;
+
+    FILE *in_stream = strcmp (opts->input_file, "-") == 0 ? stdin : fopen (opts->input_file, "rb");
+
+    if (in_stream == NULL)
+    {
+        printf ("Failed to open %s: %s\n", opts->input_file, strerror (errno));
+        return -1;
+    }
+
+    setvbuf (stdout, NULL, _IOFBF, OUT_BUFFER_SIZE);
+
+    batch_opts solve_opts = {};
+    solve_opts.solver = opts->solver;
+    solve_opts.format = opts->format;
+    solve_opts.cubic  = opts->cubic;
+    solve_opts.complex_roots = opts->complex_roots;
+    solve_opts.polish = opts->polish;
+
+    batch_errors errors = {};
+    solve_opts.errors = opts->errors ? &errors : NULL;
+
+    // Text is solved by pipeline of threads, which solve without pool
+    bool pipelined = opts->input == INPUT_TEXT && opts->n_threads != 1;
+    int  n_shards  = 1;
+
+    pipeline_opts popts = {};
+    pipeline_opts_init (&popts, opts->n_threads, opts->mem_limit != 0 ? opts->mem_limit << 20 : PIPELINE_DEFAULT_MEM);
+
+    if (pipelined)
+    {
+        n_shards = popts.n_solvers;
+    }
+    else if (opts->n_threads != 1)
+    {
+        solve_opts.pool = thread_pool_create (opts->n_threads);
+
+        if (solve_opts.pool == NULL)
+        {
+            printf ("Failed to start threads\n");
+            if (in_stream != stdin) fclose (in_stream);
+            return -1;
+        }
+
+        n_shards = thread_pool_size (solve_opts.pool);
+    }
+
+    if (create_cache (opts, &solve_opts, n_shards) != 0)
+    {
+        thread_pool_destroy (solve_opts.pool);
+        if (in_stream != stdin) fclose (in_stream);
+        return -1;
+    }
+
+    int err = solve_input (opts, in_stream, &solve_opts, pipelined ? &popts : NULL);
+
+    destroy_cache (&solve_opts);
+    print_stats (opts);
+
+    if (solve_opts.errors != NULL) print_batch_errors (solve_opts.errors, stderr);
+    thread_pool_destroy (solve_opts.pool);
+    if (in_stream != stdin) fclose (in_stream);
+
+    return err == 0 ? 0 : -1;
+}
+
+/// Server stopped by signal handler
+static quad_server *running_server = NULL;
+
+///@brief SIGINT and SIGTERM handler of solver daemon
+static void stop_server (int signal)
+{
+    (void) signal;
+
+    if (running_server != NULL) server_stop (running_server);
+}
+
+/**
+ * @brief      Run solver daemon on opts->serve_path until SIGINT or SIGTERM
+ *
+ * @param[in]  opts  Parsed options
+ *
+ * @return     Non zero value on error
+ */
+int serve_socket (const cli_opts *opts)
+{
+    assert (opts             != NULL && "pointer can't be null");
+    assert (opts->serve_path != NULL && "pointer can't be null");
+
+    batch_opts solve_opts = {};
+    solve_opts.solver = opts->solver;
+    solve_opts.complex_roots = opts->complex_roots;
+    solve_opts.polish = opts->polish;
+
+    if (opts->n_threads != 1)
+    {
+        solve_opts.pool = thread_pool_create (opts->n_threads);
+
+        if (solve_opts.pool == NULL)
+        {
+            printf ("Failed to start threads\n");
+            return -1;
+        }
+    }
+
+    if (create_cache (opts, &solve_opts, solve_opts.pool != NULL ? thread_pool_size (solve_opts.pool) : 1) != 0)
+    {
+        thread_pool_destroy (solve_opts.pool);
+        return -1;
+    }
+
+    int err = 0;
+    running_server = server_create (opts->serve_path, &solve_opts);
+
+    if (running_server == NULL)
+    {
+        err = errno;
+        printf ("Failed to listen on %s: %s\n", opts->serve_path, strerror (err));
+    }
+    else
+    {
+        struct sigaction action = {};
+        action.sa_handler = stop_server;
+        sigemptyset (&action.sa_mask);
+
+        sigaction (SIGINT,  &action, NULL);
+        sigaction (SIGTERM, &action, NULL);
+
+        err = server_run (running_server);
+        if (err != 0) printf ("Solver daemon failed: %s\n", strerror (err));
+
+        server_destroy (running_server);
+        running_server = NULL;
+    }
+
+    destroy_cache (&solve_opts);
+    print_stats (opts);
+    thread_pool_destroy (solve_opts.pool);
+
+    return err == 0 ? 0 : -1;
+}
+
+/**
+ * @brief      Process opened input according to input mode
+ *
+ * @param[in]  opts        Parsed options
+ * @param[in]  in_stream   Input stream
+ * @param[in]  solve_opts  Options of batch solving
+ * @param[in]  popts       Options of pipelined solving of text input, NULL to solve text in calling thread
+ *
+ * @return     Non zero value (errno value) on error, error message is already printed
+ */
+int solve_input (const cli_opts *opts, FILE *in_stream, const batch_opts *solve_opts, const pipeline_opts *popts)
+{
+    assert (opts       != NULL && "pointer can't be null");
+    assert (in_stream  != NULL && "pointer can't be null");
+    assert (solve_opts != NULL && "pointer can't be null");
+
+    const char *action = "solve equations from";
+    size_t n_lines = 0;
+    int    err     = 0;
+
+    switch (opts->input)
+    {
+        case INPUT_TEXT:
+            err = popts != NULL ? solve_stream_pipelined (in_stream, stdout, solve_opts, popts)
+                                : solve_stream (in_stream, stdout, solve_opts);
+            break;
+
+        case INPUT_BIN:
+            err = solve_bin (in_stream, stdout, opts->bin_out, solve_opts);
+            break;
+
+        case CONVERT_TO_BIN:
+        case CONVERT_LIN_TO_BIN:
+            action = "convert";
+            err = text_to_bin (in_stream, stdout, opts->input == CONVERT_TO_BIN ? 3 : 2, &n_lines);
+
+            if (err == EINVAL)
+            {
+                fprintf (stderr, "Failed to convert %s: can't parse equation #%zu\n", opts->input_file, n_lines);
+                return err;
+            }
+            break;
+
+        case CONVERT_TO_TEXT:
+            action = "convert";
+            err = bin_to_text (in_stream, stdout, opts->format);
+            break;
+
+        default:
+            assert (0 && "Invalid enum member");
+            break;
+    }
+
+    if (err != 0)
+    {
+        fprintf (stderr, "Failed to %s %s: %s\n", action, opts->input_file, strerror (err));
+    }
+
+    return err;
+}
+
+/**
+ * @brief      Create solutions cache of opts->cache_size entries with shard per worker
+ *
+ * @param[in]     opts        Parsed options
+ * @param[in,out] solve_opts  Options of batch solving
+ * @param[in]     n_shards    Number of workers: pool size or number of pipeline solvers
+ *
+ * @return     Non zero value on error, error message is already printed
+ */
+int create_cache (const cli_opts *opts, batch_opts *solve_opts, int n_shards)
+{
+    assert (opts       != NULL && "pointer can't be null");
+    assert (solve_opts != NULL && "pointer can't be null");
+
+    solve_opts->cache = NULL;
+
+    if (opts->cache_size == 0) return 0;
+
+    solve_opts->cache = solution_cache_create (opts->cache_size, n_shards);
+
+    if (solve_opts->cache == NULL)
+    {
+        printf ("Failed to allocate memory\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief      Print cache counters to stderr and destroy cache
+ *
+ * @param[in,out] solve_opts  Options of batch solving, cache may be NULL
+ */
+void destroy_cache (batch_opts *solve_opts)
+{
+    assert (solve_opts != NULL && "pointer can't be null");
+
+    if (solve_opts->cache == NULL) return;
+
+    cache_stats stats = {};
+    solution_cache_stats (solve_opts->cache, &stats);
+
+    size_t lookups = stats.hits + stats.misses;
+
+    fprintf (stderr, "Cache: %zu hits, %zu misses, %zu evictions, hit ratio %.1f%%\n",
+             stats.hits, stats.misses, stats.evictions, lookups > 0 ? 100.0 * (double) stats.hits / (double) lookups : 0.0);
+
+    solution_cache_destroy (solve_opts->cache);
+    solve_opts->cache = NULL;
+}
+
+/**
+ * @brief      Print counters of solver branches to stderr, if they are requested
+ *
+ * @param[in]  opts  Parsed options
+ */
+void print_stats (const cli_opts *opts)
+{
+    assert (opts != NULL && "pointer can't be null");
+
+    if (!opts->stats) return;
+
+    solver_stats stats = {};
+    solver_stats_get (&stats);
+
+    print_solver_stats (&stats, stderr);
+}
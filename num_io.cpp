@@ -0,0 +1,241 @@
+#include <math.h>
+#include <cerrno>
+#include <cassert>
+#include <cstring>
+#include <charconv>
+#include "common_equation_solver.h"
+#include "num_io.h"
+
+static bool   is_large_magnitude (const char *begin, const char *end);
+static char  *format_root        (char *pos, char *end, double root, enum solution_format format);
+static char  *append_str         (char *pos, const char *str);
+
+int parse_double (const char *begin, const char *end, double *x, const char **stop)
+{
+    assert (begin != NULL && "pointer can't be null");
+    assert (end   != NULL && "pointer can't be null");
+    assert (x     != NULL && "pointer can't be null");
+    assert (stop  != NULL && "pointer can't be null");
+
+    const char *pos = begin;
+
+    while (pos < end && (*pos == ' ' || *pos == '\t')) pos++;
+
+    // from_chars does not accept '+'
+    if (pos < end && *pos == '+')
+    {
+        pos++;
+
+        if (pos < end && *pos == '-')
+        {
+            *stop = begin;
+            return EINVAL;
+        }
+    }
+
+    std::from_chars_result res = std::from_chars (pos, end, *x, std::chars_format::general);
+
+    if (res.ec == std::errc::invalid_argument)
+    {
+        *stop = begin;
+        return EINVAL;
+    }
+
+    *stop = res.ptr;
+
+    if (res.ec == std::errc::result_out_of_range)
+    {
+        *x = is_large_magnitude (pos, res.ptr) ? HUGE_VAL : 0;
+        if (*pos == '-') *x = -*x;
+
+        return ERANGE;
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Check if decimal number in [begin, end) is not less than one by absolute value
+ *
+ * Used to tell overflow from underflow: decimal exponent is number of integer digits
+ * (or minus number of leading zeros after point) plus explicit exponent.
+ */
+static bool is_large_magnitude (const char *begin, const char *end)
+{
+    assert (begin != NULL && "pointer can't be null");
+    assert (end   != NULL && "pointer can't be null");
+
+    const char *pos = begin;
+
+    if (pos < end && *pos == '-') pos++;
+    while (pos < end && *pos == '0') pos++;
+
+    long magnitude = 0;
+
+    while (pos < end && '0' <= *pos && *pos <= '9')
+    {
+        magnitude++;
+        pos++;
+    }
+
+    if (pos < end && *pos == '.')
+    {
+        pos++;
+
+        if (magnitude == 0)
+        {
+            while (pos < end && *pos == '0')
+            {
+                magnitude--;
+                pos++;
+            }
+        }
+
+        while (pos < end && '0' <= *pos && *pos <= '9') pos++;
+    }
+
+    if (pos < end && (*pos == 'e' || *pos == 'E'))
+    {
+        pos++;
+
+        bool neg_exp = pos < end && *pos == '-';
+        if (pos < end && (*pos == '-' || *pos == '+')) pos++;
+
+        long exponent = 0;
+
+        // Saturate: any exponent above this is out of range anyway
+        for (; pos < end && '0' <= *pos && *pos <= '9'; pos++)
+        {
+            if (exponent < 1000000) exponent = exponent * 10 + (*pos - '0');
+        }
+
+        magnitude += neg_exp ? -exponent : exponent;
+    }
+
+    return magnitude > 0;
+}
+
+size_t format_solution (char *buffer, enum num_roots n_roots, const double roots[], enum solution_format format)
+{
+    assert (buffer != NULL && "pointer can't be null");
+    assert (roots  != NULL && "pointer can't be null");
+
+    char *pos = buffer;
+    char *end = buffer + MAX_SOLUTION_LEN;
+
+    // Complex roots are stored as real and imaginary parts
+    int n_values = n_roots == COMPLEX_ROOTS ? 2 : n_roots;
+
+    for (int i = n_values - 1; i >= 0; --i)
+    {
+        assert (isfinite(roots[i]) && "parameter must be finite");
+    }
+
+    if (format == FORMAT_MACHINE)
+    {
+        pos = std::to_chars (pos, end, (int) n_roots).ptr;
+
+        for (int i = 0; i < n_values; ++i)
+        {
+            *pos++ = ' ';
+            pos = format_root (pos, end, roots[i], format);
+        }
+
+        *pos++ = '\n';
+        return (size_t) (pos - buffer);
+    }
+
+    switch (n_roots) {
+        case FOUR_ROOTS:
+            pos = append_str  (pos, "4 solutions: ");
+            pos = format_root (pos, end, roots[0], format);
+            pos = append_str  (pos, ", ");
+            pos = format_root (pos, end, roots[1], format);
+            pos = append_str  (pos, ", ");
+            pos = format_root (pos, end, roots[2], format);
+            pos = append_str  (pos, " и ");
+            pos = format_root (pos, end, roots[3], format);
+            pos = append_str  (pos, "\n");
+            break;
+
+        case THREE_ROOTS:
+            pos = append_str  (pos, "3 solutions: ");
+            pos = format_root (pos, end, roots[0], format);
+            pos = append_str  (pos, ", ");
+            pos = format_root (pos, end, roots[1], format);
+            pos = append_str  (pos, " и ");
+            pos = format_root (pos, end, roots[2], format);
+            pos = append_str  (pos, "\n");
+            break;
+
+        case TWO_ROOTS:
+            pos = append_str  (pos, "2 solutions: ");
+            pos = format_root (pos, end, roots[0], format);
+            pos = append_str  (pos, " и ");
+            pos = format_root (pos, end, roots[1], format);
+            pos = append_str  (pos, "\n");
+            break;
+
+        case ONE_ROOT:
+            pos = append_str  (pos, "1 solution: ");
+            pos = format_root (pos, end, roots[0], format);
+            pos = append_str  (pos, "\n");
+            break;
+
+        case ZERO_ROOTS:
+            pos = append_str (pos, "No solutions\n");
+            break;
+
+        case COMPLEX_ROOTS:
+            pos = append_str  (pos, "2 complex solutions: ");
+            pos = format_root (pos, end, roots[0], format);
+            pos = append_str  (pos, " ± ");
+            pos = format_root (pos, end, roots[1], format);
+            pos = append_str  (pos, "i\n");
+            break;
+
+        case INF_ROOTS:
+            pos = append_str (pos, "Infinitive number of roots\n");
+            break;
+
+        case ERANGE_SOLVE:
+            pos = append_str (pos, "Failed to solve equation: Coefficients out of range\n");
+            break;
+
+        default:
+            assert (0 && "Invalid enum member");
+            break;
+    }
+
+    assert (pos <= end && "Buffer overflow");
+
+    return (size_t) (pos - buffer);
+}
+
+///@brief Write root in %.3e format (human) or shortest round trip format (machine)
+static char *format_root (char *pos, char *end, double root, enum solution_format format)
+{
+    assert (pos != NULL && "pointer can't be null");
+    assert (end != NULL && "pointer can't be null");
+
+    if (format == FORMAT_MACHINE)
+    {
+        return std::to_chars (pos, end, root).ptr;
+    }
+
+    if (is_zero (root)) root = 0;
+
+    return std::to_chars (pos, end, root, std::chars_format::scientific, 3).ptr;
+}
+
+///@brief Copy string without null terminator, return position after it
+static char *append_str (char *pos, const char *str)
+{
+    assert (pos != NULL && "pointer can't be null");
+    assert (str != NULL && "pointer can't be null");
+
+    size_t len = strlen (str);
+    memcpy (pos, str, len);
+
+    return pos + len;
+}
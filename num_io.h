@@ -0,0 +1,45 @@
+#ifndef QUAD_NUM_IO_H
+#define QUAD_NUM_IO_H
+
+#include <stddef.h>
+#include "equation_solver.h"
+
+///@brief Solution output format
+enum solution_format {
+    /// "2 solutions: -2.000e+00 и 2.000e+00", roots close to zero are printed as zero
+    FORMAT_HUMAN   = 0,
+    /// "2 -2 2": number of roots (num_roots value) and roots with shortest round trip representation
+    FORMAT_MACHINE = 1
+};
+
+///@brief Buffer size enough for any formatted solution
+const size_t MAX_SOLUTION_LEN = 128;
+
+/**
+ * @brief      Parse decimal floating point number from [begin, end), locale independent and correctly rounded
+ *
+ * Leading spaces and tabs are skipped, optional '+' or '-' sign is accepted. Reads at most up to end,
+ * so data does not need to be null-terminated.
+ *
+ * @param[in]  begin  Data begin
+ * @param[in]  end    Data end
+ * @param[out] x      Parsed value. On ERANGE: +-HUGE_VAL on overflow, +-0 on underflow (like strtod)
+ * @param[out] stop   Position after parsed number, begin if nothing was parsed
+ *
+ * @return     0 on success, ERANGE if value is out of double range, EINVAL if nothing was parsed
+ */
+int parse_double (const char *begin, const char *end, double *x, const char **stop);
+
+/**
+ * @brief      Write solution line (ending with '\n') to buffer, roots are not modified
+ *
+ * @param[out] buffer   Buffer of at least MAX_SOLUTION_LEN characters
+ * @param[in]  n_roots  Number of roots
+ * @param[in]  roots    Roots, only first n_roots are used (up to four), real and imaginary parts for COMPLEX_ROOTS
+ * @param[in]  format   Output format
+ *
+ * @return     Number of characters written, buffer is not null-terminated
+ */
+size_t format_solution (char *buffer, enum num_roots n_roots, const double roots[], enum solution_format format);
+
+#endif //QUAD_NUM_IO_H
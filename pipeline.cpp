@@ -0,0 +1,501 @@
+#include <cassert>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <atomic>
+#include <thread>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "equation_solver.h"
+#include "batch_io.h"
+#include "num_io.h"
+#include "ring_queue.h"
+#include "pipeline.h"
+
+/// Size of text buffer of block, longer lines are rejected
+static const size_t BLOCK_TEXT_SIZE = 1 << 20;
+
+/// Max number of lines in block
+static const size_t BLOCK_LINES = 1 << 14;
+
+/// Number of coefficients in quadric equation
+static const int NUM_COEFFS = 3;
+
+/// Number of coefficients in cubic equation
+static const int NUM_CUBIC_COEFFS = 4;
+
+///@brief Lines of input with their equations and formatted solutions
+struct stream_block
+{
+    size_t seq;         ///< Number of block in input
+
+    char       *buffer; ///< Text buffer, NULL for mapped input
+    const char *text;   ///< Whole lines of block, in buffer or in mapping
+    size_t      size;   ///< Size of text
+
+    eq_batch batch;
+
+    char  *out;         ///< Formatted solutions, BLOCK_LINES * MAX_SOLUTION_LEN characters
+    size_t out_len;
+};
+
+///@brief State shared by all stages
+struct pipeline
+{
+    FILE *in_stream;
+    const batch_opts    *opts;
+    const pipeline_opts *popts;
+
+    stream_map map;     ///< Mapping of regular input file, map.addr is NULL for other streams
+
+    ring_queue *free_blocks;
+    ring_queue *parse_queue;
+    ring_queue *solve_queue;
+    ring_queue *write_queue;
+
+    stream_block **blocks;   ///< Allocated blocks
+    size_t         n_blocks; ///< Number of allocated blocks, only reader allocates them
+    size_t         max_blocks;
+
+    std::atomic<int> n_parsers; ///< Running parsers, the last one closes solve_queue
+    std::atomic<int> n_solvers; ///< Running solvers, the last one closes write_queue
+    std::atomic<int> err;       ///< The first error, stages skip their work after it
+};
+
+///@brief Argument of parse_line
+struct parse_args
+{
+    eq_batch *batch;
+    int       n_coeffs;
+};
+
+static size_t block_mem    (bool mapped);
+static stream_block *get_free_block (pipeline *pl);
+static size_t cut_lines    (const char *data, size_t size, bool last);
+static void set_error      (pipeline *pl, int err);
+static void reader_main    (pipeline *pl);
+static void read_mapped_blocks (pipeline *pl);
+static void read_stream_blocks (pipeline *pl);
+static void parser_main    (pipeline *pl);
+static int  parse_line     (const char *line, const char *end, void *arg);
+static void solver_main    (pipeline *pl, int solver_id);
+static void writer_main    (pipeline *pl, FILE *out_stream);
+static void free_block     (stream_block *block);
+
+void pipeline_opts_init (struct pipeline_opts *popts, int n_threads, size_t mem_limit)
+{
+    assert (popts != NULL && "pointer can't be null");
+    assert (n_threads >= 0 && "number of threads can't be negative");
+
+    if (n_threads == 0) n_threads = (int) std::thread::hardware_concurrency ();
+
+    // Parsing is slower than solving and formatting, so parsers get the odd worker
+    popts->n_parsers = n_threads > 2 ? (n_threads + 1) / 2 : 1;
+    popts->n_solvers = n_threads > 2 ? n_threads / 2       : 1;
+    popts->mem_limit = mem_limit;
+}
+
+size_t pipeline_min_mem (void)
+{
+    return 2 * block_mem (false);
+}
+
+int solve_stream_pipelined (FILE *in_stream, FILE *out_stream, const struct batch_opts *opts,
+                            const struct pipeline_opts *popts)
+{
+    assert (in_stream  != NULL && "pointer can't be null");
+    assert (out_stream != NULL && "pointer can't be null");
+    assert (opts       != NULL && "pointer can't be null");
+    assert (popts      != NULL && "pointer can't be null");
+    assert (opts->pool == NULL && "pipeline workers solve without pool");
+    assert (popts->n_parsers > 0 && popts->n_solvers > 0 && "every stage needs a worker");
+
+    pipeline pl = {};
+    pl.in_stream = in_stream;
+    pl.opts      = opts;
+    pl.popts     = popts;
+
+    struct stat in_stat = {};
+    int err = 0;
+
+    if (fstat (fileno (in_stream), &in_stat) == 0 && S_ISREG (in_stat.st_mode))
+    {
+        err = map_stream (in_stream, &pl.map);
+        if (err != 0) return err;
+
+        if (pl.map.addr == NULL) return 0;
+
+        madvise (pl.map.addr, pl.map.map_size, MADV_SEQUENTIAL);
+    }
+
+    pl.max_blocks = popts->mem_limit / block_mem (pl.map.addr != NULL);
+
+    if (pl.max_blocks < 2)
+    {
+        unmap_stream (&pl.map);
+        return EINVAL;
+    }
+
+    // Every queue holds all blocks, so only the reader waits for free blocks
+    pl.blocks      = (stream_block **) calloc (pl.max_blocks, sizeof (stream_block *));
+    pl.free_blocks = ring_queue_create (pl.max_blocks);
+    pl.parse_queue = ring_queue_create (pl.max_blocks);
+    pl.solve_queue = ring_queue_create (pl.max_blocks);
+    pl.write_queue = ring_queue_create (pl.max_blocks);
+
+    if (pl.blocks == NULL || pl.free_blocks == NULL || pl.parse_queue == NULL ||
+        pl.solve_queue == NULL || pl.write_queue == NULL)
+    {
+        err = ENOMEM;
+    }
+
+    if (err == 0)
+    {
+        pl.n_parsers.store (popts->n_parsers);
+        pl.n_solvers.store (popts->n_solvers);
+
+        int n_threads = 1 + popts->n_parsers + popts->n_solvers;
+        std::thread *threads = new (std::nothrow) std::thread[n_threads];
+
+        if (threads == NULL)
+        {
+            err = ENOMEM;
+        }
+        else
+        {
+            threads[0] = std::thread (reader_main, &pl);
+
+            for (int i = 0; i < popts->n_parsers; ++i) threads[1 + i] = std::thread (parser_main, &pl);
+
+            for (int i = 0; i < popts->n_solvers; ++i)
+            {
+                threads[1 + popts->n_parsers + i] = std::thread (solver_main, &pl, i);
+            }
+
+            writer_main (&pl, out_stream);
+
+            for (int i = 0; i < n_threads; ++i) threads[i].join ();
+
+            delete[] threads;
+
+            err = pl.err.load ();
+        }
+    }
+
+    if (err == 0 && (fflush (out_stream) != 0 || ferror (out_stream))) err = EIO;
+
+    for (size_t i = 0; i < pl.n_blocks; ++i) free_block (pl.blocks[i]);
+
+    ring_queue_destroy (pl.free_blocks);
+    ring_queue_destroy (pl.parse_queue);
+    ring_queue_destroy (pl.solve_queue);
+    ring_queue_destroy (pl.write_queue);
+    free (pl.blocks);
+
+    if (pl.map.addr != NULL)
+    {
+        unmap_stream (&pl.map);
+
+        // Leave stream at the end, as if it was read
+        fseeko (in_stream, 0, SEEK_END);
+    }
+
+    return err;
+}
+
+///@brief Memory of one block: batch, formatted solutions and text buffer for not mapped input
+static size_t block_mem (bool mapped)
+{
+    size_t batch_mem = BLOCK_LINES * (7 * sizeof (double) + sizeof (enum num_roots) + sizeof (bool) + sizeof (uint8_t));
+
+    return sizeof (stream_block) + batch_mem + BLOCK_LINES * MAX_SOLUTION_LEN + (mapped ? 0 : BLOCK_TEXT_SIZE);
+}
+
+///@brief Take free block or allocate a new one below memory limit, NULL on allocation error
+static stream_block *get_free_block (pipeline *pl)
+{
+    assert (pl != NULL && "pointer can't be null");
+
+    stream_block *block = (stream_block *) ring_queue_try_pop (pl->free_blocks);
+    if (block != NULL) return block;
+
+    if (pl->n_blocks == pl->max_blocks) return (stream_block *) ring_queue_pop (pl->free_blocks);
+
+    block = (stream_block *) calloc (1, sizeof (stream_block));
+    if (block == NULL) return NULL;
+
+    block->out = (char *) malloc (BLOCK_LINES * MAX_SOLUTION_LEN);
+
+    if (pl->map.addr == NULL) block->buffer = (char *) malloc (BLOCK_TEXT_SIZE);
+
+    if (eq_batch_ctor (&block->batch, BLOCK_LINES) != 0 || block->out == NULL ||
+        (pl->map.addr == NULL && block->buffer == NULL))
+    {
+        free_block (block);
+        return NULL;
+    }
+
+    pl->blocks[pl->n_blocks++] = block;
+
+    return block;
+}
+
+static void free_block (stream_block *block)
+{
+    if (block == NULL) return;
+
+    if (block->batch.a != NULL) eq_batch_dtor (&block->batch);
+
+    free (block->buffer);
+    free (block->out);
+    free (block);
+}
+
+/**
+ * @brief Find end of block: after BLOCK_LINES-th '\n' or after the last '\n' in data
+ *
+ * @param[in] last  Data is the end of input, so text after last '\n' is in block too
+ *
+ * @return Size of block, 0 if there is no complete line
+ */
+static size_t cut_lines (const char *data, size_t size, bool last)
+{
+    assert (data != NULL && "pointer can't be null");
+
+    const char *pos      = data;
+    const char *data_end = data + size;
+    const char *cut      = data;
+
+    for (size_t n_lines = 0; n_lines < BLOCK_LINES; ++n_lines)
+    {
+        const char *line_end = (const char *) memchr (pos, '\n', (size_t) (data_end - pos));
+
+        if (line_end == NULL) return last ? size : (size_t) (cut - data);
+
+        pos = cut = line_end + 1;
+    }
+
+    return (size_t) (cut - data);
+}
+
+///@brief Remember the first error
+static void set_error (pipeline *pl, int err)
+{
+    assert (pl != NULL && "pointer can't be null");
+
+    int no_err = 0;
+    pl->err.compare_exchange_strong (no_err, err);
+}
+
+///@brief Cut input into blocks and pass them to parsers
+static void reader_main (pipeline *pl)
+{
+    assert (pl != NULL && "pointer can't be null");
+
+    if (pl->map.addr != NULL) read_mapped_blocks (pl);
+    else                      read_stream_blocks (pl);
+
+    ring_queue_close (pl->parse_queue);
+}
+
+///@brief Cut mapped file into blocks, text of blocks points into mapping
+static void read_mapped_blocks (pipeline *pl)
+{
+    assert (pl != NULL && "pointer can't be null");
+
+    const char *data = pl->map.data;
+    size_t      size = pl->map.size;
+
+    for (size_t seq = 0; size > 0 && pl->err.load (std::memory_order_relaxed) == 0; ++seq)
+    {
+        stream_block *block = get_free_block (pl);
+
+        if (block == NULL)
+        {
+            set_error (pl, ENOMEM);
+            return;
+        }
+
+        block->seq  = seq;
+        block->text = data;
+        block->size = cut_lines (data, size, true);
+
+        data += block->size;
+        size -= block->size;
+
+        ring_queue_push (pl->parse_queue, block);
+    }
+}
+
+///@brief Read stream into block buffers, incomplete line at the end of buffer is moved to the next block
+static void read_stream_blocks (pipeline *pl)
+{
+    assert (pl != NULL && "pointer can't be null");
+
+    const char *carry      = NULL; // Text after the previous block
+    size_t      carry_size = 0;
+    bool        eof        = false;
+
+    for (size_t seq = 0; pl->err.load (std::memory_order_relaxed) == 0; ++seq)
+    {
+        stream_block *block = get_free_block (pl);
+
+        if (block == NULL)
+        {
+            set_error (pl, ENOMEM);
+            return;
+        }
+
+        // Previous block may be already written and reused as this one
+        if (carry_size > 0) memmove (block->buffer, carry, carry_size);
+
+        size_t size = carry_size;
+
+        while (size < BLOCK_TEXT_SIZE && !eof)
+        {
+            size_t n_read = fread (block->buffer + size, 1, BLOCK_TEXT_SIZE - size, pl->in_stream);
+
+            size += n_read;
+            eof   = n_read == 0;
+        }
+
+        if (eof && ferror (pl->in_stream))
+        {
+            ring_queue_push (pl->free_blocks, block);
+            set_error (pl, EIO);
+            return;
+        }
+
+        block->seq  = seq;
+        block->text = block->buffer;
+        block->size = cut_lines (block->buffer, size, eof);
+
+        // Line does not fit into buffer
+        if (block->size == 0 && size == BLOCK_TEXT_SIZE)
+        {
+            ring_queue_push (pl->free_blocks, block);
+            set_error (pl, EINVAL);
+            return;
+        }
+
+        if (block->size == 0)
+        {
+            ring_queue_push (pl->free_blocks, block);
+            return;
+        }
+
+        carry      = block->buffer + block->size;
+        carry_size = size - block->size;
+
+        ring_queue_push (pl->parse_queue, block);
+    }
+}
+
+///@brief Parse lines of blocks into their batches
+static void parser_main (pipeline *pl)
+{
+    assert (pl != NULL && "pointer can't be null");
+
+    stream_block *block = NULL;
+
+    while ((block = (stream_block *) ring_queue_pop (pl->parse_queue)) != NULL)
+    {
+        block->batch.size = 0;
+
+        if (pl->err.load (std::memory_order_relaxed) == 0)
+        {
+            parse_args args = {&block->batch, pl->opts->cubic ? NUM_CUBIC_COEFFS : NUM_COEFFS};
+            size_t     done = 0;
+
+            scan_lines (block->text, block->size, true, parse_line, &args, &done);
+        }
+
+        ring_queue_push (pl->solve_queue, block);
+    }
+
+    if (pl->n_parsers.fetch_sub (1) == 1) ring_queue_close (pl->solve_queue);
+}
+
+///@brief Add line to batch given in arg
+static int parse_line (const char *line, const char *end, void *arg)
+{
+    assert (arg != NULL && "pointer can't be null");
+
+    const parse_args *args = (const parse_args *) arg;
+
+    eq_batch_add_line (args->batch, line, end, args->n_coeffs);
+
+    return 0;
+}
+
+///@brief Solve and format batches of blocks, cache shard solver_id is used
+static void solver_main (pipeline *pl, int solver_id)
+{
+    assert (pl != NULL && "pointer can't be null");
+
+    // Errors are added by writer in input order
+    batch_opts opts  = *pl->opts;
+    opts.errors      = NULL;
+    opts.cache_shard = solver_id;
+
+    stream_block *block = NULL;
+
+    while ((block = (stream_block *) ring_queue_pop (pl->solve_queue)) != NULL)
+    {
+        block->out_len = 0;
+
+        if (pl->err.load (std::memory_order_relaxed) == 0)
+        {
+            eq_batch_solve (&block->batch, &opts);
+            block->out_len = eq_batch_format (&block->batch, 0, block->batch.size, &opts, block->out);
+        }
+
+        ring_queue_push (pl->write_queue, block);
+    }
+
+    if (pl->n_solvers.fetch_sub (1) == 1) ring_queue_close (pl->write_queue);
+}
+
+///@brief Write blocks in input order and return them to reader
+static void writer_main (pipeline *pl, FILE *out_stream)
+{
+    assert (pl         != NULL && "pointer can't be null");
+    assert (out_stream != NULL && "pointer can't be null");
+
+    // Blocks in flight have numbers in [next_seq, next_seq + max_blocks), block n waits in pending[n % max_blocks]
+    stream_block **pending  = (stream_block **) calloc (pl->max_blocks, sizeof (stream_block *));
+    size_t         next_seq = 0;
+
+    if (pending == NULL) set_error (pl, ENOMEM);
+
+    stream_block *block = NULL;
+
+    while ((block = (stream_block *) ring_queue_pop (pl->write_queue)) != NULL)
+    {
+        if (pending == NULL)
+        {
+            ring_queue_push (pl->free_blocks, block);
+            continue;
+        }
+
+        pending[block->seq % pl->max_blocks] = block;
+
+        while ((block = pending[next_seq % pl->max_blocks]) != NULL)
+        {
+            pending[next_seq % pl->max_blocks] = NULL;
+            next_seq++;
+
+            if (pl->err.load (std::memory_order_relaxed) == 0)
+            {
+                if (fwrite (block->out, 1, block->out_len, out_stream) != block->out_len) set_error (pl, EIO);
+
+                if (pl->opts->errors != NULL) batch_errors_add (pl->opts->errors, block->batch.size, block->batch.status);
+            }
+
+            ring_queue_push (pl->free_blocks, block);
+        }
+    }
+
+    free (pending);
+}
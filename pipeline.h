@@ -0,0 +1,54 @@
+#ifndef QUAD_PIPELINE_H
+#define QUAD_PIPELINE_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include "batch_io.h"
+
+/*
+ * Pipelined solving of text streams. Input is cut into blocks of whole lines, every block goes through stages
+ * connected by bounded ring queues (see ring_queue.h):
+ *
+ *     reader -> parsers -> solvers -> writer -> free blocks -> reader
+ *
+ * Reader thread reads large buffers (regular files are mapped, so it only cuts them), parser workers parse
+ * lines into batches, solver workers solve and format them, writer (calling thread) writes blocks in input order.
+ * Blocks are allocated on demand up to the memory limit and then reused, so the reader waits for a free block
+ * when the slowest stage is behind and memory stays flat on endless streams.
+ */
+
+///@brief Options of pipelined solving
+struct pipeline_opts
+{
+    int    n_parsers; ///< Parser workers, at least 1
+    int    n_solvers; ///< Solver workers, at least 1, solver i uses cache shard i
+    size_t mem_limit; ///< Max memory of blocks in bytes, not less than pipeline_min_mem ()
+};
+
+/// Default memory limit of blocks
+const size_t PIPELINE_DEFAULT_MEM = 64 << 20;
+
+/**@brief Split n_threads workers between parsers and solvers
+ *
+ * @param [in] n_threads Number of workers, 0 for number of CPUs. Reader and writer threads are not counted
+ * @param [in] mem_limit Max memory of blocks in bytes
+ */
+void pipeline_opts_init (struct pipeline_opts *popts, int n_threads, size_t mem_limit);
+
+///@brief Memory of two blocks, the least limit which lets reader and writer work at the same time
+size_t pipeline_min_mem (void);
+
+/**
+ * @brief Solve equations from in_stream and write solutions to out_stream like solve_stream, with pipeline of threads
+ *
+ * Output is the same as of solve_stream. Lines must not be longer than 1 MiB.
+ *
+ * @param[in] opts  Options of solving, opts->pool must be NULL. Cache must have at least popts->n_solvers shards,
+ *                  opts->errors is updated in input order
+ *
+ * @return Non zero value (errno value) on read or write error, EINVAL if line is too long or memory limit is too low
+ */
+int solve_stream_pipelined (FILE *in_stream, FILE *out_stream, const struct batch_opts *opts,
+                            const struct pipeline_opts *popts);
+
+#endif //QUAD_PIPELINE_H
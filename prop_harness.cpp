@@ -0,0 +1,437 @@
+#include <math.h>
+#include <cfloat>
+#include <cinttypes>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+#include "equation_solver.h"
+#include "common_equation_solver.h"
+#include "thread_pool.h"
+#include "prop_harness.h"
+
+/// Cases of one chunk, they have the same family and are solved as one batch
+static const size_t PROP_CHUNK_SIZE = 4096;
+
+///@brief Reference solution: exact number of roots and roots in quad precision
+struct prop_ref
+{
+    enum num_roots n_roots;
+    __float128     x1;
+    __float128     x2;
+};
+
+///@brief Arrays and results of one worker, padded against false sharing
+struct alignas(CACHE_LINE_SIZE) prop_worker
+{
+    double a[PROP_CHUNK_SIZE];
+    double b[PROP_CHUNK_SIZE];
+    double c[PROP_CHUNK_SIZE];
+    double x1[PROP_CHUNK_SIZE];
+    double x2[PROP_CHUNK_SIZE];
+    enum num_roots n_roots[PROP_CHUNK_SIZE];
+
+    prop_report report;
+};
+
+///@brief Arguments of run_chunk
+struct prop_args
+{
+    const prop_opts *opts;
+    prop_worker     *workers;
+};
+
+///@brief x == 0 without -Wfloat-equal
+template <typename T>
+static inline bool is_exact_zero (T x)
+{
+    return !(x < 0) && !(x > 0);
+}
+
+static void     run_chunk      (void *arg, size_t chunk, int thread_id);
+static void     rand_equation  (enum prop_family family, uint64_t *state, double *a, double *b, double *c);
+static prop_ref solve_reference (double a, double b, double c);
+static double   ulp_error      (double x, __float128 ref);
+static void     merge_stats    (prop_stats *to, const prop_stats *from);
+static uint64_t rand_u64       (uint64_t *state);
+static double   rand_unit      (uint64_t *state);
+static double   rand_sign      (uint64_t *state);
+static int      rand_int       (uint64_t *state, int min, int max);
+
+int prop_run (const struct prop_opts *opts, struct prop_report *report)
+{
+    assert (opts   != NULL && "pointer can't be null");
+    assert (report != NULL && "pointer can't be null");
+
+    int n_workers = opts->pool != NULL ? thread_pool_size (opts->pool) : 1;
+
+    prop_worker *workers = (prop_worker *) aligned_alloc (CACHE_LINE_SIZE, (size_t) n_workers * sizeof (prop_worker));
+    if (workers == NULL) return ENOMEM;
+
+    memset (workers, 0, (size_t) n_workers * sizeof (prop_worker));
+
+    prop_args args   = {opts, workers};
+    size_t  n_chunks = (opts->n_cases + PROP_CHUNK_SIZE - 1) / PROP_CHUNK_SIZE;
+
+    if (opts->pool != NULL) thread_pool_run (opts->pool, n_chunks, run_chunk, &args);
+    else for (size_t chunk = 0; chunk < n_chunks; ++chunk) run_chunk (&args, chunk, 0);
+
+    *report = {};
+    report->n_cases = opts->n_cases;
+
+    for (int worker = 0; worker < n_workers; ++worker)
+    {
+        for (int variant = 0; variant < N_PROP_VARIANTS; ++variant)
+        {
+            for (int family = 0; family < N_PROP_FAMILIES; ++family)
+            {
+                merge_stats (&report->stats[variant][family], &workers[worker].report.stats[variant][family]);
+            }
+        }
+    }
+
+    free (workers);
+
+    return 0;
+}
+
+///@brief Generate chunk of equations, solve it with every variant and check solutions
+static void run_chunk (void *arg, size_t chunk, int thread_id)
+{
+    assert (arg != NULL && "pointer can't be null");
+
+    const prop_args *args   = (const prop_args *) arg;
+    prop_worker     *worker = &args->workers[thread_id];
+
+    enum prop_family family = (enum prop_family) (chunk % N_PROP_FAMILIES);
+
+    uint64_t begin = chunk * PROP_CHUNK_SIZE;
+    size_t   size  = args->opts->n_cases - begin < PROP_CHUNK_SIZE ? args->opts->n_cases - begin
+                                                                    : PROP_CHUNK_SIZE;
+
+    // Generator of chunk doesn't depend on worker
+    uint64_t state = args->opts->seed ^ (chunk * 0x9E3779B97F4A7C15ull);
+
+    for (size_t i = 0; i < size; ++i) rand_equation (family, &state, &worker->a[i], &worker->b[i], &worker->c[i]);
+
+    for (int variant = 0; variant < N_PROP_VARIANTS; ++variant)
+    {
+        static const solver_mode MODES[N_PROP_VARIANTS] = {SOLVER_CLASSIC, SOLVER_BRANCHLESS, SOLVER_ACCURATE, SOLVER_CLASSIC};
+
+        solve_quad_eq_batch_mode (MODES[variant], size, worker->a, worker->b, worker->c,
+                                  worker->x1, worker->x2, worker->n_roots);
+
+        if (variant == VARIANT_POLISHED)
+        {
+            polish_quad_eq_batch (size, worker->a, worker->b, worker->c, worker->n_roots, worker->x1, worker->x2, NULL);
+        }
+
+        prop_stats *stats = &worker->report.stats[variant][family];
+
+        for (size_t i = 0; i < size; ++i)
+        {
+            prop_check (worker->a[i], worker->b[i], worker->c[i], worker->n_roots[i], worker->x1[i], worker->x2[i], stats);
+        }
+    }
+}
+
+void prop_check (double a, double b, double c, enum num_roots n_roots, double x1, double x2, struct prop_stats *stats)
+{
+    assert (stats != NULL && "pointer can't be null");
+
+    stats->n_cases++;
+
+    prop_ref ref = solve_reference (a, b, c);
+
+    int n_ref = ref.n_roots == ONE_ROOT ? 1 : ref.n_roots == TWO_ROOTS ? 2 : 0;
+
+    // Roots of reference, which don't fit into double, must be rejected
+    bool ref_range = (n_ref < 1 || fabs (ref.x1) <= (__float128) DBL_MAX) &&
+                     (n_ref < 2 || fabs (ref.x2) <= (__float128) DBL_MAX);
+
+    if (n_roots == ERANGE_SOLVE)
+    {
+        if (ref_range) stats->n_range++;
+        return;
+    }
+
+    if (n_roots != ref.n_roots)
+    {
+        stats->n_misclassified++;
+        return;
+    }
+
+    if ((n_ref >= 1 && !isfinite (x1)) || (n_ref == 2 && !isfinite (x2)))
+    {
+        stats->n_not_finite++;
+        return;
+    }
+
+    if (!ref_range)
+    {
+        stats->n_range++;
+        return;
+    }
+
+    if (n_ref == 0) return;
+
+    double err1 = 0, err2 = 0;
+
+    if (n_ref == 1)
+    {
+        err1 = ulp_error (x1, ref.x1);
+    }
+    else
+    {
+        // Roots of solvers are in any order
+        __float128 ref_small = ref.x1 < ref.x2 ? ref.x1 : ref.x2;
+        __float128 ref_big   = ref.x1 < ref.x2 ? ref.x2 : ref.x1;
+
+        err1 = ulp_error (fmin (x1, x2), ref_small);
+        err2 = ulp_error (fmax (x1, x2), ref_big);
+    }
+
+    double err = fmax (err1, err2);
+
+    stats->n_roots += (uint64_t) n_ref;
+    stats->sum_ulp += err1 + err2;
+
+    if (err > stats->max_ulp)
+    {
+        stats->max_ulp  = err;
+        stats->worst[0] = a;
+        stats->worst[1] = b;
+        stats->worst[2] = c;
+    }
+}
+
+///@brief Error of x in ULP of the double nearest to reference root
+static double ulp_error (double x, __float128 ref)
+{
+    double nearest = fabs ((double) ref);
+
+    // Distance to the next double, the least subnormal for zero
+    double ulp = nextafter (nearest, INFINITY) - nearest;
+
+    if (!isfinite (ulp)) ulp = nearest - nextafter (nearest, 0);
+
+    return (double) (fabs ((__float128) x - ref) / ulp);
+}
+
+/**
+ * @brief Exact number of roots and roots in quad precision
+ *
+ * Products of doubles are exact in __float128 and b^2 - 4ac is rounded once, so the sign of discriminant is exact.
+ */
+static prop_ref solve_reference (double a, double b, double c)
+{
+    prop_ref ref = {ZERO_ROOTS, 0, 0};
+
+    if (is_exact_zero (a))
+    {
+        if (is_exact_zero (b))
+        {
+            ref.n_roots = is_exact_zero (c) ? INF_ROOTS : ZERO_ROOTS;
+        }
+        else
+        {
+            ref.n_roots = ONE_ROOT;
+            ref.x1 = -(__float128) c / b;
+        }
+
+        return ref;
+    }
+
+    __float128 disc = (__float128) b * b - 4 * ((__float128) a * c);
+
+    if (disc < 0) return ref;
+
+    if (is_exact_zero (disc))
+    {
+        ref.n_roots = ONE_ROOT;
+        ref.x1 = -(__float128) b / (2 * (__float128) a);
+
+        return ref;
+    }
+
+    // Stable formula: no cancellation of b and sqrt (disc)
+    __float128 q = -((__float128) b + (b < 0 ? -sqrt (disc) : sqrt (disc))) / 2;
+
+    ref.n_roots = TWO_ROOTS;
+    ref.x1 = q / a;
+    ref.x2 = !is_exact_zero (q) ? c / q : 0;
+
+    return ref;
+}
+
+static void merge_stats (prop_stats *to, const prop_stats *from)
+{
+    assert (to   != NULL && "pointer can't be null");
+    assert (from != NULL && "pointer can't be null");
+
+    to->n_cases         += from->n_cases;
+    to->n_misclassified += from->n_misclassified;
+    to->n_range         += from->n_range;
+    to->n_not_finite    += from->n_not_finite;
+    to->n_roots         += from->n_roots;
+    to->sum_ulp         += from->sum_ulp;
+
+    if (from->max_ulp > to->max_ulp)
+    {
+        to->max_ulp = from->max_ulp;
+        memcpy (to->worst, from->worst, sizeof (to->worst));
+    }
+}
+
+static void rand_equation (enum prop_family family, uint64_t *state, double *a, double *b, double *c)
+{
+    assert (state != NULL && "pointer can't be null");
+    assert (a     != NULL && "pointer can't be null");
+    assert (b     != NULL && "pointer can't be null");
+    assert (c     != NULL && "pointer can't be null");
+
+    switch (family)
+    {
+        case FAMILY_UNIFORM:
+            *a = 200 * rand_unit (state) - 100;
+            *b = 200 * rand_unit (state) - 100;
+            *c = 200 * rand_unit (state) - 100;
+            break;
+
+        case FAMILY_FULL_RANGE:
+        {
+            double *coeffs[3] = {a, b, c};
+
+            for (double *coeff : coeffs)
+            {
+                uint64_t bits = rand_u64 (state);
+
+                // Exponents 0 (zero and subnormals) to 2046 (the biggest finite), every 64th coefficient is zero
+                uint64_t exp = bits % 64 == 0 ? 0 : (bits >> 52) % 2047;
+                bits = (bits & 0x800FFFFFFFFFFFFFull) | (exp << 52);
+
+                if (exp == 0 && (bits >> 6) % 2 == 0) bits &= 0x8000000000000000ull;
+
+                memcpy (coeff, &bits, sizeof (bits));
+            }
+
+            break;
+        }
+
+        case FAMILY_NEAR_DOUBLE:
+        {
+            double root = rand_sign (state) * ldexp (1 + rand_unit (state), rand_int (state, -20, 20));
+            double rel  = rand_sign (state) * ldexp (1 + rand_unit (state), rand_int (state, -60, -20));
+
+            *a = rand_sign (state) * ldexp (1 + rand_unit (state), rand_int (state, -400, 400));
+            *b = -2 * *a * root;
+            *c = *a * root * root * (1 + rel);
+            break;
+        }
+
+        case FAMILY_HUGE_B:
+            *a = rand_sign (state) * ldexp (1 + rand_unit (state), rand_int (state, -10, 10));
+            *b = rand_sign (state) * ldexp (1 + rand_unit (state), rand_int (state, 300, 1000));
+            *c = rand_sign (state) * ldexp (1 + rand_unit (state), rand_int (state, -10, 10));
+            break;
+
+        case FAMILY_TINY_A:
+            *a = rand_sign (state) * ldexp (1 + rand_unit (state), rand_int (state, -1074, -30));
+            *b = rand_sign (state) * ldexp (1 + rand_unit (state), rand_int (state, -3, 3));
+            *c = rand_sign (state) * ldexp (1 + rand_unit (state), rand_int (state, -3, 3));
+            break;
+
+        case N_PROP_FAMILIES:
+        default:
+            assert (0 && "Invalid enum member");
+            break;
+    }
+}
+
+///@brief splitmix64 generator
+static uint64_t rand_u64 (uint64_t *state)
+{
+    assert (state != NULL && "pointer can't be null");
+
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ull);
+
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+
+    return z ^ (z >> 31);
+}
+
+///@brief Uniform double in [0, 1)
+static double rand_unit (uint64_t *state)
+{
+    return (double) (rand_u64 (state) >> 11) * 0x1p-53;
+}
+
+static double rand_sign (uint64_t *state)
+{
+    return rand_u64 (state) >> 63 ? -1.0 : 1.0;
+}
+
+///@brief Uniform integer in [min, max]
+static int rand_int (uint64_t *state, int min, int max)
+{
+    assert (min <= max && "empty range");
+
+    return min + (int) (rand_u64 (state) % (uint64_t) (max - min + 1));
+}
+
+void prop_print_report (const struct prop_report *report, FILE *stream)
+{
+    assert (report != NULL && "pointer can't be null");
+    assert (stream != NULL && "pointer can't be null");
+
+    fprintf (stream, "%-11s %-12s %12s %13s %10s %10s %12s %10s\n",
+             "solver", "family", "cases", "misclassified", "range", "not finite", "max ULP", "mean ULP");
+
+    for (int variant = 0; variant < N_PROP_VARIANTS; ++variant)
+    {
+        for (int family = 0; family < N_PROP_FAMILIES; ++family)
+        {
+            const prop_stats *stats = &report->stats[variant][family];
+
+            fprintf (stream, "%-11s %-12s %12" PRIu64 " %13" PRIu64 " %10" PRIu64 " %10" PRIu64 " %12.4g %10.4g\n",
+                     prop_variant_name ((prop_variant) variant), prop_family_name ((prop_family) family),
+                     stats->n_cases, stats->n_misclassified, stats->n_range, stats->n_not_finite, stats->max_ulp,
+                     stats->n_roots > 0 ? stats->sum_ulp / (double) stats->n_roots : 0.0);
+        }
+    }
+
+    fprintf (stream, "\nWorst equations:\n");
+
+    for (int variant = 0; variant < N_PROP_VARIANTS; ++variant)
+    {
+        for (int family = 0; family < N_PROP_FAMILIES; ++family)
+        {
+            const prop_stats *stats = &report->stats[variant][family];
+
+            if (is_exact_zero (stats->max_ulp)) continue;
+
+            fprintf (stream, "%-11s %-12s %.4g ULP: %.17g %.17g %.17g\n",
+                     prop_variant_name ((prop_variant) variant), prop_family_name ((prop_family) family),
+                     stats->max_ulp, stats->worst[0], stats->worst[1], stats->worst[2]);
+        }
+    }
+}
+
+const char *prop_family_name (enum prop_family family)
+{
+    static const char *const NAMES[N_PROP_FAMILIES] = {"uniform", "full_range", "near_double", "huge_b", "tiny_a"};
+
+    assert (family >= 0 && family < N_PROP_FAMILIES && "Invalid enum member");
+
+    return NAMES[family];
+}
+
+const char *prop_variant_name (enum prop_variant variant)
+{
+    static const char *const NAMES[N_PROP_VARIANTS] = {"classic", "branchless", "accurate", "polished"};
+
+    assert (variant >= 0 && variant < N_PROP_VARIANTS && "Invalid enum member");
+
+    return NAMES[variant];
+}
@@ -0,0 +1,87 @@
+#ifndef QUAD_PROP_HARNESS_H
+#define QUAD_PROP_HARNESS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "equation_solver.h"
+
+/*
+ * Randomized property-based harness of quadratic solvers. Random equations of several families are solved
+ * by every solver variant and compared with reference solution in quad precision (__float128): products of
+ * doubles are exact in it, so the number of real roots of the reference is exact.
+ *
+ * Cases are split into chunks, chunk i has family i % N_PROP_FAMILIES and its own random generator seeded
+ * by seed and i, so counts and max errors depend on seed and number of cases only, not on number of threads.
+ * Sums of errors are merged in order of threads and may differ in last bits, worst equation may be another one
+ * with the same max error.
+ */
+
+///@brief Family of random equations
+enum prop_family {
+    FAMILY_UNIFORM = 0, ///< Coefficients in [-100, 100], as in auto_test_solve_quad_eq
+    FAMILY_FULL_RANGE,  ///< Random sign, mantissa and exponent over all finite doubles, zeros and subnormals included
+    FAMILY_NEAR_DOUBLE, ///< a (x - r)^2 with c perturbed by 2^-20..2^-60 relative, a of any scale
+    FAMILY_HUGE_B,      ///< |b| in 2^300..2^1000, a and c near 1: cancellation in -b + sqrt (D)
+    FAMILY_TINY_A,      ///< |a| in 2^-1074..2^-30, b and c near 1: nearly linear equation with a huge root
+    N_PROP_FAMILIES
+};
+
+///@brief Solver variant under test
+enum prop_variant {
+    VARIANT_CLASSIC = 0, ///< solve_quad_eq_batch_mode (SOLVER_CLASSIC)
+    VARIANT_BRANCHLESS,  ///< solve_quad_eq_batch_mode (SOLVER_BRANCHLESS)
+    VARIANT_ACCURATE,    ///< solve_quad_eq_batch_mode (SOLVER_ACCURATE)
+    VARIANT_POLISHED,    ///< SOLVER_CLASSIC with polish_quad_eq_batch
+    N_PROP_VARIANTS
+};
+
+///@brief Results of one variant on one family
+struct prop_stats
+{
+    uint64_t n_cases;
+    uint64_t n_misclassified; ///< Number of roots differs from the exact one
+    uint64_t n_range;         ///< ERANGE_SOLVE though reference roots are doubles, or roots though they overflow
+    uint64_t n_not_finite;    ///< Infinite or NaN root without ERANGE_SOLVE
+    uint64_t n_roots;         ///< Roots compared with reference ones
+    double   sum_ulp;         ///< Sum of errors of compared roots in ULP of reference root
+    double   max_ulp;
+    double   worst[3];        ///< Coefficients of equation with max_ulp
+};
+
+///@brief Results of all variants on all families
+struct prop_report
+{
+    uint64_t   n_cases;
+    prop_stats stats[N_PROP_VARIANTS][N_PROP_FAMILIES];
+};
+
+///@brief Options of prop_run
+struct prop_opts
+{
+    uint64_t n_cases;
+    uint64_t seed;
+    struct thread_pool *pool; ///< Pool to run cases, NULL to run them in calling thread
+};
+
+/**@brief Solve n_cases random equations with every variant and compare them with reference
+ *
+ * @return Non zero value (errno value) on error
+ */
+int prop_run (const struct prop_opts *opts, struct prop_report *report);
+
+/**@brief Compare roots of one equation with reference and add result to stats
+ *
+ * @param [in] n_roots Number of roots returned by solver
+ */
+void prop_check (double a, double b, double c, enum num_roots n_roots, double x1, double x2, struct prop_stats *stats);
+
+///@brief Print table of variants and families
+void prop_print_report (const struct prop_report *report, FILE *stream);
+
+///@brief Short name of family
+const char *prop_family_name (enum prop_family family);
+
+///@brief Short name of variant
+const char *prop_variant_name (enum prop_variant variant);
+
+#endif //QUAD_PROP_HARNESS_H
@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <cinttypes>
+#include <cassert>
+#include "equation_solver.h"
+#include "thread_pool.h"
+#include "prop_harness.h"
+
+/*
+ * Large-scale run of property-based harness (see prop_harness.h) on all CPUs:
+ *
+ *     quad_prop [-n cases] [-j threads] [-s seed]
+ *
+ * Prints number of misclassified equations, range errors, max and mean ULP error of every solver variant
+ * on every family of equations. Returns non zero value if some solver returned infinite or NaN root.
+ */
+
+///@brief Default number of cases
+static const uint64_t PROP_DEFAULT_CASES = 100000000;
+
+static int parse_number (const char *str, unsigned long long max, unsigned long long *value);
+
+int main (int argc, char **argv)
+{
+    prop_opts opts = {PROP_DEFAULT_CASES, 1, NULL};
+    int n_threads  = 0;
+
+    for (int pos = 1; pos < argc; pos += 2)
+    {
+        unsigned long long value = 0;
+
+        if (pos + 1 >= argc || strlen (argv[pos]) != 2 || argv[pos][0] != '-' ||
+            parse_number (argv[pos + 1], argv[pos][1] == 'j' ? 4096 : ~0ull, &value) != 0)
+        {
+            printf ("Usage: quad_prop [-n cases] [-j threads, 0 for all CPUs] [-s seed]\n");
+            return -1;
+        }
+
+        switch (argv[pos][1])
+        {
+            case 'n': opts.n_cases = value;       break;
+            case 'j': n_threads    = (int) value; break;
+            case 's': opts.seed    = value;       break;
+            default:
+                printf ("Unknown option %s\n", argv[pos]);
+                return -1;
+        }
+    }
+
+    opts.pool = thread_pool_create (n_threads);
+
+    if (opts.pool == NULL)
+    {
+        printf ("Failed to start threads\n");
+        return -1;
+    }
+
+    prop_report *report = (prop_report *) calloc (1, sizeof (prop_report));
+    timespec start = {}, end = {};
+
+    clock_gettime (CLOCK_MONOTONIC, &start);
+    int err = report != NULL ? prop_run (&opts, report) : ENOMEM;
+    clock_gettime (CLOCK_MONOTONIC, &end);
+
+    if (err != 0)
+    {
+        printf ("Failed to run cases: %s\n", strerror (err));
+    }
+    else
+    {
+        double seconds = (double) (end.tv_sec - start.tv_sec) + (double) (end.tv_nsec - start.tv_nsec) / 1e9;
+
+        printf ("%" PRIu64 " cases, seed %" PRIu64 ", %d threads, %.1f s\n\n",
+                opts.n_cases, opts.seed, thread_pool_size (opts.pool), seconds);
+
+        prop_print_report (report, stdout);
+
+        for (int variant = 0; variant < N_PROP_VARIANTS; ++variant)
+        {
+            for (int family = 0; family < N_PROP_FAMILIES; ++family)
+            {
+                if (report->stats[variant][family].n_not_finite != 0) err = ERANGE;
+            }
+        }
+    }
+
+    free (report);
+    thread_pool_destroy (opts.pool);
+
+    return err == 0 ? 0 : -1;
+}
+
+///@brief Parse non negative integer not greater than max
+static int parse_number (const char *str, unsigned long long max, unsigned long long *value)
+{
+    assert (str   != NULL && "pointer can't be null");
+    assert (value != NULL && "pointer can't be null");
+
+    char *end = NULL;
+    errno = 0;
+
+    unsigned long long parsed = strtoull (str, &end, 10);
+
+    if (errno != 0 || end == str || *end != '\0' || str[0] == '-' || parsed > max) return EINVAL;
+
+    *value = parsed;
+    return 0;
+}
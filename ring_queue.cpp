@@ -0,0 +1,186 @@
+#include <cassert>
+#include <new>
+#include <atomic>
+#include <thread>
+#include "thread_pool.h"
+#include "ring_queue.h"
+
+/// Failed attempts before waiting thread goes to sleep
+static const int SPIN_COUNT = 256;
+
+///@brief Element of ring. Position pos is free for push when seq == pos and full for pop when seq == pos + 1
+struct ring_slot
+{
+    std::atomic<size_t> seq {0};
+    void *elem = NULL;
+};
+
+struct ring_queue
+{
+    ring_slot *slots = NULL;
+    size_t     mask  = 0;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> push_pos {0};
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> pop_pos  {0};
+
+    // Futex words: incremented after every push and pop, sleeping threads wait for their change
+    alignas(CACHE_LINE_SIZE) std::atomic<unsigned> n_pushed {0};
+    alignas(CACHE_LINE_SIZE) std::atomic<unsigned> n_popped {0};
+
+    std::atomic<bool> closed {false};
+};
+
+static bool try_push (ring_queue *queue, void *elem);
+
+struct ring_queue *ring_queue_create (size_t capacity)
+{
+    assert (capacity > 0 && "capacity can't be zero");
+
+    size_t size = 1;
+    while (size < capacity) size *= 2;
+
+    ring_queue *queue = new (std::nothrow) ring_queue;
+    if (queue == NULL) return NULL;
+
+    queue->slots = new (std::nothrow) ring_slot[size];
+
+    if (queue->slots == NULL)
+    {
+        delete queue;
+        return NULL;
+    }
+
+    for (size_t i = 0; i < size; ++i) queue->slots[i].seq.store (i, std::memory_order_relaxed);
+
+    queue->mask = size - 1;
+
+    return queue;
+}
+
+void ring_queue_destroy (struct ring_queue *queue)
+{
+    if (queue == NULL) return;
+
+    delete[] queue->slots;
+    delete queue;
+}
+
+void ring_queue_push (struct ring_queue *queue, void *elem)
+{
+    assert (queue != NULL && "pointer can't be null");
+    assert (!queue->closed.load (std::memory_order_relaxed) && "queue is closed");
+
+    for (int spin = 0; ; ++spin)
+    {
+        unsigned n_popped = queue->n_popped.load (std::memory_order_acquire);
+
+        if (try_push (queue, elem)) break;
+
+        if (spin < SPIN_COUNT) std::this_thread::yield ();
+        else                   queue->n_popped.wait (n_popped, std::memory_order_acquire);
+    }
+
+    queue->n_pushed.fetch_add (1, std::memory_order_release);
+    queue->n_pushed.notify_all ();
+}
+
+void *ring_queue_pop (struct ring_queue *queue)
+{
+    assert (queue != NULL && "pointer can't be null");
+
+    for (int spin = 0; ; ++spin)
+    {
+        unsigned n_pushed = queue->n_pushed.load (std::memory_order_acquire);
+        bool     closed   = queue->closed.load   (std::memory_order_acquire);
+
+        void *elem = ring_queue_try_pop (queue);
+        if (elem != NULL) return elem;
+
+        // Everything was pushed before closing, so the queue stays empty
+        if (closed) return NULL;
+
+        if (spin < SPIN_COUNT) std::this_thread::yield ();
+        else                   queue->n_pushed.wait (n_pushed, std::memory_order_acquire);
+    }
+}
+
+void *ring_queue_try_pop (struct ring_queue *queue)
+{
+    assert (queue != NULL && "pointer can't be null");
+
+    size_t pos = queue->pop_pos.load (std::memory_order_relaxed);
+
+    while (true)
+    {
+        ring_slot *slot = &queue->slots[pos & queue->mask];
+        size_t     seq  = slot->seq.load (std::memory_order_acquire);
+
+        if (seq == pos + 1)
+        {
+            if (queue->pop_pos.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed)) break;
+        }
+        else if (seq < pos + 1)
+        {
+            return NULL;
+        }
+        else
+        {
+            pos = queue->pop_pos.load (std::memory_order_relaxed);
+        }
+    }
+
+    ring_slot *slot = &queue->slots[pos & queue->mask];
+    void      *elem = slot->elem;
+
+    // Slot is free for push of the next round
+    slot->seq.store (pos + queue->mask + 1, std::memory_order_release);
+
+    queue->n_popped.fetch_add (1, std::memory_order_release);
+    queue->n_popped.notify_all ();
+
+    return elem;
+}
+
+void ring_queue_close (struct ring_queue *queue)
+{
+    assert (queue != NULL && "pointer can't be null");
+
+    queue->closed.store (true, std::memory_order_release);
+
+    queue->n_pushed.fetch_add (1, std::memory_order_release);
+    queue->n_pushed.notify_all ();
+}
+
+///@brief Put element into free slot, false if queue is full
+static bool try_push (ring_queue *queue, void *elem)
+{
+    assert (queue != NULL && "pointer can't be null");
+
+    size_t pos = queue->push_pos.load (std::memory_order_relaxed);
+
+    while (true)
+    {
+        ring_slot *slot = &queue->slots[pos & queue->mask];
+        size_t     seq  = slot->seq.load (std::memory_order_acquire);
+
+        if (seq == pos)
+        {
+            if (queue->push_pos.compare_exchange_weak (pos, pos + 1, std::memory_order_relaxed)) break;
+        }
+        else if (seq < pos)
+        {
+            return false;
+        }
+        else
+        {
+            pos = queue->push_pos.load (std::memory_order_relaxed);
+        }
+    }
+
+    ring_slot *slot = &queue->slots[pos & queue->mask];
+
+    slot->elem = elem;
+    slot->seq.store (pos + 1, std::memory_order_release);
+
+    return true;
+}
@@ -0,0 +1,38 @@
+#ifndef QUAD_RING_QUEUE_H
+#define QUAD_RING_QUEUE_H
+
+#include <stddef.h>
+
+/**@brief Bounded lock-free queue of pointers for any number of producers and consumers
+ *
+ * Ring of slots with sequence numbers (Vyukov's queue): a producer or consumer claims a position with one
+ * compare-and-swap and waits only on its own slot, so single producer and single consumer never touch
+ * each other's cache lines except for the slot itself. ring_queue_push waits while queue is full
+ * (backpressure), ring_queue_pop waits while it is empty. Waiting threads spin for a while, then sleep
+ * on futex until the other side makes progress.
+ */
+struct ring_queue;
+
+/**@brief Create queue
+ *
+ * @param [in] capacity Max number of elements, rounded up to power of two
+ * @return Queue or NULL on error
+ */
+struct ring_queue *ring_queue_create (size_t capacity);
+
+///@brief Free queue, NULL is ignored. Queue must not be used by other threads
+void ring_queue_destroy (struct ring_queue *queue);
+
+///@brief Add element, wait while queue is full. Elements must not be pushed after ring_queue_close
+void ring_queue_push (struct ring_queue *queue, void *elem);
+
+///@brief Take the oldest element, wait while queue is empty. NULL if queue is closed and empty
+void *ring_queue_pop (struct ring_queue *queue);
+
+///@brief Take the oldest element without waiting, NULL if queue is empty
+void *ring_queue_try_pop (struct ring_queue *queue);
+
+///@brief Wake up consumers waiting on empty queue, ring_queue_pop returns NULL after all elements are taken
+void ring_queue_close (struct ring_queue *queue);
+
+#endif //QUAD_RING_QUEUE_H
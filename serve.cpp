@@ -0,0 +1,759 @@
+#include <cassert>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <unistd.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include "serve.h"
+
+static_assert (sizeof (enum num_roots) == sizeof (int32_t), "num_roots is sent as int32 column");
+
+/// Initial capacity of batch of gathered requests, it grows to fit the biggest request
+static const size_t SERVE_BATCH_SIZE = 1 << 14;
+
+/// Free space of input buffer for one read
+static const size_t READ_SIZE = 1 << 16;
+
+/// Connection is not read while it has more unsent bytes (client does not read responses)
+static const size_t MAX_OUT_PENDING = 1 << 24;
+
+/// Max number of events of one epoll_wait
+static const int MAX_EVENTS = 64;
+
+static const int LISTEN_BACKLOG = 128;
+
+///@brief Growing buffer, bytes [pos, size) are not consumed yet
+struct byte_buffer
+{
+    char  *data;
+    size_t pos;
+    size_t size;
+    size_t capacity;
+};
+
+///@brief Client connection
+struct connection
+{
+    int fd;
+
+    byte_buffer in;  ///< Received bytes, pos is the begin of next request
+    byte_buffer out; ///< Responses, pos is the begin of not sent bytes
+
+    uint32_t events; ///< Registered epoll events
+    bool     eof;    ///< Client closed its side, connection is closed after sending responses
+    bool     failed; ///< Protocol or socket error, connection is closed
+};
+
+///@brief Request gathered into batch
+struct pending_request
+{
+    connection *conn;
+    uint32_t    count;
+};
+
+struct quad_server
+{
+    batch_opts opts;
+    char      *path;
+
+    int listen_fd;
+    int event_fd;  ///< Written by server_stop
+    int epoll_fd;
+
+    connection **conns;     ///< Connections indexed by socket
+    size_t       conns_cap;
+
+    eq_batch         batch;   ///< Equations of gathered requests
+    pending_request *pending; ///< Gathered requests in order of arrival
+    size_t           n_pending;
+    size_t           pending_cap;
+};
+
+static int  remove_stale_socket (const char *path);
+static int  accept_conns   (quad_server *server);
+static void read_conn      (quad_server *server, connection *conn);
+static void parse_requests (quad_server *server, connection *conn);
+static int  gather_request (quad_server *server, connection *conn, const char *data, uint32_t count);
+static void solve_pending  (quad_server *server);
+static int  append_response (connection *conn, uint32_t count, const double x1[], const double x2[],
+                             const enum num_roots n_roots[]);
+static void write_conn     (connection *conn);
+static void finish_conn    (quad_server *server, connection *conn);
+static void close_conn     (quad_server *server, connection *conn);
+static int  reserve        (byte_buffer *buffer, size_t size);
+static int  send_all       (int fd, struct iovec *iov, int n_iov);
+static int  recv_all       (int fd, void *data, size_t size);
+
+struct quad_server *server_create (const char *socket_path, const struct batch_opts *opts)
+{
+    assert (socket_path != NULL && "pointer can't be null");
+    assert (opts        != NULL && "pointer can't be null");
+
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+
+    if (strlen (socket_path) >= sizeof (addr.sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return NULL;
+    }
+
+    strcpy (addr.sun_path, socket_path);
+
+    quad_server *server = new (std::nothrow) quad_server {};
+    if (server == NULL)
+    {
+        errno = ENOMEM;
+        return NULL;
+    }
+
+    server->opts      = *opts;
+    server->listen_fd = server->event_fd = server->epoll_fd = -1;
+
+    int err = eq_batch_ctor (&server->batch, SERVE_BATCH_SIZE);
+
+    if (err == 0)
+    {
+        server->listen_fd = socket (AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        server->event_fd  = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC);
+        server->epoll_fd  = epoll_create1 (EPOLL_CLOEXEC);
+
+        if (server->listen_fd < 0 || server->event_fd < 0 || server->epoll_fd < 0) err = errno;
+    }
+
+    if (err == 0) err = remove_stale_socket (socket_path);
+
+    if (err == 0 && bind (server->listen_fd, (const sockaddr *) &addr, sizeof (addr)) != 0) err = errno;
+
+    // The path is ours from now, server_destroy removes it
+    if (err == 0)
+    {
+        server->path = strdup (socket_path);
+        if (server->path == NULL) err = ENOMEM;
+    }
+
+    if (err == 0 && listen (server->listen_fd, LISTEN_BACKLOG) != 0) err = errno;
+
+    epoll_event listen_event = {EPOLLIN, {.fd = server->listen_fd}};
+    epoll_event stop_event   = {EPOLLIN, {.fd = server->event_fd}};
+
+    if (err == 0 && (epoll_ctl (server->epoll_fd, EPOLL_CTL_ADD, server->listen_fd, &listen_event) != 0 ||
+                     epoll_ctl (server->epoll_fd, EPOLL_CTL_ADD, server->event_fd,  &stop_event)   != 0))
+    {
+        err = errno;
+    }
+
+    if (err != 0)
+    {
+        server_destroy (server);
+        errno = err;
+        return NULL;
+    }
+
+    return server;
+}
+
+void server_destroy (struct quad_server *server)
+{
+    if (server == NULL) return;
+
+    for (size_t fd = 0; fd < server->conns_cap; ++fd)
+    {
+        if (server->conns[fd] != NULL) close_conn (server, server->conns[fd]);
+    }
+
+    if (server->listen_fd >= 0) close (server->listen_fd);
+    if (server->event_fd  >= 0) close (server->event_fd);
+    if (server->epoll_fd  >= 0) close (server->epoll_fd);
+
+    if (server->path != NULL) unlink (server->path);
+
+    eq_batch_dtor (&server->batch);
+
+    free (server->path);
+    free (server->conns);
+    free (server->pending);
+
+    delete server;
+}
+
+void server_stop (struct quad_server *server)
+{
+    assert (server != NULL && "pointer can't be null");
+
+    // write is async-signal-safe, the result can't be handled in signal handler anyway
+    uint64_t one = 1;
+    ssize_t  res = write (server->event_fd, &one, sizeof (one));
+    (void) res;
+}
+
+int server_run (struct quad_server *server)
+{
+    assert (server != NULL && "pointer can't be null");
+
+    epoll_event events[MAX_EVENTS] = {};
+
+    while (true)
+    {
+        int n_events = epoll_wait (server->epoll_fd, events, MAX_EVENTS, -1);
+
+        if (n_events < 0)
+        {
+            if (errno == EINTR) continue;
+            return errno;
+        }
+
+        bool stop = false;
+
+        // Requests of all ready connections are gathered into one batch
+        for (int i = 0; i < n_events; ++i)
+        {
+            int fd = events[i].data.fd;
+
+            if (fd == server->event_fd)
+            {
+                stop = true;
+            }
+            else if (fd == server->listen_fd)
+            {
+                int err = accept_conns (server);
+                if (err != 0) return err;
+            }
+            else if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+            {
+                read_conn (server, server->conns[fd]);
+            }
+        }
+
+        solve_pending (server);
+
+        // Responses are sent, finished connections are closed only after all pending requests are answered
+        for (int i = 0; i < n_events; ++i)
+        {
+            int fd = events[i].data.fd;
+
+            if (fd == server->event_fd || fd == server->listen_fd) continue;
+
+            finish_conn (server, server->conns[fd]);
+        }
+
+        if (stop) return 0;
+    }
+}
+
+///@brief Unlink socket file, if nobody listens on it
+static int remove_stale_socket (const char *path)
+{
+    assert (path != NULL && "pointer can't be null");
+
+    struct stat path_stat = {};
+
+    if (lstat (path, &path_stat) != 0) return errno == ENOENT ? 0 : errno;
+
+    // Bind reports EADDRINUSE for other files
+    if (!S_ISSOCK (path_stat.st_mode)) return 0;
+
+    int fd = serve_connect (path);
+
+    if (fd >= 0)
+    {
+        close (fd);
+        return EADDRINUSE;
+    }
+
+    if (errno != ECONNREFUSED) return errno;
+
+    return unlink (path) == 0 ? 0 : errno;
+}
+
+///@brief Accept all waiting connections
+static int accept_conns (quad_server *server)
+{
+    assert (server != NULL && "pointer can't be null");
+
+    while (true)
+    {
+        int fd = accept4 (server->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if (fd < 0)
+        {
+            // Out of descriptors or memory: the rest waits in backlog until some connection is closed
+            if (errno == EAGAIN || errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) return 0;
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+
+            return errno;
+        }
+
+        if ((size_t) fd >= server->conns_cap)
+        {
+            size_t new_cap = (size_t) fd * 2 + 1;
+            connection **conns = (connection **) realloc (server->conns, new_cap * sizeof (connection *));
+
+            if (conns == NULL)
+            {
+                close (fd);
+                return 0;
+            }
+
+            memset (conns + server->conns_cap, 0, (new_cap - server->conns_cap) * sizeof (connection *));
+
+            server->conns     = conns;
+            server->conns_cap = new_cap;
+        }
+
+        connection *conn = (connection *) calloc (1, sizeof (connection));
+
+        epoll_event event = {EPOLLIN, {.fd = fd}};
+
+        if (conn == NULL || epoll_ctl (server->epoll_fd, EPOLL_CTL_ADD, fd, &event) != 0)
+        {
+            free (conn);
+            close (fd);
+            continue;
+        }
+
+        conn->fd     = fd;
+        conn->events = EPOLLIN;
+
+        server->conns[fd] = conn;
+    }
+}
+
+///@brief Read available bytes of connection once (epoll is level triggered) and gather its complete requests
+static void read_conn (quad_server *server, connection *conn)
+{
+    assert (server != NULL && "pointer can't be null");
+    assert (conn   != NULL && "pointer can't be null");
+
+    if (conn->failed || conn->eof) return;
+
+    // Client does not read responses, requests stay in socket buffer until it does
+    if (conn->out.size - conn->out.pos > MAX_OUT_PENDING) return;
+
+    byte_buffer *in = &conn->in;
+
+    if (reserve (in, READ_SIZE) != 0)
+    {
+        conn->failed = true;
+        return;
+    }
+
+    ssize_t n_read = recv (conn->fd, in->data + in->size, in->capacity - in->size, 0);
+
+    if (n_read > 0)
+    {
+        in->size += (size_t) n_read;
+    }
+    else if (n_read == 0)
+    {
+        conn->eof = true;
+    }
+    else if (errno != EAGAIN && errno != EINTR)
+    {
+        conn->failed = true;
+    }
+
+    parse_requests (server, conn);
+}
+
+///@brief Gather all complete requests from input buffer, incomplete one is moved to its begin
+static void parse_requests (quad_server *server, connection *conn)
+{
+    assert (server != NULL && "pointer can't be null");
+    assert (conn   != NULL && "pointer can't be null");
+
+    byte_buffer *in = &conn->in;
+
+    while (!conn->failed && in->size - in->pos >= sizeof (serve_header))
+    {
+        serve_header header = {};
+        memcpy (&header, in->data + in->pos, sizeof (header));
+
+        if (header.count > SERVE_MAX_COUNT || header.reserved != 0)
+        {
+            conn->failed = true;
+            break;
+        }
+
+        size_t request_size = sizeof (header) + 3 * sizeof (double) * header.count;
+
+        if (in->size - in->pos < request_size)
+        {
+            // Whole request must fit into buffer
+            if (reserve (in, request_size) != 0) conn->failed = true;
+            break;
+        }
+
+        if (gather_request (server, conn, in->data + in->pos + sizeof (header), header.count) != 0)
+        {
+            conn->failed = true;
+            break;
+        }
+
+        in->pos += request_size;
+    }
+}
+
+///@brief Copy coefficients of request into batch, batch is solved first if request doesn't fit into it
+static int gather_request (quad_server *server, connection *conn, const char *data, uint32_t count)
+{
+    assert (server != NULL && "pointer can't be null");
+    assert (conn   != NULL && "pointer can't be null");
+    assert (data   != NULL && "pointer can't be null");
+
+    eq_batch *batch = &server->batch;
+
+    // Allocation of bigger batch has failed before
+    if (batch->a == NULL && eq_batch_ctor (batch, SERVE_BATCH_SIZE) != 0) return ENOMEM;
+
+    if (batch->size + count > batch->capacity) solve_pending (server);
+
+    // Bigger batch is kept for next requests. If it can't be allocated, this connection is closed
+    if (count > batch->capacity)
+    {
+        eq_batch_dtor (batch);
+
+        if (eq_batch_ctor (batch, count) != 0 && eq_batch_ctor (batch, SERVE_BATCH_SIZE) != 0) return ENOMEM;
+        if (count > batch->capacity) return ENOMEM;
+    }
+
+    if (server->n_pending == server->pending_cap)
+    {
+        size_t new_cap = server->pending_cap * 2 + 16;
+        pending_request *pending = (pending_request *) realloc (server->pending, new_cap * sizeof (pending_request));
+
+        if (pending == NULL) return ENOMEM;
+
+        server->pending     = pending;
+        server->pending_cap = new_cap;
+    }
+
+    size_t column_size = count * sizeof (double);
+
+    memcpy (batch->a + batch->size, data,                   column_size);
+    memcpy (batch->b + batch->size, data + column_size,     column_size);
+    memcpy (batch->c + batch->size, data + 2 * column_size, column_size);
+
+    batch->size += count;
+    server->pending[server->n_pending++] = {conn, count};
+
+    return 0;
+}
+
+///@brief Solve gathered requests as one batch and append responses to connections
+static void solve_pending (quad_server *server)
+{
+    assert (server != NULL && "pointer can't be null");
+
+    if (server->n_pending == 0) return;
+
+    eq_batch *batch = &server->batch;
+
+    eq_batch_solve_quad (batch->size, batch->a, batch->b, batch->c, batch->x1, batch->x2, batch->n_roots,
+                         &server->opts);
+
+    size_t begin = 0;
+
+    for (size_t i = 0; i < server->n_pending; ++i)
+    {
+        pending_request *request = &server->pending[i];
+        connection      *conn    = request->conn;
+
+        if (!conn->failed && append_response (conn, request->count, batch->x1 + begin, batch->x2 + begin,
+                                              batch->n_roots + begin) != 0)
+        {
+            conn->failed = true;
+        }
+
+        begin += request->count;
+    }
+
+    batch->size       = 0;
+    server->n_pending = 0;
+}
+
+static int append_response (connection *conn, uint32_t count, const double x1[], const double x2[],
+                            const enum num_roots n_roots[])
+{
+    assert (conn    != NULL && "pointer can't be null");
+    assert (x1      != NULL && "pointer can't be null");
+    assert (x2      != NULL && "pointer can't be null");
+    assert (n_roots != NULL && "pointer can't be null");
+
+    size_t roots_size    = count * sizeof (int32_t);
+    size_t padded_size   = (roots_size + 7) / 8 * 8;
+    size_t column_size   = count * sizeof (double);
+    size_t response_size = sizeof (serve_header) + padded_size + 2 * column_size;
+
+    byte_buffer *out = &conn->out;
+
+    if (reserve (out, response_size) != 0) return ENOMEM;
+
+    char *pos = out->data + out->size;
+
+    serve_header header = {count, 0};
+
+    memcpy (pos, &header, sizeof (header));
+    pos += sizeof (header);
+
+    memcpy (pos, n_roots, roots_size);
+    memset (pos + roots_size, 0, padded_size - roots_size);
+    pos += padded_size;
+
+    memcpy (pos, x1, column_size);
+    memcpy (pos + column_size, x2, column_size);
+
+    out->size += response_size;
+
+    return 0;
+}
+
+///@brief Send as many response bytes as socket takes
+static void write_conn (connection *conn)
+{
+    assert (conn != NULL && "pointer can't be null");
+
+    byte_buffer *out = &conn->out;
+
+    while (!conn->failed && out->pos < out->size)
+    {
+        ssize_t n_sent = send (conn->fd, out->data + out->pos, out->size - out->pos, MSG_NOSIGNAL);
+
+        if (n_sent >= 0)
+        {
+            out->pos += (size_t) n_sent;
+        }
+        else if (errno == EAGAIN)
+        {
+            return;
+        }
+        else if (errno != EINTR)
+        {
+            conn->failed = true;
+        }
+    }
+
+    if (out->pos == out->size) out->pos = out->size = 0;
+}
+
+///@brief Send responses, close finished connection or update its epoll events
+static void finish_conn (quad_server *server, connection *conn)
+{
+    assert (server != NULL && "pointer can't be null");
+
+    // Already closed, if socket was reported twice
+    if (conn == NULL) return;
+
+    write_conn (conn);
+
+    size_t out_pending = conn->out.size - conn->out.pos;
+
+    if (conn->failed || (conn->eof && out_pending == 0))
+    {
+        close_conn (server, conn);
+        return;
+    }
+
+    // Socket at end of file is always readable
+    uint32_t events = 0;
+
+    if (!conn->eof && out_pending <= MAX_OUT_PENDING) events |= EPOLLIN;
+    if (out_pending > 0)                              events |= EPOLLOUT;
+
+    if (events == conn->events) return;
+
+    epoll_event event = {events, {.fd = conn->fd}};
+
+    if (epoll_ctl (server->epoll_fd, EPOLL_CTL_MOD, conn->fd, &event) != 0)
+    {
+        close_conn (server, conn);
+        return;
+    }
+
+    conn->events = events;
+}
+
+static void close_conn (quad_server *server, connection *conn)
+{
+    assert (server != NULL && "pointer can't be null");
+    assert (conn   != NULL && "pointer can't be null");
+
+    // Closed socket is removed from epoll set
+    close (conn->fd);
+    server->conns[conn->fd] = NULL;
+
+    free (conn->in.data);
+    free (conn->out.data);
+    free (conn);
+}
+
+///@brief Make room for size more bytes after buffer->size, consumed bytes are dropped
+static int reserve (byte_buffer *buffer, size_t size)
+{
+    assert (buffer != NULL && "pointer can't be null");
+
+    if (buffer->pos > 0)
+    {
+        memmove (buffer->data, buffer->data + buffer->pos, buffer->size - buffer->pos);
+
+        buffer->size -= buffer->pos;
+        buffer->pos   = 0;
+    }
+
+    if (buffer->capacity - buffer->size >= size) return 0;
+
+    size_t new_cap = buffer->capacity * 2;
+    if (new_cap < buffer->size + size) new_cap = buffer->size + size;
+
+    char *data = (char *) realloc (buffer->data, new_cap);
+    if (data == NULL) return ENOMEM;
+
+    buffer->data     = data;
+    buffer->capacity = new_cap;
+
+    return 0;
+}
+
+int serve_connect (const char *socket_path)
+{
+    assert (socket_path != NULL && "pointer can't be null");
+
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+
+    if (strlen (socket_path) >= sizeof (addr.sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+
+    strcpy (addr.sun_path, socket_path);
+
+    int fd = socket (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+
+    if (connect (fd, (const sockaddr *) &addr, sizeof (addr)) != 0)
+    {
+        int err = errno;
+        close (fd);
+        errno = err;
+        return -1;
+    }
+
+    return fd;
+}
+
+int serve_send (int fd, size_t n, const double a[], const double b[], const double c[])
+{
+    assert (a != NULL && "pointer can't be null");
+    assert (b != NULL && "pointer can't be null");
+    assert (c != NULL && "pointer can't be null");
+
+    if (n > SERVE_MAX_COUNT) return EINVAL;
+
+    serve_header header = {(uint32_t) n, 0};
+
+    // Columns are sent right from arrays
+    struct iovec iov[] =
+    {
+        {&header,      sizeof (header)},
+        {(void *) (uintptr_t) a, n * sizeof (double)},
+        {(void *) (uintptr_t) b, n * sizeof (double)},
+        {(void *) (uintptr_t) c, n * sizeof (double)},
+    };
+
+    return send_all (fd, iov, sizeof (iov) / sizeof (iov[0]));
+}
+
+int serve_recv (int fd, size_t n, double x1[], double x2[], enum num_roots n_roots[])
+{
+    assert (x1      != NULL && "pointer can't be null");
+    assert (x2      != NULL && "pointer can't be null");
+    assert (n_roots != NULL && "pointer can't be null");
+
+    serve_header header = {};
+
+    int err = recv_all (fd, &header, sizeof (header));
+    if (err != 0) return err;
+
+    if (header.count != n || header.reserved != 0) return EPROTO;
+
+    size_t roots_size = n * sizeof (int32_t);
+    char   padding[8] = {};
+
+    err = recv_all (fd, n_roots, roots_size);
+    if (err == 0) err = recv_all (fd, padding, (roots_size + 7) / 8 * 8 - roots_size);
+    if (err == 0) err = recv_all (fd, x1, n * sizeof (double));
+    if (err == 0) err = recv_all (fd, x2, n * sizeof (double));
+
+    return err;
+}
+
+///@brief Send all iov parts, iov is modified
+static int send_all (int fd, struct iovec *iov, int n_iov)
+{
+    assert (iov != NULL && "pointer can't be null");
+
+    while (n_iov > 0)
+    {
+        msghdr msg = {};
+        msg.msg_iov    = iov;
+        msg.msg_iovlen = (size_t) n_iov;
+
+        ssize_t n_sent = sendmsg (fd, &msg, MSG_NOSIGNAL);
+
+        if (n_sent < 0)
+        {
+            if (errno == EINTR) continue;
+            return errno;
+        }
+
+        size_t sent = (size_t) n_sent;
+
+        // Skip sent parts, the first not sent one is sent from its middle
+        while (n_iov > 0 && sent >= iov->iov_len)
+        {
+            sent -= iov->iov_len;
+            iov++;
+            n_iov--;
+        }
+
+        if (n_iov > 0)
+        {
+            iov->iov_base = (char *) iov->iov_base + sent;
+            iov->iov_len -= sent;
+        }
+    }
+
+    return 0;
+}
+
+static int recv_all (int fd, void *data, size_t size)
+{
+    assert (data != NULL && "pointer can't be null");
+
+    char *pos = (char *) data;
+
+    while (size > 0)
+    {
+        ssize_t n_read = recv (fd, pos, size, 0);
+
+        if (n_read == 0) return ECONNRESET;
+
+        if (n_read < 0)
+        {
+            if (errno == EINTR) continue;
+            return errno;
+        }
+
+        pos  += n_read;
+        size -= (size_t) n_read;
+    }
+
+    return 0;
+}
@@ -0,0 +1,79 @@
+#ifndef QUAD_SERVE_H
+#define QUAD_SERVE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "equation_solver.h"
+#include "batch_io.h"
+
+/*
+ * Protocol of solver daemon (quad --serve) over Unix domain stream socket. Values are in byte order
+ * of the host, the socket is local:
+ *
+ *     request:   serve_header, a[count], b[count], c[count]                      doubles
+ *     response:  serve_header, n_roots[count], x1[count], x2[count]              int32 (num_roots value), doubles
+ *
+ * Columns are the same as in binary files (see bin_io.h): n_roots column is padded with zeros to a multiple
+ * of 8 bytes. Requests of one connection are answered in order, a client may send several requests before
+ * reading responses, but it must keep reading them while it sends: server stops reading a connection, which
+ * has more than 16 MiB of unsent responses, so a client blocked in send without a reader never gets unblocked.
+ * Request with count above SERVE_MAX_COUNT or nonzero reserved field closes the connection.
+ */
+
+///@brief Header of request and response
+struct serve_header
+{
+    uint32_t count;    ///< Number of equations
+    uint32_t reserved; ///< Zero
+};
+
+static_assert (sizeof (serve_header) == 8, "serve header layout must not depend on compiler");
+
+///@brief Max number of equations in one request
+const uint32_t SERVE_MAX_COUNT = 1 << 20;
+
+/**@brief Solver daemon: epoll event loop, which reads requests of all ready connections,
+ *        solves them together as one batch and writes responses
+ */
+struct quad_server;
+
+/**@brief Create socket and start listening, stale socket file of stopped server is replaced
+ *
+ * @param [in] socket_path Path of Unix domain socket
+ * @param [in] opts        Options of solving: pool, solver, cache, complex roots, polish. Pool and cache
+ *                         must live until server is destroyed
+ * @return Server or NULL on error (errno is set)
+ */
+struct quad_server *server_create (const char *socket_path, const struct batch_opts *opts);
+
+/**@brief Serve connections until server_stop is called
+ *
+ * @return Non zero value (errno value) on error
+ */
+int server_run (struct quad_server *server);
+
+///@brief Make server_run return, can be called from another thread or from signal handler
+void server_stop (struct quad_server *server);
+
+///@brief Close all connections and remove socket file, NULL is ignored
+void server_destroy (struct quad_server *server);
+
+/**@brief Connect to solver daemon
+ *
+ * @return Socket or -1 on error (errno is set)
+ */
+int serve_connect (const char *socket_path);
+
+/**@brief Send request with n equations
+ *
+ * @return Non zero value (errno value) on error, EINVAL if n is above SERVE_MAX_COUNT
+ */
+int serve_send (int fd, size_t n, const double a[], const double b[], const double c[]);
+
+/**@brief Receive response to request with n equations
+ *
+ * @return Non zero value (errno value) on error, EPROTO if response has another count
+ */
+int serve_recv (int fd, size_t n, double x1[], double x2[], enum num_roots n_roots[]);
+
+#endif //QUAD_SERVE_H
@@ -0,0 +1,270 @@
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include "solution_cache.h"
+#include "thread_pool.h"
+
+/// Number of slots, where a key may be stored (power of two)
+static const size_t PROBE_WINDOW = 4;
+
+/// Max number of equations solved by one call of solve function, misses of bigger batches are solved in parts
+static const size_t MISS_BATCH_SIZE = 1024;
+
+///@brief Cached solution, n_roots of empty slot is CACHE_EMPTY
+struct cache_entry
+{
+    uint64_t a;
+    uint64_t b;
+    uint64_t c;
+    double   x1;
+    double   x2;
+    int      n_roots;
+};
+
+/// n_roots of empty slot, it is not a num_roots value
+static const int CACHE_EMPTY = -100;
+
+///@brief Equations missed in cache, they are solved together
+struct miss_batch
+{
+    size_t size = 0;
+
+    double a[MISS_BATCH_SIZE]  = {};
+    double b[MISS_BATCH_SIZE]  = {};
+    double c[MISS_BATCH_SIZE]  = {};
+    double x1[MISS_BATCH_SIZE] = {};
+    double x2[MISS_BATCH_SIZE] = {};
+    enum num_roots n_roots[MISS_BATCH_SIZE] = {};
+    size_t index[MISS_BATCH_SIZE] = {}; ///< Position of equation in solved batch
+};
+
+///@brief Part of cache used by one thread
+struct alignas(CACHE_LINE_SIZE) cache_shard
+{
+    cache_entry *entries = NULL;
+    size_t       mask    = 0;  ///< Number of entries - 1
+    size_t       victim  = 0;  ///< Round robin counter of evicted slot in window
+
+    miss_batch *misses = NULL;
+
+    cache_stats stats = {};
+};
+
+struct solution_cache
+{
+    int          n_shards = 0;
+    cache_shard *shards   = NULL;
+};
+
+static inline uint64_t double_bits (double x);
+static inline uint64_t hash_key    (uint64_t a, uint64_t b, uint64_t c);
+static void solve_misses (cache_shard *shard, double x1[], double x2[], enum num_roots n_roots[],
+                          cache_solve_func_t solve, const void *arg);
+
+struct solution_cache *solution_cache_create (size_t capacity, int n_shards)
+{
+    assert (n_shards > 0 && "number of shards must be positive");
+
+    solution_cache *cache = new (std::nothrow) solution_cache;
+    if (cache == NULL) return NULL;
+
+    cache->n_shards = n_shards;
+    cache->shards   = new (std::nothrow) cache_shard[n_shards];
+
+    if (cache->shards == NULL)
+    {
+        solution_cache_destroy (cache);
+        return NULL;
+    }
+
+    size_t shard_capacity = PROBE_WINDOW;
+    while (shard_capacity * (size_t) n_shards < capacity) shard_capacity *= 2;
+
+    for (int i = 0; i < n_shards; ++i)
+    {
+        cache_shard *shard = &cache->shards[i];
+
+        shard->entries = new (std::nothrow) cache_entry[shard_capacity];
+        shard->misses  = new (std::nothrow) miss_batch;
+        shard->mask    = shard_capacity - 1;
+
+        if (shard->entries == NULL || shard->misses == NULL)
+        {
+            solution_cache_destroy (cache);
+            return NULL;
+        }
+
+        for (size_t j = 0; j < shard_capacity; ++j) shard->entries[j].n_roots = CACHE_EMPTY;
+    }
+
+    return cache;
+}
+
+void solution_cache_destroy (struct solution_cache *cache)
+{
+    if (cache == NULL) return;
+
+    for (int i = 0; cache->shards != NULL && i < cache->n_shards; ++i)
+    {
+        delete[] cache->shards[i].entries;
+        delete   cache->shards[i].misses;
+    }
+
+    delete[] cache->shards;
+    delete   cache;
+}
+
+void solution_cache_solve (struct solution_cache *cache, int shard_id, size_t n,
+                           const double a[], const double b[], const double c[],
+                           double x1[], double x2[], enum num_roots n_roots[],
+                           cache_solve_func_t solve, const void *arg)
+{
+    assert (cache   != NULL && "pointer can't be null");
+    assert (a       != NULL && "pointer can't be null");
+    assert (b       != NULL && "pointer can't be null");
+    assert (c       != NULL && "pointer can't be null");
+    assert (x1      != NULL && "pointer can't be null");
+    assert (x2      != NULL && "pointer can't be null");
+    assert (n_roots != NULL && "pointer can't be null");
+    assert (solve   != NULL && "pointer can't be null");
+    assert (0 <= shard_id && shard_id < cache->n_shards && "shard index out of range");
+
+    cache_shard *shard  = &cache->shards[shard_id];
+    miss_batch  *misses = shard->misses;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint64_t a_bits = double_bits (a[i]);
+        uint64_t b_bits = double_bits (b[i]);
+        uint64_t c_bits = double_bits (c[i]);
+
+        size_t pos = hash_key (a_bits, b_bits, c_bits) & shard->mask & ~(PROBE_WINDOW - 1);
+        const cache_entry *found = NULL;
+
+        for (size_t j = pos; j < pos + PROBE_WINDOW; ++j)
+        {
+            const cache_entry *entry = &shard->entries[j];
+
+            if (entry->n_roots != CACHE_EMPTY && entry->a == a_bits && entry->b == b_bits && entry->c == c_bits)
+            {
+                found = entry;
+                break;
+            }
+        }
+
+        if (found != NULL)
+        {
+            x1[i]      = found->x1;
+            x2[i]      = found->x2;
+            n_roots[i] = (enum num_roots) found->n_roots;
+
+            shard->stats.hits++;
+            continue;
+        }
+
+        shard->stats.misses++;
+
+        misses->a[misses->size]     = a[i];
+        misses->b[misses->size]     = b[i];
+        misses->c[misses->size]     = c[i];
+        misses->index[misses->size] = i;
+        misses->size++;
+
+        if (misses->size == MISS_BATCH_SIZE) solve_misses (shard, x1, x2, n_roots, solve, arg);
+    }
+
+    solve_misses (shard, x1, x2, n_roots, solve, arg);
+}
+
+void solution_cache_stats (const struct solution_cache *cache, struct cache_stats *stats)
+{
+    assert (cache != NULL && "pointer can't be null");
+    assert (stats != NULL && "pointer can't be null");
+
+    *stats = {};
+
+    for (int i = 0; i < cache->n_shards; ++i)
+    {
+        stats->hits      += cache->shards[i].stats.hits;
+        stats->misses    += cache->shards[i].stats.misses;
+        stats->evictions += cache->shards[i].stats.evictions;
+    }
+}
+
+/**
+ * @brief Solve collected misses, write solutions to their places in output arrays and add them to cache
+ *
+ * Equal equations in one miss batch are solved twice, the second one replaces the first one in cache.
+ */
+static void solve_misses (cache_shard *shard, double x1[], double x2[], enum num_roots n_roots[],
+                          cache_solve_func_t solve, const void *arg)
+{
+    assert (shard   != NULL && "pointer can't be null");
+    assert (x1      != NULL && "pointer can't be null");
+    assert (x2      != NULL && "pointer can't be null");
+    assert (n_roots != NULL && "pointer can't be null");
+
+    miss_batch *misses = shard->misses;
+
+    if (misses->size == 0) return;
+
+    solve (misses->size, misses->a, misses->b, misses->c, misses->x1, misses->x2, misses->n_roots, arg);
+
+    for (size_t i = 0; i < misses->size; ++i)
+    {
+        size_t index = misses->index[i];
+
+        x1[index]      = misses->x1[i];
+        x2[index]      = misses->x2[i];
+        n_roots[index] = misses->n_roots[i];
+
+        uint64_t a_bits = double_bits (misses->a[i]);
+        uint64_t b_bits = double_bits (misses->b[i]);
+        uint64_t c_bits = double_bits (misses->c[i]);
+
+        size_t pos = hash_key (a_bits, b_bits, c_bits) & shard->mask & ~(PROBE_WINDOW - 1);
+
+        // Empty or the same key, else the next victim of the window
+        size_t slot = pos + (shard->victim++ & (PROBE_WINDOW - 1));
+        bool   evict = true;
+
+        for (size_t j = pos; j < pos + PROBE_WINDOW; ++j)
+        {
+            const cache_entry *entry = &shard->entries[j];
+
+            if (entry->n_roots == CACHE_EMPTY || (entry->a == a_bits && entry->b == b_bits && entry->c == c_bits))
+            {
+                slot  = j;
+                evict = false;
+                break;
+            }
+        }
+
+        shard->stats.evictions += evict;
+
+        shard->entries[slot] = {a_bits, b_bits, c_bits, misses->x1[i], misses->x2[i], misses->n_roots[i]};
+    }
+
+    misses->size = 0;
+}
+
+static inline uint64_t double_bits (double x)
+{
+    uint64_t bits = 0;
+    memcpy (&bits, &x, sizeof (bits));
+
+    return bits;
+}
+
+///@brief Multiplicative hash of three keys with final mixing of high bits into low ones (MurmurHash3 finalizer)
+static inline uint64_t hash_key (uint64_t a, uint64_t b, uint64_t c)
+{
+    uint64_t hash = a * 0x9E3779B97F4A7C15ull ^ b * 0xC2B2AE3D27D4EB4Full ^ c * 0x165667B19E3779F9ull;
+
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDull;
+    hash ^= hash >> 33;
+
+    return hash;
+}
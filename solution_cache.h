@@ -0,0 +1,55 @@
+#ifndef QUAD_SOLUTION_CACHE_H
+#define QUAD_SOLUTION_CACHE_H
+
+#include <stddef.h>
+#include "equation_solver.h"
+
+/**@brief Bounded cache of solutions of quadratic equations
+ *
+ * Open addressing hash table keyed on bit patterns of coefficients, so equal coefficients with different
+ * bits (0 and -0) are different keys. Every key is looked up in a window of a few slots after its hash,
+ * when the window is full, one of its slots is evicted round robin.
+ *
+ * The cache is split into shards, one per worker thread: a shard is used only by its thread, so there are
+ * no locks and no shared cache lines.
+ */
+struct solution_cache;
+
+///@brief Counters of cache lookups
+struct cache_stats
+{
+    size_t hits;
+    size_t misses;
+    size_t evictions; ///< Entries replaced by new ones
+};
+
+///@brief Batch solver called for equations not found in cache, arg is given to solution_cache_solve
+typedef void (*cache_solve_func_t) (size_t n, const double a[], const double b[], const double c[],
+                                    double x1[], double x2[], enum num_roots n_roots[], const void *arg);
+
+/**@brief Create cache
+ *
+ * @param [in] capacity Number of cached solutions, it is split between shards and rounded up to power of two
+ * @param [in] n_shards Number of shards, thread_pool_size for cache used by pool workers
+ * @return Cache or NULL on error
+ */
+struct solution_cache *solution_cache_create (size_t capacity, int n_shards);
+
+///@brief Free cache, NULL is ignored
+void solution_cache_destroy (struct solution_cache *cache);
+
+/**@brief Solve equations with solutions from cache, others are solved by solve and added to cache
+ *
+ * Results are the same as of solve (n, a, b, c, x1, x2, n_roots, arg), if solve is deterministic.
+ *
+ * @param [in] shard Shard used by calling thread, thread_id of pool worker
+ */
+void solution_cache_solve (struct solution_cache *cache, int shard, size_t n,
+                           const double a[], const double b[], const double c[],
+                           double x1[], double x2[], enum num_roots n_roots[],
+                           cache_solve_func_t solve, const void *arg);
+
+///@brief Sum of counters of all shards, must not be called while cache is used
+void solution_cache_stats (const struct solution_cache *cache, struct cache_stats *stats);
+
+#endif //QUAD_SOLUTION_CACHE_H
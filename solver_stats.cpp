@@ -0,0 +1,163 @@
+#include <cassert>
+#include <mutex>
+#include <new>
+#include "solver_stats.h"
+
+static const char *const STAT_NAMES[N_SOLVER_STATS] =
+{
+    "quadratic equations",
+    "linear (a = 0)",
+    "linear degenerate (k = 0)",
+    "scaled coefficients",
+    "zero discriminant",
+    "negative discriminant",
+    "b = 0 shortcut",
+    "c = 0 shortcut",
+    "general formula",
+    "range error: linear root",
+    "range error: double root",
+    "range error: two roots",
+    "range check rejections",
+};
+
+#ifdef QUAD_STATS
+
+/// Block shared by threads, which failed to allocate their own one. Its counters may lose increments
+static solver_stats_block shared_block = {{}, true, NULL};
+
+///@brief List of all blocks, blocks are added to its head and never removed
+static std::mutex          registry_lock;
+static solver_stats_block *registry = &shared_block;
+
+constinit thread_local solver_stats_block *solver_stats_tls = NULL;
+
+///@brief Releases block of thread on its exit
+struct stats_owner
+{
+    solver_stats_block *block = NULL;
+
+    stats_owner ()                               = default;
+    stats_owner (const stats_owner &)            = delete;
+    stats_owner &operator= (const stats_owner &) = delete;
+
+    ~stats_owner ()
+    {
+        std::lock_guard<std::mutex> guard (registry_lock);
+
+        if (block != NULL) block->owned = false;
+
+        solver_stats_tls = NULL;
+    }
+};
+
+solver_stats_block *solver_stats_register (void)
+{
+    static thread_local stats_owner owner;
+
+    std::lock_guard<std::mutex> guard (registry_lock);
+
+    solver_stats_block *block = registry;
+
+    while (block != NULL && block->owned) block = block->next;
+
+    if (block == NULL)
+    {
+        block = new (std::nothrow) solver_stats_block {};
+
+        if (block == NULL)
+        {
+            solver_stats_tls = &shared_block;
+            return &shared_block;
+        }
+
+        block->next = registry;
+        registry    = block;
+    }
+
+    block->owned     = true;
+    owner.block      = block;
+    solver_stats_tls = block;
+
+    return block;
+}
+
+bool solver_stats_enabled (void)
+{
+    return true;
+}
+
+void solver_stats_get (struct solver_stats *stats)
+{
+    assert (stats != NULL && "pointer can't be null");
+
+    *stats = {};
+
+    std::lock_guard<std::mutex> guard (registry_lock);
+
+    for (const solver_stats_block *block = registry; block != NULL; block = block->next)
+    {
+        for (int i = 0; i < N_SOLVER_STATS; ++i)
+        {
+            stats->counters[i] += block->counters[i].load (std::memory_order_relaxed);
+        }
+    }
+}
+
+void solver_stats_reset (void)
+{
+    std::lock_guard<std::mutex> guard (registry_lock);
+
+    for (solver_stats_block *block = registry; block != NULL; block = block->next)
+    {
+        for (int i = 0; i < N_SOLVER_STATS; ++i)
+        {
+            block->counters[i].store (0, std::memory_order_relaxed);
+        }
+    }
+}
+
+#else
+
+bool solver_stats_enabled (void)
+{
+    return false;
+}
+
+void solver_stats_get (struct solver_stats *stats)
+{
+    assert (stats != NULL && "pointer can't be null");
+
+    *stats = {};
+}
+
+void solver_stats_reset (void) {}
+
+#endif
+
+const char *solver_stat_name (enum solver_stat stat)
+{
+    assert (0 <= stat && stat < N_SOLVER_STATS && "Invalid enum member");
+
+    return STAT_NAMES[stat];
+}
+
+void print_solver_stats (const struct solver_stats *stats, FILE *stream)
+{
+    assert (stats  != NULL && "pointer can't be null");
+    assert (stream != NULL && "pointer can't be null");
+
+    uint64_t n_calls = stats->counters[STAT_QUAD_CALLS];
+
+    fprintf (stream, "Solver branches:\n");
+
+    for (int i = 0; i < N_SOLVER_STATS; ++i)
+    {
+        uint64_t value = stats->counters[i];
+
+        if (value == 0 && i != STAT_QUAD_CALLS) continue;
+
+        double share = n_calls > 0 ? 100.0 * (double) value / (double) n_calls : 0;
+
+        fprintf (stream, "    %-28s %12llu  %5.1f%%\n", STAT_NAMES[i], (unsigned long long) value, share);
+    }
+}
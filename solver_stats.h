@@ -0,0 +1,103 @@
+#ifndef QUAD_SOLVER_STATS_H
+#define QUAD_SOLVER_STATS_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <atomic>
+#include <type_traits>
+#include "thread_pool.h"
+
+/**
+ * Counters of branches taken by quadratic solvers, compiled in with -D QUAD_STATS only.
+ *
+ * Every thread increments its own block of counters with relaxed load and store (no locked instructions
+ * and no shared cache lines), blocks are summed by solver_stats_get. Without QUAD_STATS _STAT macros are empty,
+ * solver_stats_get returns zeros.
+ *
+ * Batch kernels have no branches: they count the branch solve_quad_eq would take for every equation in range
+ * from lane masks they already compute, and add the counts once per batch. Quadratic equations solved inside
+ * cubic and quartic solvers are counted too.
+ */
+
+///@brief Solver branch
+enum solver_stat {
+    STAT_QUAD_CALLS = 0,  ///< Quadratic equations solved
+    STAT_LINEAR,          ///< a = 0: linear equation
+    STAT_LIN_DEGENERATE,  ///< k = 0 in linear equation: no roots or infinitely many
+    STAT_SCALED,          ///< Coefficients above safe limit, equation is solved with scaling
+    STAT_DISC_ZERO,       ///< Zero discriminant: one root
+    STAT_DISC_NEG,        ///< Negative discriminant: no real roots
+    STAT_B_ZERO,          ///< b = 0 shortcut: roots +-sqrt(-c/a)
+    STAT_C_ZERO,          ///< c = 0 shortcut: roots 0 and -b/a
+    STAT_GENERAL,         ///< Two roots with general formula
+    STAT_RANGE_LIN_ROOT,  ///< Rejected: linear root is out of range
+    STAT_RANGE_ONE_ROOT,  ///< Rejected: double root is out of range
+    STAT_RANGE_TWO_ROOTS, ///< Rejected: one of two roots (or complex root parts) is out of range
+    STAT_RANGE_CHECK,     ///< _CHECK_RANGE rejections of all solvers: ERANGE_SOLVE returned
+
+    N_SOLVER_STATS
+};
+
+///@brief Values of all counters
+struct solver_stats
+{
+    uint64_t counters[N_SOLVER_STATS];
+};
+
+#ifdef QUAD_STATS
+
+    ///@brief Counters of one thread. Blocks are never freed: block of exited thread keeps its counters
+    ///       and is reused by the next new thread
+    struct alignas(CACHE_LINE_SIZE) solver_stats_block
+    {
+        std::atomic<uint64_t> counters[N_SOLVER_STATS] = {};
+
+        bool                owned = false; ///< Block is used by running thread, guarded by registry lock
+        solver_stats_block *next  = NULL;
+    };
+
+    ///@brief Block of calling thread, NULL before its first counter is incremented
+    extern constinit thread_local solver_stats_block *solver_stats_tls;
+
+    ///@brief Create and register block of calling thread
+    solver_stats_block *solver_stats_register (void);
+
+    ///@brief Add value to counter of calling thread
+    static inline void solver_stats_add (enum solver_stat stat, uint64_t value)
+    {
+        solver_stats_block *block = solver_stats_tls;
+
+        if (__builtin_expect (block == NULL, 0)) block = solver_stats_register ();
+
+        // Only the owner thread writes, so load and store are enough
+        std::atomic<uint64_t> &counter = block->counters[stat];
+        counter.store (counter.load (std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    #define _STAT_ADD(stat, value) { if (!std::is_constant_evaluated ()) solver_stats_add (stat, value); }
+
+#else
+
+    #define _STAT_ADD(stat, value) {}
+
+#endif
+
+///@brief Increment counter of calling thread, nothing without QUAD_STATS
+#define _STAT(stat) _STAT_ADD (stat, 1)
+
+///@brief Counters are compiled in (QUAD_STATS is defined)
+bool solver_stats_enabled (void);
+
+///@brief Sum of counters of all threads, including exited ones. Counters of running solvers may be a bit behind
+void solver_stats_get (struct solver_stats *stats);
+
+///@brief Zero counters of all threads, must not be called while solvers are running
+void solver_stats_reset (void);
+
+///@brief Short description of counter
+const char *solver_stat_name (enum solver_stat stat);
+
+///@brief Print nonzero counters with their share of solved quadratic equations
+void print_solver_stats (const struct solver_stats *stats, FILE *stream);
+
+#endif //QUAD_SOLVER_STATS_H
@@ -1,17 +1,37 @@
 #include <time.h>
 #include <cassert>
 #include <cfloat>
+#include <cinttypes>
 #include <math.h>
 #include <stdio.h>
 #include <errno.h>
+#include <stdlib.h>
+#include <string.h>
 #include <strings.h>
+#include <unistd.h>
+#include <signal.h>
+#include <thread>
+#include <atomic>
 #include "equation_solver.h"
+#include "thread_pool.h"
+#include "batch_io.h"
+#include "bin_io.h"
+#include "num_io.h"
+#include "solution_cache.h"
+#include "solver_stats.h"
+#include "serve.h"
+#include "ring_queue.h"
+#include "pipeline.h"
+#include "prop_harness.h"
 #include "common_equation_solver.h"
+#include "equation_solver_const.h"
 #include "test_equation_solver.h"
 
 static double rand_range   (double min, double max);
+static void   rand_quad_coeffs (double *a, double *b, double *c);
 static int    is_equal     (double x, double y);
 static int    is_equal_set (double x1, double x2, double y1, double y2);
+static int    is_close     (double x, double y);
 
 ///Max line length in test
 static const int inp_buffer_size = 128;
@@ -127,6 +147,9 @@ int manual_test_solve_lin_eq (FILE *in_stream, FILE *report_stream)
     int n_roots = 0;
     char buffer[inp_buffer_size] = "";
 
+    _UNWRAP (test_solve_lin_eq (ONE_ROOT,     DBL_MAX, DBL_MAX, -1, report_stream));
+    _UNWRAP (test_solve_lin_eq (ERANGE_SOLVE, 1e-10,   DBL_MAX,  0, report_stream));
+
     while (fgets (buffer, inp_buffer_size, in_stream) != NULL)
     {
         if (buffer[0] == '#' || buffer[0] == '\n') continue;
@@ -149,7 +172,14 @@ int manual_test_solve_quad_eq (FILE *in_stream, FILE *report_stream)
     int n_roots = 0;
     char buffer[inp_buffer_size] = "";
 
-    _UNWRAP (test_solve_quad_eq (ERANGE_SOLVE, -DBL_MAX / 15.5, sqrt(DBL_MAX / 2), DBL_MAX / 15.5, 0, 0, report_stream));
+    // Intermediate values overflow without scaling, but roots are representable
+    _UNWRAP (test_solve_quad_eq (TWO_ROOTS, -DBL_MAX / 15.5, sqrt(DBL_MAX / 2), DBL_MAX / 15.5, -1, 1, report_stream));
+    _UNWRAP (test_solve_quad_eq (TWO_ROOTS, DBL_MAX, 0, -DBL_MAX, -1, 1, report_stream));
+    _UNWRAP (test_solve_quad_eq (ONE_ROOT,  1, -ldexp (1, 512), ldexp (1, 1022), ldexp (1, 511), 0, report_stream));
+
+    // Root overflows
+    _UNWRAP (test_solve_quad_eq (ERANGE_SOLVE, 1e-10, DBL_MAX, 0, 0, 0, report_stream));
+    _UNWRAP (test_solve_quad_eq (ERANGE_SOLVE, 1e-10, DBL_MAX, 1e300, 0, 0, report_stream));
 
     while (fgets (buffer, inp_buffer_size, in_stream) != NULL)
     {
@@ -164,6 +194,141 @@ int manual_test_solve_quad_eq (FILE *in_stream, FILE *report_stream)
     return 0;
 }
 
+///@brief Equation with expected solution, unused roots are zero
+struct quad_case
+{
+    double a, b, c;
+    num_roots n_roots;
+    double x1, x2;
+};
+
+/// Cases of quad.txt, lin.txt ("k b" as "0 k b") and manual_test_solve_quad_eq, solved at compile time
+constexpr quad_case CONST_CASES[] =
+{
+    // quad.txt
+    {0,   0,    0, INF_ROOTS,  0,  0},
+    {0,   0,  282, ZERO_ROOTS, 0,  0},
+    {1,   1,    1, ZERO_ROOTS, 0,  0},
+    {0, 228,  282, ONE_ROOT,  -1.2368421052631578947368, 0},
+    {1,   2,    1, ONE_ROOT,  -1,  0},
+    {1,   0,   -4, TWO_ROOTS, -2,  2},
+    {2,   4,    0, TWO_ROOTS,  0, -2},
+    {2, -12,  -14, TWO_ROOTS, -1,  7},
+
+    // lin.txt
+    {0,  0,     0,     INF_ROOTS,  0, 0},
+    {0,  2e-16, 0,     INF_ROOTS,  0, 0},
+    {0,  2e-16, 2e-16, INF_ROOTS,  0, 0},
+    {0,  0,     5,     ZERO_ROOTS, 0, 0},
+    {0,  0,    -5,     ZERO_ROOTS, 0, 0},
+    {0,  3,     2,     ONE_ROOT,  -0.6666666666666666, 0},
+    {0, -7,     9,     ONE_ROOT,   1.2857142857142858, 0},
+
+    // Scaled at compile time too
+    {DBL_MAX, 0,       -DBL_MAX, TWO_ROOTS,   -1, 1},
+    {1e-10,   DBL_MAX,  0,       ERANGE_SOLVE, 0, 0},
+    {0,       DBL_MAX,  DBL_MAX, ONE_ROOT,    -1, 0},
+    {0,       1e-10,    DBL_MAX, ERANGE_SOLVE, 0, 0},
+};
+
+///@brief x == y without -Wfloat-equal
+constexpr bool same_value (double x, double y)
+{
+    return !(x < y) && !(y < x);
+}
+
+///@brief Index of the first case, which solution differs from expected one, -1 if all solutions are right
+consteval int first_wrong_const_case ()
+{
+    int index = 0;
+
+    for (const quad_case &test : CONST_CASES)
+    {
+        eq_solution<double> sol = solve_quad_eq_const (test.a, test.b, test.c);
+
+        bool ok = sol.n_roots == test.n_roots &&
+                  (sol.n_roots != ONE_ROOT  || is_zero (sol.x1 - test.x1)) &&
+                  (sol.n_roots != TWO_ROOTS || (is_zero (sol.x1 - test.x1) && is_zero (sol.x2 - test.x2)) ||
+                                               (is_zero (sol.x1 - test.x2) && is_zero (sol.x2 - test.x1)));
+        if (!ok) return index;
+
+        index++;
+    }
+
+    return -1;
+}
+
+static_assert (first_wrong_const_case () == -1, "solve_quad_eq_const differs from quad.txt or lin.txt");
+
+static_assert (same_value (solve_lin_eq_const (3.0, 2.0).x1, -2.0 / 3), "linear root must be correctly rounded");
+
+// Other types with their tolerances and scaling limits
+static_assert (solve_quad_eq_const (1.0f, 2.0f, 1 - 1.2e-7f).n_roots == ONE_ROOT,   "float tolerance is 1e-5");
+static_assert (solve_quad_eq_const (1.0,  2.0,  1 - 1.2e-7 ).n_roots == TWO_ROOTS,  "double tolerance is 1e-11");
+static_assert (solve_quad_eq_const (1e30f, 0.0f, -1e30f).n_roots     == TWO_ROOTS,  "float coefficients are scaled");
+static_assert (solve_quad_eq_const (1e4000L, 0.0L, -4e4000L).x2 > 1.99L,            "long double coefficients are scaled");
+
+// Compile time sqrt is correctly rounded
+static_assert (same_value (fp_sqrt (2.0),     1.4142135623730951),     "fp_sqrt (2) differs from sqrt");
+static_assert (same_value (fp_sqrt (3.0),     1.7320508075688772),     "fp_sqrt (3) differs from sqrt");
+static_assert (same_value (fp_sqrt (0.5),     0.7071067811865476),     "fp_sqrt (0.5) differs from sqrt");
+static_assert (same_value (fp_sqrt (1e-300),  1e-150),                 "fp_sqrt (1e-300) differs from sqrt");
+static_assert (same_value (fp_sqrt (5e300),   2.2360679774997896e150), "fp_sqrt (5e300) differs from sqrt");
+static_assert (same_value (fp_sqrt (123456789.0), 11111.111060555555), "fp_sqrt (123456789) differs from sqrt");
+
+int manual_test_solve_const (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    // Table is built at compile time
+    constexpr size_t n_cases = sizeof (CONST_CASES) / sizeof (CONST_CASES[0]);
+
+    struct solution_table
+    {
+        eq_solution<double> sol[n_cases];
+    };
+
+    constexpr solution_table table = []
+    {
+        solution_table res = {};
+
+        for (size_t i = 0; i < n_cases; ++i)
+        {
+            res.sol[i] = solve_quad_eq_const (CONST_CASES[i].a, CONST_CASES[i].b, CONST_CASES[i].c);
+        }
+
+        return res;
+    } ();
+
+    // Run time solver must give bitwise the same roots
+    for (size_t i = 0; i < n_cases; ++i)
+    {
+        const quad_case &test = CONST_CASES[i];
+        double x1 = 0, x2 = 0;
+
+        num_roots n_roots = solve_quad_eq (test.a, test.b, test.c, &x1, &x2);
+
+        if (n_roots != table.sol[i].n_roots ||
+            (n_roots >= ONE_ROOT  && memcmp (&x1, &table.sol[i].x1, sizeof (double)) != 0) ||
+            (n_roots == TWO_ROOTS && memcmp (&x2, &table.sol[i].x2, sizeof (double)) != 0))
+        {
+            fprintf (report_stream, "## Test Error: Compile time solution differs from run time one ##\n");
+            fprintf
+                (
+                report_stream,
+                "Parameters: (%lg, %lg, %lg), compile time: (%d, x1: %.17lg, x2: %.17lg), "
+                "run time: (%d, x1: %.17lg, x2: %.17lg)\n\n",
+                test.a, test.b, test.c, table.sol[i].n_roots, table.sol[i].x1, table.sol[i].x2, n_roots, x1, x2
+                );
+
+            return -1;
+        }
+    }
+
+    _REPORT_OK();
+    return 0;
+}
+
 int manual_test_input_coeffs (FILE *in_stream, FILE *dev_null, FILE *report_stream)
 {
     assert (in_stream     != NULL && "pointer can't be NULL");
@@ -292,6 +457,9 @@ int auto_test_solve_lin_eq (FILE *report_stream)
                 break;
 
             case TWO_ROOTS:
+            case THREE_ROOTS:
+            case FOUR_ROOTS:
+            case COMPLEX_ROOTS:
                 assert (0 && "impossible number of roots");
                 break;
 
@@ -364,6 +532,12 @@ int auto_test_solve_quad_eq (FILE *report_stream)
             case ERANGE_SOLVE:
                 assert (0 && "Test parameters can't be out of range");
                 break;
+
+            case THREE_ROOTS:
+            case FOUR_ROOTS:
+            case COMPLEX_ROOTS:
+                assert (0 && "impossible number of roots");
+                break;
        
             default:
                 assert (0 && "Invalid enum member");
@@ -374,147 +548,2684 @@ int auto_test_solve_quad_eq (FILE *report_stream)
     return 0;
 }
 
-int auto_test_input_coeffs (const char *tmp_file, FILE *dev_null, FILE *report_stream)
+int auto_test_solve_quad_eq_batch (FILE *report_stream)
 {
-    assert (tmp_file      != NULL && "pointer can't be null");
-    assert (dev_null      != NULL && "pointer can't be null");
-    assert (report_stream != NULL && "pointer can't be null");
-
-    FILE *read_s  = fopen (tmp_file, "r");
-    FILE *write_s = fopen (tmp_file, "w");
+    assert (report_stream != NULL && "pointer can't be NULL");
 
-    const int num_coeffs = 3;
     const int num_test = 100;
-    double inp_coeffs[num_coeffs] = {}; // Values from input_coeffs
-    double ref_coeffs[num_coeffs] = {}; // Reference values
 
-    for (int n = 0; n < num_test; ++n)
-    {
-        for (int j = 0; j < num_coeffs; ++j)
-        {
-            ref_coeffs[j] = rand_range (-100, 100);
-            fprintf (write_s, "%.18lf\nadsjkfhakjlhgljak\n9e999\n", ref_coeffs[j]);
-        }
-
-        fflush (write_s);
-
-        if (input_coeffs (num_coeffs, inp_coeffs, read_s, dev_null) != 0)
-        {
-            fprintf (report_stream, "## Test Error: Wrong input ##\n");
-            fprintf (report_stream, "Failed to read input string with vals\n");
-
-            for (int j = 0; j < num_coeffs; ++j) 
-            {
-                fprintf (report_stream, "Val #%d: %lg\n", j, ref_coeffs[j]);
-            }
+    double a[num_test]  = {}, b[num_test]  = {}, c[num_test] = {};
+    double x1[num_test] = {}, x2[num_test] = {};
+    num_roots n_roots[num_test] = {};
 
-            putc ('\n', report_stream);
+    for (int i = 0; i < num_test; ++i)
+    {
+        rand_quad_coeffs (&a[i], &b[i], &c[i]);
+    }
 
-            return -1;
-        }
+    for (int isa = SIMD_GENERIC; isa <= SIMD_AVX512; ++isa)
+    {
+        if (!simd_isa_supported ((simd_isa) isa)) continue;
 
+        solve_quad_eq_batch_isa ((simd_isa) isa, num_test, a, b, c, x1, x2, n_roots);
 
-        for (int j = 0; j < num_coeffs; ++j)
+        for (int i = 0; i < num_test; ++i)
         {
-            if (!is_equal (inp_coeffs[j], ref_coeffs[j]))
+            double x1_ref = NAN, x2_ref = NAN;
+            num_roots n_roots_ref = solve_quad_eq (a[i], b[i], c[i], &x1_ref, &x2_ref);
+
+            if (n_roots[i] != n_roots_ref ||
+                (n_roots_ref == ONE_ROOT  && !is_equal (x1[i], x1_ref)) ||
+                (n_roots_ref == TWO_ROOTS && !is_equal_set (x1[i], x2[i], x1_ref, x2_ref)))
             {
-                fprintf (report_stream, "## Test Error: Wrong input ##\n");
-                fprintf (report_stream, "Invalid value #%d: expected %lg, got %lg\n\n", j, ref_coeffs[j], inp_coeffs[j]);
+                fprintf (report_stream, "## Test Error: Batch result differs from solve_quad_eq ##\n");
+                fprintf
+                    (
+                    report_stream,
+                    "ISA: %s, parameters: (%lg, %lg, %lg), batch: (%d, x1: %lg, x2: %lg), reference: (%d, x1: %lg, x2: %lg)\n\n",
+                    simd_isa_name ((simd_isa) isa), a[i], b[i], c[i], n_roots[i], x1[i], x2[i], n_roots_ref, x1_ref, x2_ref
+                    );
 
                 return -1;
             }
         }
     }
 
-    fclose (read_s);
-    fclose (write_s);
-
     _REPORT_OK();
     return 0;
 }
 
-void run_test(const char *tmp_file, const char *input_file, const char *lin_file, const char *quad_file,
-              const char *output_ref_file, const char *dev_null, const char *report_file)
+int auto_test_solve_quad_eq_branchless (FILE *report_stream)
 {
-    assert (tmp_file        != NULL && "pointer can't be null");
-    assert (input_file      != NULL && "pointer can't be null");
-    assert (quad_file       != NULL && "pointer can't be null");
-    assert (output_ref_file != NULL && "pointer can't be null");
-    assert (dev_null        != NULL && "pointer can't be null");
+    assert (report_stream != NULL && "pointer can't be NULL");
 
-    FILE *in_stream       = fopen (input_file,      "r");
-    FILE *quad_stream     = fopen (quad_file,       "r");
-    FILE *lin_stream      = fopen (lin_file,        "r");
-    FILE *ref_stream      = fopen (output_ref_file, "r");
-    FILE *dev_null_stream = fopen (dev_null,        "w");
-    FILE *report_stream   = NULL;
+    const int num_test = 100;
 
-    if (report_file != NULL) report_stream  = fopen (report_file, "w");
-    else                     report_stream  = stdout;
- 
-    unsigned int success = 0;
-    unsigned int failed  = 0;
+    double a[num_test]  = {}, b[num_test]  = {}, c[num_test] = {};
+    double x1[num_test] = {}, x2[num_test] = {};
+    num_roots n_roots[num_test] = {};
 
-    #define _LOG_TEST(test)                                             \
-    {                                                                   \
-        if (test)                                                       \
-        {                                                               \
-            fprintf (report_stream, " ### TEST FAILED: %s\n\n", #test);  \
-            failed++;                                                   \
-        }                                                               \
-        else                                                            \
-        {                                                               \
-            success++;                                                  \
-        }                                                               \
-    }                   
+    for (int i = 0; i < num_test; ++i)
+    {
+        rand_quad_coeffs (&a[i], &b[i], &c[i]);
+    }
 
-    fprintf (report_stream, "=== === Tests running... === ===\n");
+    solve_quad_eq_batch_branchless (num_test, a, b, c, x1, x2, n_roots);
 
-    _LOG_TEST (manual_test_solve_lin_eq  (lin_stream,  report_stream));
-    _LOG_TEST (manual_test_solve_quad_eq (quad_stream, report_stream));
+    for (int i = 0; i < num_test; ++i)
+    {
+        double x1_ref = NAN, x2_ref = NAN, y1 = NAN, y2 = NAN;
 
-    fseek (in_stream, 0, SEEK_SET);
+        num_roots n_roots_ref = solve_quad_eq (a[i], b[i], c[i], &x1_ref, &x2_ref);
+        num_roots n_roots_bl  = solve_quad_eq_branchless (a[i], b[i], c[i], &y1, &y2);
 
-    _LOG_TEST (manual_test_input_coeffs  (in_stream, dev_null_stream, report_stream));
-    _LOG_TEST (manual_test_output_format (tmp_file, ref_stream, report_stream));
+        // Roots of stable formula differ from classic one by rounding only
+        bool same_roots = (n_roots_ref < ONE_ROOT) ||
+                          (n_roots_ref == ONE_ROOT  && is_close (y1, x1_ref)) ||
+                          (n_roots_ref == TWO_ROOTS && ((is_close (y1, x1_ref) && is_close (y2, x2_ref)) ||
+                                                        (is_close (y1, x2_ref) && is_close (y2, x1_ref))));
 
-    _LOG_TEST (auto_test_solve_lin_eq  (report_stream));
-    _LOG_TEST (auto_test_solve_quad_eq (report_stream));
-    _LOG_TEST (auto_test_input_coeffs  (tmp_file, dev_null_stream, report_stream));
+        bool same_batch = n_roots[i] == n_roots_bl && memcmp (&x1[i], &y1, sizeof (double)) == 0 &&
+                                                      memcmp (&x2[i], &y2, sizeof (double)) == 0;
 
-    fprintf (report_stream, "\n==========================================\n");
-    fprintf (report_stream, "Tests: All: %u Failed: %u Passed: %u Success ratio: %3.1f%%\n",
-            success+failed, failed, success, success * 100.0 / (failed + success));
+        if (n_roots_bl != n_roots_ref || !same_roots || !same_batch)
+        {
+            fprintf (report_stream, "## Test Error: Branchless result differs ##\n");
+            fprintf
+                (
+                report_stream,
+                "Parameters: (%lg, %lg, %lg), branchless: (%d, x1: %lg, x2: %lg), batch: (%d, x1: %lg, x2: %lg), "
+                "reference: (%d, x1: %lg, x2: %lg)\n\n",
+                a[i], b[i], c[i], n_roots_bl, y1, y2, n_roots[i], x1[i], x2[i], n_roots_ref, x1_ref, x2_ref
+                );
 
-    #undef _LOG_TEST
+            return -1;
+        }
+    }
+
+    _REPORT_OK();
+    return 0;
 }
 
 /**
- * Generate random value in [min, max] range
+ * @brief Check solution of one equation with solver of type T, roots are compared with relative tolerance of T
  */
-static double rand_range (double min, double max)
+template <typename T>
+static int test_precision_case (const char *type_name, num_roots (*solve) (T, T, T, T *, T *),
+                                num_roots n_roots_ref, T a, T b, T c, T x1_ref, T x2_ref, FILE *report_stream)
 {
-    double range = (max - min);
-    return min + ((double) rand() / RAND_MAX) * range;
+    assert (type_name     != NULL && "pointer can't be NULL");
+    assert (solve         != NULL && "pointer can't be NULL");
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    const T error = fp_traits<T>::error;
+
+    auto close = [error] (T x, T y) { return fabs (x - y) <= error * (fabs (y) > 1 ? fabs (y) : 1); };
+
+    T x1 = (T) NAN, x2 = (T) NAN;
+    num_roots n_roots = solve (a, b, c, &x1, &x2);
+
+    bool ok = n_roots == n_roots_ref &&
+              (n_roots != ONE_ROOT  || close (x1, x1_ref)) &&
+              (n_roots != TWO_ROOTS || (close (x1, x1_ref) && close (x2, x2_ref)) ||
+                                       (close (x1, x2_ref) && close (x2, x1_ref)));
+    if (!ok)
+    {
+        fprintf (report_stream, "## Test Error: Wrong solution (%s) ##\n", type_name);
+        fprintf
+            (
+            report_stream,
+            "Parameters: (%Lg, %Lg, %Lg). Expected (%d, x1: %Lg, x2: %Lg), got (%d, x1: %Lg, x2: %Lg)\n\n",
+            (long double) a, (long double) b, (long double) c, n_roots_ref, (long double) x1_ref, (long double) x2_ref,
+            n_roots, (long double) x1, (long double) x2
+            );
+
+        return -1;
+    }
+
+    return 0;
 }
 
 /**
- * Compare x with y, taking into account floating point error
+ * @brief Solve the same equations with solver of type T, tolerance and scaling limit are of T
+ *
+ * @param[in] near_one_ref  Number of roots of x^2 + 2x + (1 - 1.2e-7) = 0: discriminant is about 5e-7,
+ *                          which is zero for float tolerance only
  */
-static int is_equal (double x, double y)
+template <typename T>
+static int test_precision (const char *type_name, num_roots (*solve) (T, T, T, T *, T *), num_roots near_one_ref,
+                           FILE *report_stream)
 {
-    return is_zero (x - y);
+    const T big  = 4 * fp_traits<T>::safe_max;
+    const T huge = fp_traits<T>::safe_max * fp_traits<T>::safe_max * fp_pow2<T> (23);
+
+    // Roots of near_one equation
+    const T near_one_c = (T) (1 - 1.2e-7L);
+    const T near_one_d = sqrt (1 - near_one_c);
+
+    _UNWRAP (test_precision_case<T> (type_name, solve, TWO_ROOTS,  1, -3,    2,  1,  2, report_stream));
+    _UNWRAP (test_precision_case<T> (type_name, solve, ONE_ROOT,   1,  2,    1, -1,  0, report_stream));
+    _UNWRAP (test_precision_case<T> (type_name, solve, ZERO_ROOTS, 1,  0,    1,  0,  0, report_stream));
+    _UNWRAP (test_precision_case<T> (type_name, solve, ONE_ROOT,   0,  2,   -4,  2,  0, report_stream));
+    _UNWRAP (test_precision_case<T> (type_name, solve, TWO_ROOTS, big, 0, -big, -1,  1, report_stream));
+    _UNWRAP (test_precision_case<T> (type_name, solve, ERANGE_SOLVE, (T) 0.5, huge, 0, 0, 0, report_stream));
+    _UNWRAP (test_precision_case<T> (type_name, solve, near_one_ref, 1, 2, near_one_c,
+                                     near_one_ref == ONE_ROOT ? -1 : -1 - near_one_d, -1 + near_one_d, report_stream));
+
+    return 0;
 }
 
-/**
- * @brief      Compare {x1, x2} to {y1, y2}, taking into account floating point error
- *
- * @return     True if equal set, False otherwise.
- */
-static int is_equal_set (double x1, double x2, double y1, double y2)
+int manual_test_solve_quad_eq_precision (FILE *report_stream)
 {
-    return  (is_equal (x1, y1) && is_equal (x2, y2)) ||
-            (is_equal (x1, y2) && is_equal (x2, y1));
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    _UNWRAP (test_precision<float>       ("float",       solve_quad_eq_f, ONE_ROOT,  report_stream));
+    _UNWRAP (test_precision<double>      ("double",      solve_quad_eq,   TWO_ROOTS, report_stream));
+    _UNWRAP (test_precision<long double> ("long double", solve_quad_eq_l, TWO_ROOTS, report_stream));
+
+#ifdef __SIZEOF_FLOAT128__
+    _UNWRAP (test_precision<__float128>  ("__float128",  solve_quad_eq_q, TWO_ROOTS, report_stream));
+#endif
+
+    _REPORT_OK();
+    return 0;
+}
+
+int auto_test_solve_quad_eq_batch_f (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    const int num_test = 100;
+
+    float a[num_test]  = {}, b[num_test]  = {}, c[num_test] = {};
+    float x1[num_test] = {}, x2[num_test] = {};
+    num_roots n_roots[num_test] = {};
+
+    for (int i = 0; i < num_test; ++i)
+    {
+        double a_d = 0, b_d = 0, c_d = 0;
+
+        // Coefficients must be representable as float
+        do rand_quad_coeffs (&a_d, &b_d, &c_d);
+        while (fabs (a_d) > 100 || fabs (b_d) > 100 || fabs (c_d) > 100);
+
+        // Every tenth equation is beyond float scaling limit, it is solved by fixup
+        double scale = i % 10 == 0 ? 1e18 : 1;
+
+        a[i] = (float) (a_d * scale);
+        b[i] = (float) (b_d * scale);
+        c[i] = (float) (c_d * scale);
+    }
+
+    solve_quad_eq_batch_f (num_test, a, b, c, x1, x2, n_roots);
+
+    for (int i = 0; i < num_test; ++i)
+    {
+        float x1_ref = NAN, x2_ref = NAN;
+        num_roots n_roots_ref = solve_quad_eq_f (a[i], b[i], c[i], &x1_ref, &x2_ref);
+
+        if (n_roots[i] != n_roots_ref ||
+            (n_roots_ref == ONE_ROOT  && memcmp (&x1[i], &x1_ref, sizeof (float)) != 0) ||
+            (n_roots_ref == TWO_ROOTS && (memcmp (&x1[i], &x1_ref, sizeof (float)) != 0 ||
+                                          memcmp (&x2[i], &x2_ref, sizeof (float)) != 0)))
+        {
+            fprintf (report_stream, "## Test Error: Float batch result differs from solve_quad_eq_f ##\n");
+            fprintf
+                (
+                report_stream,
+                "Parameters: (%g, %g, %g), batch: (%d, x1: %g, x2: %g), reference: (%d, x1: %g, x2: %g)\n\n",
+                (double) a[i], (double) b[i], (double) c[i], n_roots[i], (double) x1[i], (double) x2[i],
+                n_roots_ref, (double) x1_ref, (double) x2_ref
+                );
+
+            return -1;
+        }
+    }
+
+    _REPORT_OK();
+    return 0;
+}
+
+int auto_test_solve_quad_eq_batch_parallel (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    const size_t num_test  = 100003; // Not multiple of chunk size
+    const int    n_threads = 4;
+
+    double *coeffs = (double *) calloc (num_test * 7, sizeof (double));
+    num_roots *n_roots = (num_roots *) calloc (num_test * 2, sizeof (num_roots));
+    thread_pool *pool  = thread_pool_create (n_threads);
+
+    assert (coeffs != NULL && n_roots != NULL && pool != NULL && "Failed to allocate memory");
+
+    double *a = coeffs, *b = a + num_test, *c = b + num_test;
+    double *x1_ref = c + num_test, *x2_ref = x1_ref + num_test;
+    double *x1 = x2_ref + num_test, *x2 = x1 + num_test;
+    num_roots *n_roots_ref = n_roots + num_test;
+
+    for (size_t i = 0; i < num_test; ++i)
+    {
+        rand_quad_coeffs (&a[i], &b[i], &c[i]);
+    }
+
+    solve_quad_eq_batch          (      num_test, a, b, c, x1_ref, x2_ref, n_roots_ref);
+    solve_quad_eq_batch_parallel (pool, num_test, a, b, c, x1,     x2,     n_roots);
+
+    int res = 0;
+
+    if (memcmp (x1, x1_ref, num_test * sizeof (double)) != 0 ||
+        memcmp (x2, x2_ref, num_test * sizeof (double)) != 0 ||
+        memcmp (n_roots, n_roots_ref, num_test * sizeof (num_roots)) != 0)
+    {
+        fprintf (report_stream, "## Test Error: Parallel batch result differs from sequential one ##\n");
+        fprintf (report_stream, "Equations: %zu, threads: %d\n\n", num_test, n_threads);
+        res = -1;
+    }
+
+    thread_pool_destroy (pool);
+    free (coeffs);
+    free (n_roots);
+
+    if (res == 0) _REPORT_OK();
+    return res;
+}
+
+static_assert (solve_quad_eq_const<double, true> (1.0, 2.0, 5.0).n_roots == COMPLEX_ROOTS, "complex roots are -1 +- 2i");
+static_assert (solve_quad_eq_const<double, true> (1.0, 2.0, 5.0).x2 > 1.99,           "imaginary part is positive");
+
+int manual_test_solve_quad_eq_complex (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    struct complex_case
+    {
+        double a, b, c;
+        num_roots n_roots;
+        double x1, x2;
+    };
+
+    static const complex_case CASES[] = {
+        {1,        0,  1,       COMPLEX_ROOTS,  0,   1},
+        {1,        2,  5,       COMPLEX_ROOTS, -1,   2},
+        {-2,       4, -10,      COMPLEX_ROOTS,  1,   2}, // Imaginary part is positive for negative a
+        {DBL_MAX,  0,  DBL_MAX, COMPLEX_ROOTS,  0,   1}, // Scaled solver
+        {1,        2,  1,       ONE_ROOT,      -1,   0},
+        {1,       -3,  2,       TWO_ROOTS,      2,   1},
+        {0,        0,  1,       ZERO_ROOTS,     0,   0},
+    };
+
+    for (const complex_case &test : CASES)
+    {
+        double x1 = NAN, x2 = NAN;
+        num_roots n_roots = solve_quad_eq_complex (test.a, test.b, test.c, &x1, &x2);
+
+        bool ok = n_roots == test.n_roots;
+
+        if (ok && (n_roots == ONE_ROOT || n_roots == TWO_ROOTS || n_roots == COMPLEX_ROOTS))
+        {
+            ok = fabs (x1 - test.x1) <= DBL_ERROR;
+        }
+
+        if (ok && (n_roots == TWO_ROOTS || n_roots == COMPLEX_ROOTS))
+        {
+            ok = fabs (x2 - test.x2) <= DBL_ERROR;
+        }
+
+        if (!ok)
+        {
+            fprintf (report_stream, "## Test Error: Wrong complex solution of quadratic equation ##\n");
+            fprintf
+                (
+                report_stream,
+                "Parameters: (%lg, %lg, %lg), output: (%d, %.17lg, %.17lg), reference: (%d, %lg, %lg)\n\n",
+                test.a, test.b, test.c, n_roots, x1, x2, test.n_roots, test.x1, test.x2
+                );
+
+            return -1;
+        }
+    }
+
+    double roots[2] = {-1, 2};
+    char   output[MAX_SOLUTION_LEN + 1] = "";
+
+    output[format_solution (output, COMPLEX_ROOTS, roots, FORMAT_HUMAN)] = '\0';
+
+    if (strcmp (output, "2 complex solutions: -1.000e+00 ± 2.000e+00i\n") != 0)
+    {
+        fprintf (report_stream, "## Test Error: Wrong human format of complex roots ##\nGot: %s\n", output);
+        return -1;
+    }
+
+    output[format_solution (output, COMPLEX_ROOTS, roots, FORMAT_MACHINE)] = '\0';
+
+    if (strcmp (output, "-3 -1 2\n") != 0)
+    {
+        fprintf (report_stream, "## Test Error: Wrong machine format of complex roots ##\nGot: %s\n", output);
+        return -1;
+    }
+
+    _REPORT_OK();
+    return 0;
+}
+
+int auto_test_solve_quad_eq_batch_complex (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    const size_t num_test  = 10007;
+    const int    n_threads = 4;
+
+    double *coeffs = (double *) calloc (num_test * 5, sizeof (double));
+    num_roots *n_roots = (num_roots *) calloc (num_test, sizeof (num_roots));
+    thread_pool *pool  = thread_pool_create (n_threads);
+
+    assert (coeffs != NULL && n_roots != NULL && pool != NULL && "Failed to allocate memory");
+
+    double *a = coeffs, *b = a + num_test, *c = b + num_test;
+    double *x1 = c + num_test, *x2 = x1 + num_test;
+
+    for (size_t i = 0; i < num_test; ++i)
+    {
+        rand_quad_coeffs (&a[i], &b[i], &c[i]);
+
+        // Some coefficients are big, so scalar fixup is checked too
+        if (i % 97 == 0) c[i] = copysign (1e300, a[i]);
+    }
+
+    int res = 0;
+
+    for (int mode = 0; mode < 2 * (SOLVER_BRANCHLESS + 1) && res == 0; ++mode)
+    {
+        solver_mode solver = (solver_mode) (mode / 2);
+
+        if (mode % 2) solve_quad_eq_batch_complex_parallel_mode (pool, solver, num_test, a, b, c, x1, x2, n_roots);
+        else          solve_quad_eq_batch_complex_mode          (      solver, num_test, a, b, c, x1, x2, n_roots);
+
+        for (size_t i = 0; i < num_test; ++i)
+        {
+            double x1_ref = NAN, x2_ref = NAN;
+            num_roots n_roots_ref = solve_quad_eq_complex (a[i], b[i], c[i], &x1_ref, &x2_ref);
+
+            // Complex roots are calculated with the same operations, so they are equal bitwise
+            if (n_roots[i] != n_roots_ref ||
+                (n_roots_ref == COMPLEX_ROOTS && (memcmp (&x1[i], &x1_ref, sizeof (double)) != 0 ||
+                                                  memcmp (&x2[i], &x2_ref, sizeof (double)) != 0)) ||
+                (n_roots_ref == ONE_ROOT  && !is_equal (x1[i], x1_ref)) ||
+                (n_roots_ref == TWO_ROOTS && !is_equal_set (x1[i], x2[i], x1_ref, x2_ref)))
+            {
+                fprintf (report_stream, "## Test Error: Complex batch result differs from solve_quad_eq_complex ##\n");
+                fprintf
+                    (
+                    report_stream,
+                    "Mode: %d, parallel: %d, parameters: (%lg, %lg, %lg), batch: (%d, x1: %.17lg, x2: %.17lg), "
+                    "reference: (%d, x1: %.17lg, x2: %.17lg)\n\n",
+                    mode / 2, mode % 2, a[i], b[i], c[i], n_roots[i], x1[i], x2[i], n_roots_ref, x1_ref, x2_ref
+                    );
+
+                res = -1;
+                break;
+            }
+        }
+    }
+
+    thread_pool_destroy (pool);
+    free (coeffs);
+    free (n_roots);
+
+    if (res == 0) _REPORT_OK();
+    return res;
+}
+
+int manual_test_polish_quad_roots (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    // Small root of x^2 - 1e8*x + 1 cancels in -b - sqrt(disc), it is 1/x1 = 1e-8 + 1e-24
+    double x1 = NAN, x2 = NAN;
+    num_roots n_roots = solve_quad_eq (1, -1e8, 1, &x1, &x2);
+
+    double small = fabs (x1) < fabs (x2) ? x1 : x2;
+    double big   = fabs (x1) < fabs (x2) ? x2 : x1;
+
+    if (n_roots != TWO_ROOTS || !polish_quad_roots (1, -1e8, 1, n_roots, &small, &big) ||
+        fabs (small - 1e-8) > 2 * DBL_EPSILON * 1e-8 || fabs (big - 1e8) > 2 * DBL_EPSILON * 1e8)
+    {
+        fprintf (report_stream, "## Test Error: Roots with cancellation are not polished ##\n");
+        fprintf (report_stream, "Roots: %.17lg %.17lg\n\n", small, big);
+        return -1;
+    }
+
+    // Exact roots, double roots, linear and complex roots are not changed
+    x1 = 2, x2 = 1;
+    bool polished = polish_quad_roots (1, -3, 2, TWO_ROOTS, &x1, &x2);
+
+    x1 = 1, x2 = NAN;
+    polished = polished || polish_quad_roots (1, -2, 1, ONE_ROOT,      &x1, &x2);
+    polished = polished || polish_quad_roots (0,  2, 1, ONE_ROOT,      &x1, &x2);
+    polished = polished || polish_quad_roots (1,  2, 5, COMPLEX_ROOTS, &x1, &x2);
+
+    if (polished)
+    {
+        fprintf (report_stream, "## Test Error: Roots are polished, but they must not change ##\n\n");
+        return -1;
+    }
+
+    _REPORT_OK();
+    return 0;
+}
+
+int auto_test_polish_quad_eq_batch (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    const int num_test = 1000;
+
+    static double a[num_test]  = {}, b[num_test]  = {}, c[num_test] = {};
+    static double x1[num_test] = {}, x2[num_test] = {};
+    static bool   polished[num_test] = {};
+    static num_roots n_roots[num_test] = {};
+
+    // Nearly double roots r and r*(1 + d), rounding of coefficients and discriminant loses digits of them
+    for (int i = 0; i < num_test; ++i)
+    {
+        double root = rand_range (-100, +100);
+
+        a[i] = rand_range (1, 10);
+        b[i] = -a[i] * root * (2 + pow (10, rand_range (-4, -2)));
+        c[i] = b[i] * b[i] / (4 * a[i]) * (1 - pow (10, rand_range (-8, -4)));
+    }
+
+    solve_quad_eq_batch (num_test, a, b, c, x1, x2, n_roots);
+    int n_polished = polish_quad_eq_batch (num_test, a, b, c, n_roots, x1, x2, polished);
+
+    int n_changed = 0;
+
+    for (int i = 0; i < num_test; ++i)
+    {
+        double x1_ref = NAN, x2_ref = NAN;
+        num_roots n_roots_ref = solve_quad_eq (a[i], b[i], c[i], &x1_ref, &x2_ref);
+
+        // Batch polishing is the same as scalar one
+        bool polished_ref = polish_quad_roots (a[i], b[i], c[i], n_roots_ref, &x1_ref, &x2_ref);
+
+        n_changed += polished[i];
+
+        if (n_roots[i] != n_roots_ref || polished[i] != polished_ref ||
+            memcmp (&x1[i], &x1_ref, sizeof (double)) != 0 || memcmp (&x2[i], &x2_ref, sizeof (double)) != 0)
+        {
+            fprintf (report_stream, "## Test Error: Batch polishing differs from polish_quad_roots ##\n");
+            fprintf (report_stream, "Parameters: (%lg, %lg, %lg)\n\n", a[i], b[i], c[i]);
+            return -1;
+        }
+
+#ifdef __SIZEOF_FLOAT128__
+        // Roots of the same double coefficients in quad precision
+        __float128 root1 = 0, root2 = 0;
+        num_roots n_roots_quad = solve_quad_eq_q (a[i], b[i], c[i], &root1, &root2);
+
+        if (n_roots_quad != TWO_ROOTS || n_roots[i] != TWO_ROOTS) continue;
+
+        double ref1 = (double) root1, ref2 = (double) root2;
+
+        if ((x1[i] < x2[i]) != (ref1 < ref2))
+        {
+            double tmp = ref1;
+            ref1 = ref2;
+            ref2 = tmp;
+        }
+
+        if (fabs (x1[i] - ref1) > 4 * DBL_EPSILON * fabs (ref1) || fabs (x2[i] - ref2) > 4 * DBL_EPSILON * fabs (ref2))
+        {
+            fprintf (report_stream, "## Test Error: Polished roots are not accurate ##\n");
+            fprintf
+                (
+                report_stream,
+                "Parameters: (%.17lg, %.17lg, %.17lg), polished: (%.17lg, %.17lg), reference: (%.17lg, %.17lg)\n\n",
+                a[i], b[i], c[i], x1[i], x2[i], ref1, ref2
+                );
+
+            return -1;
+        }
+#endif
+    }
+
+    if (n_changed != n_polished)
+    {
+        fprintf (report_stream, "## Test Error: polish_quad_eq_batch returned %d, but %d roots are polished ##\n\n",
+                 n_polished, n_changed);
+        return -1;
+    }
+
+    _REPORT_OK();
+    return 0;
+}
+
+int manual_test_solve_quad_eq_accurate (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    // Roots 1 +- 2^-20 of x^2 - 2x + 1 - 2^-40: discriminant 2^-38 is below DBL_ERROR, but it is exact.
+    // The same equation multiplied by powers of two must have the same roots
+    const double delta = ldexp (1, -20);
+    const int    exps[] = {-1000, -500, -70, 0, 70, 500, 1000};
+
+    for (int exp : exps)
+    {
+        double a = ldexp (1, exp), b = ldexp (-2, exp), c = ldexp (1 - delta * delta, exp);
+        double x1 = NAN, x2 = NAN;
+
+        num_roots n_roots = solve_quad_eq_accurate (a, b, c, &x1, &x2);
+
+        double small = fmin (x1, x2), big = fmax (x1, x2);
+
+        if (n_roots != TWO_ROOTS || fabs (small - (1 - delta)) > 0 || fabs (big - (1 + delta)) > 0)
+        {
+            fprintf (report_stream, "## Test Error: Wrong nearly double roots of scaled equation ##\n");
+            fprintf (report_stream, "Scale: 2^%d, output: (%d, %.17lg, %.17lg)\n\n", exp, n_roots, x1, x2);
+            return -1;
+        }
+    }
+
+    struct accurate_case
+    {
+        double a, b, c;
+        num_roots n_roots;
+        double x1;
+    };
+
+    static const accurate_case CASES[] = {
+        {1e-5,   -2e-5,   1.0000001e-5, ZERO_ROOTS, 0}, // solve_quad_eq finds one root
+        {1e-300, -2e-300, 1e-300,       ONE_ROOT,   1}, // solve_quad_eq finds infinitely many roots
+        {1,      -2,      1,            ONE_ROOT,   1},
+        {0,       2,     -1,            ONE_ROOT,   0.5},
+        {1e-20,   1,     -1,            TWO_ROOTS,  0}, // tiny a gives huge root -1e20, not a linear equation
+        {0,       0,      1,            ZERO_ROOTS, 0},
+        {0,       0,      0,            INF_ROOTS,  0},
+    };
+
+    for (const accurate_case &test : CASES)
+    {
+        double x1 = NAN, x2 = NAN;
+        num_roots n_roots = solve_quad_eq_accurate (test.a, test.b, test.c, &x1, &x2);
+
+        if (n_roots != test.n_roots || (n_roots == ONE_ROOT && fabs (x1 - test.x1) > DBL_ERROR))
+        {
+            fprintf (report_stream, "## Test Error: Wrong solution of accurate solver ##\n");
+            fprintf
+                (
+                report_stream,
+                "Parameters: (%lg, %lg, %lg), output: (%d, %.17lg), reference: (%d, %lg)\n\n",
+                test.a, test.b, test.c, n_roots, x1, test.n_roots, test.x1
+                );
+
+            return -1;
+        }
+    }
+
+    _REPORT_OK();
+    return 0;
+}
+
+int auto_test_solve_quad_eq_accurate (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    const int num_test = 1000;
+
+    static double a[num_test]  = {}, b[num_test]  = {}, c[num_test] = {};
+    static double x1[num_test] = {}, x2[num_test] = {};
+    static num_roots n_roots[num_test] = {};
+
+    for (int i = 0; i < num_test; ++i)
+    {
+        double sign = rand() % 2 ? 1 : -1;
+
+        switch (i % 4)
+        {
+            // Nearly double roots on both sides of zero discriminant with coefficients of any scale
+            case 0:
+            {
+                double root  = rand_range (-100, +100);
+                double scale = ldexp (1, rand() % 1201 - 600);
+
+                a[i] = rand_range (1, 10) * scale;
+                b[i] = -2 * a[i] * root;
+                c[i] = a[i] * root * root * (1 + rand_range (-1, 1) * pow (10, rand_range (-15, -8)));
+                break;
+            }
+            // Huge b: tiny root cancels in -b + sqrt (D)
+            case 1:
+                a[i] = rand_range (1, 10);
+                b[i] = ldexp (rand_range (1, 2), 300 + rand() % 701) * sign;
+                c[i] = rand_range (-10, 10);
+                break;
+            // Tiny a: nearly linear equation with a huge root
+            case 2:
+                a[i] = ldexp (rand_range (1, 2), -30 - rand() % 41) * sign;
+                b[i] = rand_range (0.5, 2);
+                c[i] = rand_range (-2, 2);
+                break;
+            // Exponents of coefficients are far apart
+            default:
+                a[i] = ldexp (rand_range (1, 2), rand() % 2001 - 1000) * sign;
+                b[i] = ldexp (rand_range (1, 2), rand() % 2001 - 1000) * (rand() % 2 ? 1 : -1);
+                c[i] = ldexp (rand_range (1, 2), rand() % 2001 - 1000) * (rand() % 2 ? 1 : -1);
+                break;
+        }
+    }
+
+    solve_quad_eq_batch_mode (SOLVER_ACCURATE, num_test, a, b, c, x1, x2, n_roots);
+
+    int n_checked[4] = {};
+
+    for (int i = 0; i < num_test; ++i)
+    {
+        double x1_ref = NAN, x2_ref = NAN;
+        num_roots n_roots_ref = solve_quad_eq_accurate (a[i], b[i], c[i], &x1_ref, &x2_ref);
+
+        if (n_roots[i] != n_roots_ref ||
+            (n_roots_ref >= ONE_ROOT  && memcmp (&x1[i], &x1_ref, sizeof (double)) != 0) ||
+            (n_roots_ref == TWO_ROOTS && memcmp (&x2[i], &x2_ref, sizeof (double)) != 0))
+        {
+            fprintf (report_stream, "## Test Error: Batch result differs from solve_quad_eq_accurate ##\n");
+            fprintf (report_stream, "Parameters: (%lg, %lg, %lg)\n\n", a[i], b[i], c[i]);
+            return -1;
+        }
+
+#ifdef __SIZEOF_FLOAT128__
+        // Products of doubles are exact in quad precision, so the sign of discriminant is exact
+        __float128 disc  = (__float128) b[i] * b[i] - 4 * (__float128) a[i] * c[i];
+        __float128 terms = (__float128) b[i] * b[i] + 4 * fabs ((__float128) a[i] * c[i]);
+
+        // Discriminant far enough from the tolerance must give the number of roots by its sign
+        bool is_two  = disc >  16 * (__float128) DBL_EPSILON * DBL_EPSILON * terms;
+        bool is_zero_roots = disc < -16 * (__float128) DBL_EPSILON * DBL_EPSILON * terms;
+
+        // Reference roots: stable formula with discriminant of doubles in quad precision, solve_quad_eq_q is not
+        // used, its absolute tolerance makes a zero, when b^2 is much bigger than ac. Exponents of roots of doubles
+        // fit in quad precision, and the error of discriminant is far below DBL_EPSILON of q for is_two
+        __float128 sq_disc = is_two ? sqrt (disc) : 0;
+        __float128 q       = -((__float128) b[i] + (b[i] < 0 ? -sq_disc : sq_disc)) / 2;
+
+        double ref1 = is_two ? (double) (q / a[i]) : 0;
+        double ref2 = is_two ? (double) (c[i] / q) : 0;
+
+        // Roots out of double range give ERANGE_SOLVE
+        num_roots expected = !is_two ? ZERO_ROOTS : isfinite (ref1) && isfinite (ref2) ? TWO_ROOTS : ERANGE_SOLVE;
+
+        if ((is_two || is_zero_roots) && n_roots[i] != expected)
+        {
+            fprintf (report_stream, "## Test Error: Wrong number of roots of accurate solver ##\n");
+            fprintf
+                (
+                report_stream,
+                "Parameters: (%.17lg, %.17lg, %.17lg), output: %d, reference: %d, discriminant: %lg of terms\n\n",
+                a[i], b[i], c[i], n_roots[i], expected, (double) (disc / terms)
+                );
+
+            return -1;
+        }
+
+        if (n_roots[i] != TWO_ROOTS) continue;
+
+        n_checked[i % 4]++;
+
+        if ((x1[i] < x2[i]) != (ref1 < ref2))
+        {
+            double tmp = ref1;
+            ref1 = ref2;
+            ref2 = tmp;
+        }
+
+        // Subnormal roots are rounded twice: to the scaled root and to the subnormal
+        if (fabs (x1[i] - ref1) > 4 * DBL_EPSILON * fabs (ref1) + DBL_TRUE_MIN ||
+            fabs (x2[i] - ref2) > 4 * DBL_EPSILON * fabs (ref2) + DBL_TRUE_MIN)
+        {
+            fprintf (report_stream, "## Test Error: Roots of accurate solver are not accurate ##\n");
+            fprintf
+                (
+                report_stream,
+                "Parameters: (%.17lg, %.17lg, %.17lg), output: (%.17lg, %.17lg), reference: (%.17lg, %.17lg)\n\n",
+                a[i], b[i], c[i], x1[i], x2[i], ref1, ref2
+                );
+
+            return -1;
+        }
+#endif
+    }
+
+#ifdef __SIZEOF_FLOAT128__
+    // Every family must have equations with two roots in range
+    for (int family = 0; family < 4; ++family)
+    {
+        if (n_checked[family] < num_test / 16)
+        {
+            fprintf (report_stream, "## Test Error: Only %d roots of family %d are checked ##\n\n",
+                     n_checked[family], family);
+            return -1;
+        }
+    }
+#else
+    (void) n_checked;
+#endif
+
+    _REPORT_OK();
+    return 0;
+}
+
+int auto_test_solution_cache (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    const size_t num_test  = 100003; // Not multiple of chunk size
+    const int    n_distinct = 3000;
+    const int    n_threads  = 4;
+
+    double *coeffs = (double *) calloc (num_test * 7, sizeof (double));
+    num_roots *n_roots = (num_roots *) calloc (num_test * 2, sizeof (num_roots));
+    thread_pool *pool  = thread_pool_create (n_threads);
+
+    assert (coeffs != NULL && n_roots != NULL && pool != NULL && "Failed to allocate memory");
+
+    double *a = coeffs, *b = a + num_test, *c = b + num_test;
+    double *x1_ref = c + num_test, *x2_ref = x1_ref + num_test;
+    double *x1 = x2_ref + num_test, *x2 = x1 + num_test;
+    num_roots *n_roots_ref = n_roots + num_test;
+
+    // Few distinct equations, which repeat
+    for (size_t i = 0; i < (size_t) n_distinct; ++i) rand_quad_coeffs (&a[i], &b[i], &c[i]);
+
+    for (size_t i = n_distinct; i < num_test; ++i)
+    {
+        size_t j = (size_t) rand() % n_distinct;
+
+        a[i] = a[j];
+        b[i] = b[j];
+        c[i] = c[j];
+    }
+
+    solve_quad_eq_batch (num_test, a, b, c, x1_ref, x2_ref, n_roots_ref);
+
+    int res = 0;
+
+    // Capacity is less than number of distinct equations, so some of them are evicted
+    const size_t capacities[] = {1024, 1 << 18};
+
+    for (size_t capacity : capacities)
+    {
+        for (int parallel = 0; parallel < 2 && res == 0; ++parallel)
+        {
+            batch_opts opts = {};
+            opts.pool  = parallel ? pool : NULL;
+            opts.cache = solution_cache_create (capacity, parallel ? thread_pool_size (pool) : 1);
+
+            assert (opts.cache != NULL && "Failed to allocate memory");
+
+            // The second pass takes solutions from cache
+            for (int pass = 0; pass < 2 && res == 0; ++pass)
+            {
+                eq_batch_solve_quad (num_test, a, b, c, x1, x2, n_roots, &opts);
+
+                if (memcmp (x1, x1_ref, num_test * sizeof (double)) != 0 ||
+                    memcmp (x2, x2_ref, num_test * sizeof (double)) != 0 ||
+                    memcmp (n_roots, n_roots_ref, num_test * sizeof (num_roots)) != 0)
+                {
+                    fprintf (report_stream, "## Test Error: Cached solutions differ from solve_quad_eq_batch ##\n");
+                    fprintf (report_stream, "Capacity: %zu, parallel: %d, pass: %d\n\n", capacity, parallel, pass);
+                    res = -1;
+                }
+            }
+
+            cache_stats stats = {};
+            solution_cache_stats (opts.cache, &stats);
+
+            bool big = capacity > (size_t) n_distinct;
+
+            // Big cache evicts only equations, which got into full probe window, small cache can't hold all of them
+            if (res == 0 && (stats.hits + stats.misses != 2 * num_test || (big && stats.hits < num_test) ||
+                             (big && stats.evictions >= (size_t) n_distinct) || (!big && stats.evictions == 0)))
+            {
+                fprintf (report_stream, "## Test Error: Wrong cache counters ##\n");
+                fprintf
+                    (
+                    report_stream,
+                    "Capacity: %zu, parallel: %d, hits: %zu, misses: %zu, evictions: %zu\n\n",
+                    capacity, parallel, stats.hits, stats.misses, stats.evictions
+                    );
+
+                res = -1;
+            }
+
+            solution_cache_destroy (opts.cache);
+        }
+    }
+
+    thread_pool_destroy (pool);
+    free (coeffs);
+    free (n_roots);
+
+    if (res == 0) _REPORT_OK();
+    return res;
+}
+
+int auto_test_serve (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    const int    n_clients = 4;
+    const size_t sizes[]   = {1, 7, 1000, 3}; // Requests of every client, sent before reading responses
+    const size_t n_sizes   = sizeof (sizes) / sizeof (sizes[0]);
+    const size_t num_test  = 1011;
+
+    char socket_path[64] = "";
+    snprintf (socket_path, sizeof (socket_path), "/tmp/quad_test_%d.sock", getpid ());
+
+    double *coeffs = (double *) calloc (num_test * 7, sizeof (double));
+    num_roots *n_roots = (num_roots *) calloc (num_test * 2, sizeof (num_roots));
+
+    assert (coeffs != NULL && n_roots != NULL && "Failed to allocate memory");
+
+    double *a = coeffs, *b = a + num_test, *c = b + num_test;
+    double *x1_ref = c + num_test, *x2_ref = x1_ref + num_test;
+    double *x1 = x2_ref + num_test, *x2 = x1 + num_test;
+    num_roots *n_roots_ref = n_roots + num_test;
+
+    for (size_t i = 0; i < num_test; ++i) rand_quad_coeffs (&a[i], &b[i], &c[i]);
+
+    solve_quad_eq_batch (num_test, a, b, c, x1_ref, x2_ref, n_roots_ref);
+
+    batch_opts opts = {};
+    quad_server *server = server_create (socket_path, &opts);
+
+    if (server == NULL)
+    {
+        fprintf (report_stream, "## Test Error: Failed to create server: %s ##\n\n", strerror (errno));
+        free (coeffs);
+        free (n_roots);
+        return -1;
+    }
+
+    int server_err = 0;
+    std::thread server_thread ([server, &server_err] { server_err = server_run (server); });
+
+    int fds[n_clients] = {};
+    int res = 0;
+
+    for (int i = 0; i < n_clients && res == 0; ++i)
+    {
+        fds[i] = serve_connect (socket_path);
+        if (fds[i] < 0) res = errno;
+    }
+
+    // Requests of all clients are in flight together, so some of them are solved in one batch
+    for (int i = 0; i < n_clients && res == 0; ++i)
+    {
+        for (size_t j = 0, begin = 0; j < n_sizes && res == 0; begin += sizes[j++])
+        {
+            res = serve_send (fds[i], sizes[j], a + begin, b + begin, c + begin);
+        }
+    }
+
+    for (int i = 0; i < n_clients && res == 0; ++i)
+    {
+        for (size_t j = 0, begin = 0; j < n_sizes && res == 0; begin += sizes[j++])
+        {
+            res = serve_recv (fds[i], sizes[j], x1 + begin, x2 + begin, n_roots + begin);
+        }
+
+        if (res == 0 && (memcmp (x1, x1_ref, num_test * sizeof (double)) != 0 ||
+                         memcmp (x2, x2_ref, num_test * sizeof (double)) != 0 ||
+                         memcmp (n_roots, n_roots_ref, num_test * sizeof (num_roots)) != 0))
+        {
+            fprintf (report_stream, "## Test Error: Server solutions differ from solve_quad_eq_batch ##\n");
+            fprintf (report_stream, "Client: %d\n\n", i);
+            res = -1;
+        }
+    }
+
+    if (res > 0) fprintf (report_stream, "## Test Error: Client failed: %s ##\n\n", strerror (res));
+
+    // Request above SERVE_MAX_COUNT closes the connection
+    if (res == 0)
+    {
+        serve_header header = {SERVE_MAX_COUNT + 1, 0};
+        char byte = 0;
+
+        if (write (fds[0], &header, sizeof (header)) != sizeof (header) || read (fds[0], &byte, 1) != 0)
+        {
+            fprintf (report_stream, "## Test Error: Bad request is not rejected ##\n\n");
+            res = -1;
+        }
+    }
+
+    for (int i = 0; i < n_clients; ++i)
+    {
+        if (fds[i] > 0) close (fds[i]);
+    }
+
+    server_stop (server);
+    server_thread.join ();
+    server_destroy (server);
+
+    free (coeffs);
+    free (n_roots);
+
+    if (res == 0 && (server_err != 0 || access (socket_path, F_OK) == 0))
+    {
+        fprintf (report_stream, "## Test Error: Server failed: %d or socket file is not removed ##\n\n", server_err);
+        res = -1;
+    }
+
+    if (res == 0) _REPORT_OK();
+    return res == 0 ? 0 : -1;
+}
+
+int auto_test_prop_harness (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    // Known outcomes of prop_check: exact roots, wrong number of roots, spurious range error
+    prop_stats known = {};
+
+    prop_check (1, -3, 2, TWO_ROOTS,    2, 1,   &known);
+    prop_check (1, -2, 1, TWO_ROOTS,    1, 1,   &known);
+    prop_check (1, -3, 2, ERANGE_SOLVE, NAN, NAN, &known);
+    prop_check (0,  2, 1, ONE_ROOT,     nextafter (-0.5, -1), NAN, &known);
+
+    if (known.n_cases != 4 || known.n_misclassified != 1 || known.n_range != 1 || known.n_roots != 3 ||
+        !same_value (known.max_ulp, 1) || !same_value (known.sum_ulp, 1))
+    {
+        fprintf (report_stream, "## Test Error: Wrong stats of known equations ##\n");
+        fprintf (report_stream, "Misclassified: %" PRIu64 ", range: %" PRIu64 ", roots: %" PRIu64 ", max ULP: %lg\n\n",
+                 known.n_misclassified, known.n_range, known.n_roots, known.max_ulp);
+        return -1;
+    }
+
+    // Counts and max errors must not depend on number of threads
+    const uint64_t num_test = 40000;
+
+    thread_pool *pool = thread_pool_create (4);
+    prop_report *reports = (prop_report *) calloc (2, sizeof (prop_report));
+
+    assert (pool != NULL && reports != NULL && "Failed to allocate memory");
+
+    prop_opts opts = {num_test, 42, NULL};
+    int err = prop_run (&opts, &reports[0]);
+
+    opts.pool = pool;
+    if (err == 0) err = prop_run (&opts, &reports[1]);
+
+    thread_pool_destroy (pool);
+
+    int res = 0;
+
+    bool same = err == 0 && reports[0].n_cases == reports[1].n_cases;
+
+    for (int variant = 0; variant < N_PROP_VARIANTS && same; ++variant)
+    {
+        for (int family = 0; family < N_PROP_FAMILIES && same; ++family)
+        {
+            const prop_stats *seq = &reports[0].stats[variant][family];
+            const prop_stats *par = &reports[1].stats[variant][family];
+
+            same = seq->n_cases == par->n_cases && seq->n_misclassified == par->n_misclassified &&
+                   seq->n_range == par->n_range && seq->n_not_finite == par->n_not_finite &&
+                   seq->n_roots == par->n_roots && same_value (seq->max_ulp, par->max_ulp) &&
+                   fabs (seq->sum_ulp - par->sum_ulp) <= 1e-9 * seq->sum_ulp;
+        }
+    }
+
+    if (!same)
+    {
+        fprintf (report_stream, "## Test Error: Parallel report differs from sequential one, error: %d ##\n\n", err);
+        res = -1;
+    }
+
+    // Solvers never return infinite roots, stable ones are accurate where their tolerance allows,
+    // the accurate solver finds both roots of equations with huge b or tiny a
+    struct ulp_bound
+    {
+        prop_variant variant;
+        prop_family  family;
+        double       max_ulp;
+        bool         exact_n_roots;
+    };
+
+    static const ulp_bound BOUNDS[] = {
+        {VARIANT_ACCURATE, FAMILY_UNIFORM,     4, true},
+        {VARIANT_ACCURATE, FAMILY_FULL_RANGE,  4, false},
+        {VARIANT_ACCURATE, FAMILY_NEAR_DOUBLE, 4, false},
+        {VARIANT_ACCURATE, FAMILY_HUGE_B,      4, true},
+        {VARIANT_ACCURATE, FAMILY_TINY_A,      4, true},
+        {VARIANT_POLISHED, FAMILY_UNIFORM,     1, false},
+        {VARIANT_POLISHED, FAMILY_HUGE_B,      1, false},
+        {VARIANT_POLISHED, FAMILY_TINY_A,      1, false},
+    };
+
+    for (int variant = 0; variant < N_PROP_VARIANTS && res == 0; ++variant)
+    {
+        for (int family = 0; family < N_PROP_FAMILIES && res == 0; ++family)
+        {
+            if (reports[0].stats[variant][family].n_not_finite == 0) continue;
+
+            fprintf (report_stream, "## Test Error: %s solver returned infinite root for %s equation ##\n\n",
+                     prop_variant_name ((prop_variant) variant), prop_family_name ((prop_family) family));
+            res = -1;
+        }
+    }
+
+    for (const ulp_bound &bound : BOUNDS)
+    {
+        const prop_stats *stats = &reports[0].stats[bound.variant][bound.family];
+
+        if (res == 0 && (stats->n_roots == 0 || stats->max_ulp > bound.max_ulp))
+        {
+            fprintf (report_stream, "## Test Error: Roots of %s solver are not accurate on %s equations ##\n",
+                     prop_variant_name (bound.variant), prop_family_name (bound.family));
+            fprintf (report_stream, "Max error: %lg ULP, bound: %lg ULP, equation: (%.17lg, %.17lg, %.17lg)\n\n",
+                     stats->max_ulp, bound.max_ulp, stats->worst[0], stats->worst[1], stats->worst[2]);
+            res = -1;
+        }
+
+        if (res == 0 && bound.exact_n_roots && stats->n_misclassified != 0)
+        {
+            fprintf (report_stream, "## Test Error: Wrong number of roots of %s solver on %s equations ##\n",
+                     prop_variant_name (bound.variant), prop_family_name (bound.family));
+            fprintf (report_stream, "Misclassified: %" PRIu64 " of %" PRIu64 "\n\n",
+                     stats->n_misclassified, stats->n_cases);
+            res = -1;
+        }
+    }
+
+    free (reports);
+
+    if (res == 0) _REPORT_OK();
+    return res;
+}
+
+///@brief Equation with the branch of solve_quad_eq it must take
+struct stats_case
+{
+    double a, b, c;
+    solver_stat branch;
+};
+
+int auto_test_solver_stats (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    // Nothing is counted without QUAD_STATS
+    if (!solver_stats_enabled ())
+    {
+        _REPORT_OK();
+        return 0;
+    }
+
+    int res = 0;
+
+    static const stats_case cases[] =
+    {
+        {1,     -3,     2, STAT_GENERAL},
+        {1,      2,     1, STAT_DISC_ZERO},
+        {1,      0,     1, STAT_DISC_NEG},
+        {1,      0,    -4, STAT_B_ZERO},
+        {1,      2,     0, STAT_C_ZERO},
+        {0,      2,     1, STAT_LINEAR},
+        {0,      0,     1, STAT_LIN_DEGENERATE},
+        {1e300,  1,    -1, STAT_SCALED},
+        {1e-10,  1e300, 1, STAT_RANGE_TWO_ROOTS},
+    };
+
+    for (const stats_case &test : cases)
+    {
+        solver_stats_reset ();
+
+        double x1 = NAN, x2 = NAN;
+        solve_quad_eq (test.a, test.b, test.c, &x1, &x2);
+
+        solver_stats stats = {};
+        solver_stats_get (&stats);
+
+        if (stats.counters[STAT_QUAD_CALLS] != 1 || stats.counters[test.branch] != 1)
+        {
+            fprintf (report_stream, "## Test Error: Branch is not counted ##\n");
+            fprintf (report_stream, "Coeffs: %lg %lg %lg, branch: %s, count: %llu\n\n", test.a, test.b, test.c,
+                     solver_stat_name (test.branch), (unsigned long long) stats.counters[test.branch]);
+            res = -1;
+        }
+    }
+
+    // Batch kernels count the same branches as scalar solver, in any number of threads
+    const size_t num_test  = 100003;
+    const int    n_threads = 4;
+
+    double *coeffs = (double *) calloc (num_test * 5, sizeof (double));
+    num_roots *n_roots = (num_roots *) calloc (num_test, sizeof (num_roots));
+    thread_pool *pool  = thread_pool_create (n_threads);
+
+    assert (coeffs != NULL && n_roots != NULL && pool != NULL && "Failed to allocate memory");
+
+    double *a = coeffs, *b = a + num_test, *c = b + num_test;
+    double *x1 = c + num_test, *x2 = x1 + num_test;
+
+    for (size_t i = 0; i < num_test; ++i) rand_quad_coeffs (&a[i], &b[i], &c[i]);
+
+    solver_stats_reset ();
+
+    for (size_t i = 0; i < num_test; ++i) solve_quad_eq (a[i], b[i], c[i], &x1[i], &x2[i]);
+
+    solver_stats scalar_stats = {};
+    solver_stats_get (&scalar_stats);
+
+    for (int parallel = 0; parallel < 2 && res == 0; ++parallel)
+    {
+        solver_stats_reset ();
+
+        if (parallel) solve_quad_eq_batch_parallel (pool, num_test, a, b, c, x1, x2, n_roots);
+        else          solve_quad_eq_batch (num_test, a, b, c, x1, x2, n_roots);
+
+        solver_stats batch_stats = {};
+        solver_stats_get (&batch_stats);
+
+        for (int i = 0; i < N_SOLVER_STATS; ++i)
+        {
+            if (batch_stats.counters[i] != scalar_stats.counters[i])
+            {
+                fprintf (report_stream, "## Test Error: Batch counter differs from scalar one ##\n");
+                fprintf (report_stream, "Counter: %s, parallel: %d, batch: %llu, scalar: %llu\n\n",
+                         solver_stat_name ((solver_stat) i), parallel,
+                         (unsigned long long) batch_stats.counters[i], (unsigned long long) scalar_stats.counters[i]);
+                res = -1;
+            }
+        }
+    }
+
+    if (res == 0 && scalar_stats.counters[STAT_QUAD_CALLS] != num_test)
+    {
+        fprintf (report_stream, "## Test Error: Not every equation is counted ##\n\n");
+        res = -1;
+    }
+
+    thread_pool_destroy (pool);
+    free (coeffs);
+    free (n_roots);
+
+    if (res == 0) _REPORT_OK();
+    return res;
+}
+
+///@brief Cubic equation with expected solution, unused roots are zero
+struct cubic_case
+{
+    double a, b, c, d;
+    num_roots n_roots;
+    double x1, x2, x3;
+};
+
+///@brief Sort three values in ascending order
+static void sort3 (double *x1, double *x2, double *x3)
+{
+    assert (x1 != NULL && "pointer can't be null");
+    assert (x2 != NULL && "pointer can't be null");
+    assert (x3 != NULL && "pointer can't be null");
+
+    double tmp = 0;
+
+    if (*x1 > *x2) { tmp = *x1; *x1 = *x2; *x2 = tmp; }
+    if (*x2 > *x3) { tmp = *x2; *x2 = *x3; *x3 = tmp; }
+    if (*x1 > *x2) { tmp = *x1; *x1 = *x2; *x2 = tmp; }
+}
+
+int manual_test_solve_cubic_eq (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    static const cubic_case CASES[] = {
+        {1,  -6,  11,  -6, THREE_ROOTS,  1,  2, 3}, // (x-1)(x-2)(x-3)
+        {2,   0,  -2,   0, THREE_ROOTS, -1,  0, 1},
+        {1,  -4,   5,  -2, TWO_ROOTS,    2,  1, 0}, // (x-2)(x-1)^2, double root is x2
+        {1,   3,   0,  -4, TWO_ROOTS,    1, -2, 0},
+        {1,  -3,   3,  -1, ONE_ROOT,     1,  0, 0}, // Triple root
+        {1,   0,   0,  -8, ONE_ROOT,     2,  0, 0},
+        {1,   0,   1,   0, ONE_ROOT,     0,  0, 0},
+        {1,   0,   1e6, 1, ONE_ROOT, -1e-6,  0, 0}, // Cardano formula cancels here
+
+        // Lower degree
+        {0,   1,  -3,   2, TWO_ROOTS,    2,  1, 0},
+        {0,   0,   2,  -1, ONE_ROOT,   0.5,  0, 0},
+        {0,   0,   0,   1, ZERO_ROOTS,   0,  0, 0},
+        {0,   0,   0,   0, INF_ROOTS,    0,  0, 0},
+
+        {1, 1e300, 1e300, 1, ERANGE_SOLVE, 0, 0, 0},
+    };
+
+    for (const cubic_case &test : CASES)
+    {
+        double x[3]   = {NAN, NAN, NAN};
+        double ref[3] = {test.x1, test.x2, test.x3};
+
+        num_roots n_roots = solve_cubic_eq (test.a, test.b, test.c, test.d, &x[0], &x[1], &x[2]);
+
+        bool ok = n_roots == test.n_roots;
+
+        // Three roots are compared as sets, single and double roots by position
+        if (ok && n_roots == THREE_ROOTS)
+        {
+            sort3 (&x[0], &x[1], &x[2]);
+            sort3 (&ref[0], &ref[1], &ref[2]);
+        }
+
+        // Error relative to the biggest root, so small roots are checked too
+        double scale = fmax (fabs (ref[0]), fmax (fabs (ref[1]), fabs (ref[2])));
+
+        for (int i = 0; ok && i < n_roots; ++i)
+        {
+            ok = fabs (x[i] - ref[i]) <= DBL_ERROR * scale;
+        }
+
+        if (!ok)
+        {
+            fprintf (report_stream, "## Test Error: Wrong solution of cubic equation ##\n");
+            fprintf
+                (
+                report_stream,
+                "Parameters: (%lg, %lg, %lg, %lg), output: (%d, %.17lg, %.17lg, %.17lg), "
+                "reference: (%d, %lg, %lg, %lg)\n\n",
+                test.a, test.b, test.c, test.d, n_roots, x[0], x[1], x[2], test.n_roots, test.x1, test.x2, test.x3
+                );
+
+            return -1;
+        }
+    }
+
+    // Roots at 1e-2 and 1e-4 scale: zero checks scale with roots, small roots keep relative precision
+    static const cubic_case SMALL_CASES[] = {
+        {1, -0.03,    2e-4,   0,     THREE_ROOTS,  0,     0.01, 0.02},
+        {1,  0,      -1e-4,   0,     THREE_ROOTS, -0.01,  0,    0.01},
+        {1, -1.0001,  1e-4,   0,     THREE_ROOTS,  0,     1e-4, 1},    // Roots of very different scale
+        {1, -6e-4,    11e-8, -6e-12, THREE_ROOTS,  1e-4,  2e-4, 3e-4},
+        {1, -0.04,    5e-4,  -2e-6,  TWO_ROOTS,    0.02,  0.01, 0},    // (x-0.02)(x-0.01)^2
+        {1, -3e-4,    3e-8,  -1e-12, ONE_ROOT,     1e-4,  0,    0},    // Triple root
+        {1, -1e-2,    1e-4,  -1e-6,  ONE_ROOT,     1e-2,  0,    0},    // (x-0.01)(x^2+1e-4)
+    };
+
+    for (const cubic_case &test : SMALL_CASES)
+    {
+        double x[3]   = {NAN, NAN, NAN};
+        double y[3]   = {NAN, NAN, NAN};
+        double ref[3] = {test.x1, test.x2, test.x3};
+
+        num_roots n_roots = solve_cubic_eq (test.a, test.b, test.c, test.d, &x[0], &x[1], &x[2]);
+        num_roots n_batch = ERANGE_SOLVE;
+
+        solve_cubic_eq_batch (1, &test.a, &test.b, &test.c, &test.d, &y[0], &y[1], &y[2], &n_batch);
+
+        bool ok = n_roots == test.n_roots && n_batch == n_roots && memcmp (x, y, (size_t) n_roots * sizeof (double)) == 0;
+
+        if (ok && n_roots == THREE_ROOTS)
+        {
+            sort3 (&x[0], &x[1], &x[2]);
+            sort3 (&ref[0], &ref[1], &ref[2]);
+        }
+
+        // Coefficients are rounded, so multiple roots are split by about sqrt (DBL_EPSILON) of their value
+        double rel_error = n_roots == THREE_ROOTS ? 16 * DBL_EPSILON : sqrt (DBL_EPSILON);
+        double scale     = fmax (fabs (ref[0]), fmax (fabs (ref[1]), fabs (ref[2])));
+
+        for (int i = 0; ok && i < n_roots; ++i)
+        {
+            ok = fabs (x[i] - ref[i]) <= rel_error * fabs (ref[i]) + DBL_EPSILON * DBL_EPSILON * scale;
+        }
+
+        if (!ok)
+        {
+            fprintf (report_stream, "## Test Error: Wrong solution of cubic equation with small roots ##\n");
+            fprintf
+                (
+                report_stream,
+                "Parameters: (%lg, %lg, %lg, %lg), output: (%d, %.17lg, %.17lg, %.17lg), batch: %d, "
+                "reference: (%d, %lg, %lg, %lg)\n\n",
+                test.a, test.b, test.c, test.d, n_roots, x[0], x[1], x[2], n_batch,
+                test.n_roots, test.x1, test.x2, test.x3
+                );
+
+            return -1;
+        }
+    }
+
+    _REPORT_OK();
+    return 0;
+}
+
+int auto_test_solve_cubic_eq (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    const int num_test = 100;
+
+    double a[num_test]  = {}, b[num_test]  = {}, c[num_test] = {}, d[num_test] = {};
+    double x1[num_test] = {}, x2[num_test] = {}, x3[num_test] = {};
+    num_roots n_roots[num_test] = {};
+
+    for (int i = 0; i < num_test; ++i)
+    {
+        // a(x - r1)(x - r2)(x - r3) with distinct integer roots or a(x - r1)(x^2 + s) with single real root,
+        // roots are scaled by powers of two about 1e-2 and 1e-4, so coefficients stay exact
+        double k     = rand() % 10 + 1;
+        double scale = i % 3 == 0 ? 1 : i % 3 == 1 ? 1.0 / 128 : 1.0 / 16384;
+        double r1    = (rand() % 21 - 10) * scale;
+        double r2    = (rand() % 21 - 10) * scale;
+        double r3    = (rand() % 21 - 10) * scale;
+
+        if (i % 2 == 0 || same_value (r1, r2) || same_value (r2, r3) || same_value (r1, r3))
+        {
+            double s = rand_range (1, 100) * scale * scale;
+
+            a[i] = k;
+            b[i] = -k * r1;
+            c[i] =  k * s;
+            d[i] = -k * r1 * s;
+        }
+        else
+        {
+            a[i] =  k;
+            b[i] = -k * (r1 + r2 + r3);
+            c[i] =  k * (r1*r2 + r2*r3 + r1*r3);
+            d[i] = -k * r1 * r2 * r3;
+        }
+    }
+
+    // Some equations go through quadratic solver
+    a[0] = 0;
+
+    solve_cubic_eq_batch (num_test, a, b, c, d, x1, x2, x3, n_roots);
+
+    for (int i = 0; i < num_test; ++i)
+    {
+        double y[3] = {NAN, NAN, NAN};
+        num_roots n_roots_ref = solve_cubic_eq (a[i], b[i], c[i], d[i], &y[0], &y[1], &y[2]);
+
+        bool ok = n_roots[i] == n_roots_ref && (i == 0 || n_roots_ref == ONE_ROOT || n_roots_ref == THREE_ROOTS);
+
+        // Roots are integer multiples of scale or zero
+        double scale = i % 3 == 0 ? 1 : i % 3 == 1 ? 1.0 / 128 : 1.0 / 16384;
+
+        for (int j = 0; ok && j < n_roots_ref; ++j)
+        {
+            double x     = y[j];
+            double x_abs = fmax (fabs (x), scale);
+
+            double residual = ((a[i] * x + b[i]) * x + c[i]) * x + d[i];
+            double norm     = ((fabs (a[i]) * x_abs + fabs (b[i])) * x_abs + fabs (c[i])) * x_abs + fabs (d[i]);
+
+            // Every root satisfies the equation, batch result is the same as scalar one
+            ok = fabs (residual) <= DBL_ERROR * norm &&
+                 memcmp (&y[j], j == 0 ? &x1[i] : j == 1 ? &x2[i] : &x3[i], sizeof (double)) == 0;
+        }
+
+        if (!ok)
+        {
+            fprintf (report_stream, "## Test Error: Wrong solution of cubic equation ##\n");
+            fprintf
+                (
+                report_stream,
+                "Parameters: (%lg, %lg, %lg, %lg), solve_cubic_eq: (%d, %lg, %lg, %lg), batch: (%d, %lg, %lg, %lg)\n\n",
+                a[i], b[i], c[i], d[i], n_roots_ref, y[0], y[1], y[2], n_roots[i], x1[i], x2[i], x3[i]
+                );
+
+            return -1;
+        }
+    }
+
+    _REPORT_OK();
+    return 0;
+}
+
+///@brief Quartic equation with expected solution, unused roots are zero
+struct quartic_case
+{
+    double a, b, c, d, e;
+    num_roots n_roots;
+    double x[4];
+};
+
+///@brief Sort n values in ascending order
+static void sort_roots (double x[], int n)
+{
+    assert (x != NULL && "pointer can't be null");
+
+    for (int i = 1; i < n; ++i)
+    {
+        for (int j = i; j > 0 && x[j - 1] > x[j]; --j)
+        {
+            double tmp = x[j];
+            x[j]     = x[j - 1];
+            x[j - 1] = tmp;
+        }
+    }
+}
+
+int manual_test_solve_quartic_eq (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    static const quartic_case CASES[] = {
+        {1, -10, 35, -50,  24, FOUR_ROOTS,  {1, 2, 3, 4}},    // Biquadratic after shift
+        {2,  -2, -14, 2,   12, FOUR_ROOTS,  {-2, -1, 1, 3}},  // Ferrari
+        {1,   0, -5,  0,    4, FOUR_ROOTS,  {-2, -1, 1, 2}},
+        {1,  -3,  3, -3,    2, TWO_ROOTS,   {1, 2, 0, 0}},    // (x-1)(x-2)(x^2+1)
+        {1,   0,  0,  0,   -1, TWO_ROOTS,   {-1, 1, 0, 0}},
+        {1,   0, -2,  0,    1, TWO_ROOTS,   {-1, 1, 0, 0}},   // Double roots
+        {1,  -5,  7, -3,    0, THREE_ROOTS, {0, 1, 3, 0}},    // x(x-1)^2(x-3)
+        {1,  -4,  6, -4,    1, ONE_ROOT,    {1, 0, 0, 0}},    // Quadruple root
+        {1,   0,  0,  0,    1, ZERO_ROOTS,  {0, 0, 0, 0}},
+        {1,   2,  3,  2,    1, ZERO_ROOTS,  {0, 0, 0, 0}},    // (x^2+x+1)^2
+
+        // Lower degree
+        {0,   1, -6, 11,   -6, THREE_ROOTS, {1, 2, 3, 0}},
+        {0,   0,  0,  0,    0, INF_ROOTS,   {0, 0, 0, 0}},
+
+        {1, 1e300, 0, 0,    0, ERANGE_SOLVE, {0, 0, 0, 0}},
+    };
+
+    for (const quartic_case &test : CASES)
+    {
+        double x[4]   = {NAN, NAN, NAN, NAN};
+        double ref[4] = {test.x[0], test.x[1], test.x[2], test.x[3]};
+
+        num_roots n_roots = solve_quartic_eq (test.a, test.b, test.c, test.d, test.e, &x[0], &x[1], &x[2], &x[3]);
+
+        bool ok = n_roots == test.n_roots;
+
+        if (ok && n_roots >= ONE_ROOT)
+        {
+            sort_roots (x,   n_roots);
+            sort_roots (ref, n_roots);
+        }
+
+        for (int i = 0; ok && i < n_roots; ++i)
+        {
+            ok = is_close (x[i], ref[i]);
+        }
+
+        if (!ok)
+        {
+            fprintf (report_stream, "## Test Error: Wrong solution of quartic equation ##\n");
+            fprintf
+                (
+                report_stream,
+                "Parameters: (%lg, %lg, %lg, %lg, %lg), output: (%d, %.17lg, %.17lg, %.17lg, %.17lg), "
+                "reference: (%d, %lg, %lg, %lg, %lg)\n\n",
+                test.a, test.b, test.c, test.d, test.e, n_roots, x[0], x[1], x[2], x[3],
+                test.n_roots, test.x[0], test.x[1], test.x[2], test.x[3]
+                );
+
+            return -1;
+        }
+    }
+
+    // (x - 1)(x - r)(x - 5)(x - 7) with close distinct roots, coefficients are exact. Residual is rounding noise
+    // about DBL_EPSILON * 100 within 1e-9 of the close roots, so they are found with this precision
+    const double r = 1 + 0x1p-20;
+    const double close_roots[4] = {1, r, 5, 7};
+
+    double x[4] = {NAN, NAN, NAN, NAN};
+    num_roots n_roots = solve_quartic_eq (1, -(1 + r) - 12, r + 12 * (1 + r) + 35, -(35 * (1 + r) + 12 * r), 35 * r,
+                                          &x[0], &x[1], &x[2], &x[3]);
+
+    bool ok = n_roots == FOUR_ROOTS;
+
+    if (ok) sort_roots (x, n_roots);
+
+    for (int i = 0; ok && i < n_roots; ++i)
+    {
+        ok = fabs (x[i] - close_roots[i]) < 1e-9;
+    }
+
+    if (!ok)
+    {
+        fprintf (report_stream, "## Test Error: Close distinct roots of quartic equation are merged ##\n");
+        fprintf (report_stream, "Output: (%d, %.17lg, %.17lg, %.17lg, %.17lg), reference: (4, 1, %.17lg, 5, 7)\n\n",
+                 n_roots, x[0], x[1], x[2], x[3], r);
+
+        return -1;
+    }
+
+    _REPORT_OK();
+    return 0;
+}
+
+int auto_test_solve_quartic_eq (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    const int num_test = 100;
+
+    static double a[num_test]  = {}, b[num_test]  = {}, c[num_test] = {}, d[num_test] = {}, e[num_test] = {};
+    static double x1[num_test] = {}, x2[num_test] = {}, x3[num_test] = {}, x4[num_test] = {};
+    static double ref[num_test][4] = {};
+    num_roots n_roots_ref[num_test] = {};
+    num_roots n_roots[num_test] = {};
+
+    for (int i = 0; i < num_test; ++i)
+    {
+        // k(x - r1)(x - r2)(x^2 + s1*x + s0): distinct real roots r1, r2 and two or no roots of the last factor
+        double k  = rand_range (-10, 10);
+        double r1 = rand_range (-10, 0);
+        double r2 = rand_range (1, 10);
+
+        double q1 = -(r1 + r2), q0 = r1 * r2;
+        double s1 = 0, s0 = 0;
+
+        ref[i][0] = r1;
+        ref[i][1] = r2;
+
+        if (i % 2 == 0)
+        {
+            ref[i][2] = rand_range (11, 20);
+            ref[i][3] = rand_range (21, 30);
+
+            s1 = -(ref[i][2] + ref[i][3]);
+            s0 = ref[i][2] * ref[i][3];
+            n_roots_ref[i] = FOUR_ROOTS;
+        }
+        else
+        {
+            s1 = rand_range (-10, 10);
+            s0 = s1 * s1 / 4 + rand_range (1, 10); // Negative discriminant
+            n_roots_ref[i] = TWO_ROOTS;
+        }
+
+        k = fabs (k) < 1 ? 1 : k;
+
+        a[i] = k;
+        b[i] = k * (q1 + s1);
+        c[i] = k * (q0 + q1 * s1 + s0);
+        d[i] = k * (q0 * s1 + q1 * s0);
+        e[i] = k * q0 * s0;
+    }
+
+    solve_quartic_eq_batch (num_test, a, b, c, d, e, x1, x2, x3, x4, n_roots);
+
+    for (int i = 0; i < num_test; ++i)
+    {
+        double x[4] = {NAN, NAN, NAN, NAN};
+        num_roots n_roots_scalar = solve_quartic_eq (a[i], b[i], c[i], d[i], e[i], &x[0], &x[1], &x[2], &x[3]);
+
+        double batch[4] = {x1[i], x2[i], x3[i], x4[i]};
+
+        // Batch result is the same as scalar one
+        bool ok = n_roots_scalar == n_roots_ref[i] && n_roots[i] == n_roots_scalar &&
+                  memcmp (x, batch, (size_t) n_roots_scalar * sizeof (double)) == 0;
+
+        if (ok)
+        {
+            sort_roots (x,      n_roots_scalar);
+            sort_roots (ref[i], n_roots_scalar);
+        }
+
+        // Roots are accurate to rounding of coefficients
+        for (int j = 0; ok && j < n_roots_scalar; ++j)
+        {
+            ok = fabs (x[j] - ref[i][j]) <= 1e-9 * fmax (1, fabs (ref[i][j]));
+        }
+
+        if (!ok)
+        {
+            fprintf (report_stream, "## Test Error: Wrong solution of quartic equation ##\n");
+            fprintf
+                (
+                report_stream,
+                "Parameters: (%lg, %lg, %lg, %lg, %lg), solve_quartic_eq: (%d, %.17lg, %.17lg, %.17lg, %.17lg), "
+                "batch: (%d), reference: (%d, %lg, %lg, %lg, %lg)\n\n",
+                a[i], b[i], c[i], d[i], e[i], n_roots_scalar, x[0], x[1], x[2], x[3], n_roots[i],
+                n_roots_ref[i], ref[i][0], ref[i][1], ref[i][2], ref[i][3]
+                );
+
+            return -1;
+        }
+    }
+
+    _REPORT_OK();
+    return 0;
+}
+
+///@brief Polynomial with known roots, up to degree 10
+struct poly_case
+{
+    int    degree;
+    double coeffs[11];
+    int    status;
+    double re[10];
+    double im[10];
+};
+
+int manual_test_solve_poly_eq (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    static const poly_case CASES[] = {
+        {1, {2, -1},                       0,      {0.5},               {0}},
+        {2, {1, 0, 1},                     0,      {0, 0},              {1, -1}},
+        {3, {1, 0, 0, -1},                 0,      {1, -0.5, -0.5},     {0, 0.8660254037844386, -0.8660254037844386}},
+        {5, {1, 0, -1, 0, 0, 0},           0,      {0, 0, 0, 1, -1},    {0, 0, 0, 0, 0}},  // Zero lowest coefficients
+        {4, {1, -10, 35, -50, 24},         0,      {1, 2, 3, 4},        {0, 0, 0, 0}},
+        {10, {1, -55, 1320, -18150, 157773, -902055, 3416930, -8409500, 12753576, -10628640, 3628800},
+                                           0,      {1, 2, 3, 4, 5, 6, 7, 8, 9, 10}, {}},  // Wilkinson polynomial
+        {0, {5},                           0,      {},                  {}},
+        {2, {0, 1, 1},                     EINVAL, {},                  {}},
+        {2, {1, INFINITY, 1},              ERANGE, {},                  {}},
+    };
+
+    char scratch[1024] alignas (double) = {};
+    assert (poly_scratch_size (10) <= sizeof (scratch) && "scratch is too small");
+
+    for (const poly_case &test : CASES)
+    {
+        double re[10] = {}, im[10] = {};
+        bool   used[10] = {};
+
+        int status = solve_poly_eq (test.degree, test.coeffs, re, im, scratch);
+        bool ok = status == test.status;
+
+        // Every expected root has its own close root
+        for (int i = 0; ok && status == 0 && i < test.degree; ++i)
+        {
+            int nearest = -1;
+
+            for (int j = 0; j < test.degree; ++j)
+            {
+                if (!used[j] && fabs (re[j] - test.re[i]) < 1e-8 && fabs (im[j] - test.im[i]) < 1e-8) nearest = j;
+            }
+
+            ok = nearest >= 0;
+            if (ok) used[nearest] = true;
+        }
+
+        if (!ok)
+        {
+            fprintf (report_stream, "## Test Error: Wrong roots of polynomial ##\n");
+            fprintf (report_stream, "Degree: %d, status: %d, expected: %d, roots:", test.degree, status, test.status);
+
+            for (int i = 0; i < test.degree; ++i) fprintf (report_stream, " (%lg, %lg)", re[i], im[i]);
+
+            fprintf (report_stream, "\n\n");
+            return -1;
+        }
+    }
+
+    _REPORT_OK();
+    return 0;
+}
+
+int auto_test_solve_poly_eq (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    const int num_test = 20;
+    const int degree   = 30;
+
+    static double coeffs[num_test * (degree + 1)] = {};
+    static double re[num_test * degree] = {}, im[num_test * degree] = {};
+    int status[num_test] = {};
+
+    for (int i = 0; i < num_test * (degree + 1); ++i)
+    {
+        coeffs[i] = rand_range (-100, +100);
+    }
+
+    char *scratch = (char *) malloc (poly_scratch_size (degree));
+    assert (scratch != NULL && "Failed to allocate memory");
+
+    int n_failed = solve_poly_eq_batch (num_test, degree, coeffs, re, im, scratch, status);
+
+    for (int i = 0; i < num_test; ++i)
+    {
+        const double *poly = &coeffs[i * (degree + 1)];
+        double x_re[degree] = {}, x_im[degree] = {};
+
+        int  poly_status = solve_poly_eq (degree, poly, x_re, x_im, scratch);
+        bool ok = n_failed == 0 && status[i] == 0 && poly_status == 0 &&
+                  memcmp (x_re, &re[i * degree], sizeof (x_re)) == 0 &&
+                  memcmp (x_im, &im[i * degree], sizeof (x_im)) == 0;
+
+        // Polynomial value is of the order of its rounding error
+        for (int j = 0; ok && j < degree; ++j)
+        {
+            double val_re = poly[0], val_im = 0, bound = fabs (poly[0]);
+            double z_abs  = hypot (x_re[j], x_im[j]);
+
+            for (int k = 1; k <= degree; ++k)
+            {
+                double tmp = val_re * x_re[j] - val_im * x_im[j] + poly[k];
+                val_im     = val_re * x_im[j] + val_im * x_re[j];
+                val_re     = tmp;
+                bound      = bound * z_abs + fabs (poly[k]);
+            }
+
+            ok = hypot (val_re, val_im) <= 1e-12 * bound;
+        }
+
+        if (!ok)
+        {
+            fprintf (report_stream, "## Test Error: Wrong roots of polynomial ##\n");
+            fprintf (report_stream, "Polynomial #%d, status: %d, batch status: %d\n\n", i, poly_status, status[i]);
+
+            free (scratch);
+            return -1;
+        }
+    }
+
+    free (scratch);
+
+    _REPORT_OK();
+    return 0;
+}
+
+int manual_test_parse_double (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    struct
+    {
+        const char *str;
+        int    err_ref;
+        double x_ref;
+        int    len_ref; ///< Number of parsed characters
+    } tests[] =
+    {
+        {"5",            0,       5,         1},
+        {"  -2.5e3",     0,      -2500,      8},
+        {"+0.1",         0,       0.1,       4},
+        {"1,5",          0,       1,         1},
+        {"7me_dio",      0,       7,         1},
+        {"9e999",        ERANGE,  HUGE_VAL,  5},
+        {"-9e999",       ERANGE, -HUGE_VAL,  6},
+        {"1e-400",       ERANGE,  0,         6},
+        {"me_dio",       EINVAL,  0,         0},
+        {"+-5",          EINVAL,  0,         0},
+        {"",             EINVAL,  0,         0},
+    };
+
+    for (size_t i = 0; i < sizeof (tests) / sizeof (tests[0]); ++i)
+    {
+        const char *str  = tests[i].str;
+        const char *stop = NULL;
+        double x = NAN;
+
+        int err = parse_double (str, str + strlen (str), &x, &stop);
+
+        if (err != tests[i].err_ref || (err != EINVAL && memcmp (&x, &tests[i].x_ref, sizeof (x)) != 0) || stop - str != tests[i].len_ref)
+        {
+            fprintf (report_stream, "## Test Error: Wrong parse_double result ##\n");
+            fprintf
+                (
+                report_stream,
+                "Input: \"%s\", output: (err: %d, x: %lg, len: %td), reference: (err: %d, x: %lg, len: %d)\n\n",
+                str, err, x, stop - str, tests[i].err_ref, tests[i].x_ref, tests[i].len_ref
+                );
+
+            return -1;
+        }
+    }
+
+    _REPORT_OK();
+    return 0;
+}
+
+int auto_test_format_solution (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    const int num_test = 100;
+
+    for (int i = 0; i < num_test; ++i)
+    {
+        double roots[2] = {rand_range (-100, +100) * pow (10, rand() % 40 - 20), i % 2 ? 1e-12 : -0.5};
+        double roots_copy[2] = {roots[0], roots[1]};
+
+        char output[MAX_SOLUTION_LEN + 1] = "";
+        char ref[MAX_SOLUTION_LEN + 1]    = "";
+
+        output[format_solution (output, TWO_ROOTS, roots, FORMAT_HUMAN)] = '\0';
+        snprintf (ref, sizeof (ref), "2 solutions: %.3e и %.3e\n", is_zero (roots[0]) ? 0 : roots[0],
+                                                                  is_zero (roots[1]) ? 0 : roots[1]);
+
+        if (strcmp (output, ref) != 0 || memcmp (roots, roots_copy, sizeof (roots)) != 0)
+        {
+            fprintf (report_stream, "## Test Error: Wrong human format ##\n");
+            fprintf (report_stream, "Expected: %sGot: %s\n", ref, output);
+            return -1;
+        }
+
+        size_t len = format_solution (output, TWO_ROOTS, roots, FORMAT_MACHINE);
+        output[len] = '\0';
+
+        const char *pos = output, *end = output + len;
+        double n_roots = NAN, x1 = NAN, x2 = NAN;
+
+        if (parse_double (pos, end, &n_roots, &pos) != 0 || parse_double (pos, end, &x1, &pos) != 0 ||
+            parse_double (pos, end, &x2,      &pos) != 0 || !is_equal (n_roots, TWO_ROOTS)           ||
+            memcmp (&x1, &roots[0], sizeof (x1))  != 0 || memcmp (&x2, &roots[1], sizeof (x2))  != 0)
+        {
+            fprintf (report_stream, "## Test Error: Machine format does not round trip ##\n");
+            fprintf (report_stream, "Roots: %.17g %.17g, output: %s\n", roots[0], roots[1], output);
+            return -1;
+        }
+    }
+
+    _REPORT_OK();
+    return 0;
+}
+
+int manual_test_solve_stream (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    const char input[] =
+        "1 0 -4\n"
+        "1,2,1\n"
+        "# comment\n"
+        "\n"
+        "\t1 ,  1\t, 1\r\n"
+        "me_dio 1 2\n"
+        "9e999 1 2\n"
+        "5abc 1 1\n"
+        "1 2\n"
+        "1 2 3 4\n"
+        "0 0 0\n"
+        "0 228 282"; // No '\n' at the end
+
+    const char output_ref[] =
+        "2 solutions: -2.000e+00 и 2.000e+00\n"
+        "1 solution: -1.000e+00\n"
+        "No solutions\n"
+        "Failed to parse coefficients\n"
+        "Failed to parse coefficients\n"
+        "Failed to parse coefficients\n"
+        "Failed to parse coefficients\n"
+        "Failed to parse coefficients\n"
+        "Infinitive number of roots\n"
+        "1 solution: -1.237e+00\n";
+
+    // Regular file is parsed from mapped memory, pipe is read by blocks
+    for (int use_pipe = 0; use_pipe <= 1; ++use_pipe)
+    {
+        char output[sizeof (output_ref) + 1] = "";
+
+        FILE *in_stream  = NULL;
+        FILE *out_stream = tmpfile ();
+        int   pipe_fds[2] = {-1, -1};
+
+        if (use_pipe)
+        {
+            int pipe_res = pipe (pipe_fds);
+            assert (pipe_res == 0 && "Failed to create pipe");
+
+            ssize_t n_written = write (pipe_fds[1], input, sizeof (input) - 1);
+            assert (n_written == sizeof (input) - 1 && "Input must fit into pipe buffer");
+
+            close (pipe_fds[1]);
+            in_stream = fdopen (pipe_fds[0], "r");
+        }
+        else
+        {
+            in_stream = tmpfile ();
+            fputs (input, in_stream);
+            rewind (in_stream);
+        }
+
+        assert (in_stream != NULL && out_stream != NULL && "Failed to create temporary file");
+
+        batch_opts opts = {};
+        int err = solve_stream (in_stream, out_stream, &opts);
+
+        rewind (out_stream);
+        size_t out_size = fread (output, 1, sizeof (output) - 1, out_stream);
+
+        fclose (in_stream);
+        fclose (out_stream);
+
+        if (err != 0 || out_size != sizeof (output_ref) - 1 || strcmp (output, output_ref) != 0)
+        {
+            fprintf (report_stream, "## Test Error: Wrong stream output ##\n");
+            fprintf (report_stream, "Input: %s, error: %d\nExpected:\n%s\nGot:\n%s\n\n",
+                                    use_pipe ? "pipe" : "file", err, output_ref, output);
+            return -1;
+        }
+    }
+
+    _REPORT_OK();
+    return 0;
+}
+
+int manual_test_batch_errors (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    const char input[] =
+        "1 -3 2\n"
+        "me_dio 1 2\n"
+        "# comment\n"
+        "1e-10 1e300 1\n"
+        "1 2 1\n"
+        "1e-10 -1e300 1\n"
+        "1 2\n";
+
+    FILE *in_stream  = tmpfile ();
+    FILE *out_stream = fopen ("/dev/null", "w");
+
+    assert (in_stream != NULL && out_stream != NULL && "Failed to create temporary file");
+
+    fputs (input, in_stream);
+    rewind (in_stream);
+
+    batch_errors errors = {};
+    batch_opts   opts   = {};
+    opts.errors = &errors;
+
+    int err = solve_stream (in_stream, out_stream, &opts);
+
+    fclose (in_stream);
+    fclose (out_stream);
+
+    // Equations are numbered without comments
+    const batch_errors errors_ref = {6, 4, {2, 0, 2}, {2, 0, 3}};
+
+    if (err != 0 || memcmp (&errors, &errors_ref, sizeof (errors)) != 0)
+    {
+        fprintf (report_stream, "## Test Error: Wrong error summary ##\n");
+        print_batch_errors (&errors, report_stream);
+        fprintf (report_stream, "\n");
+        return -1;
+    }
+
+    // Not finite coefficients of binary input are out of range too
+    const double a[] = {1, INFINITY, 1e-10};
+    const double b[] = {2, 1,        1e300};
+    const double c[] = {1, 1,        1};
+
+    double    x1[3] = {}, x2[3] = {};
+    num_roots n_roots[3] = {};
+    uint8_t   status[3]  = {};
+
+    solve_quad_eq_batch (3, a, b, c, x1, x2, n_roots);
+    eq_status_fill (3, a, b, c, NULL, n_roots, NULL, status);
+
+    const uint8_t status_ref[] = {EQ_OK, EQ_NOT_FINITE | EQ_OUT_OF_RANGE, EQ_OUT_OF_RANGE};
+
+    if (memcmp (status, status_ref, sizeof (status)) != 0)
+    {
+        fprintf (report_stream, "## Test Error: Wrong equation status ##\n");
+        fprintf (report_stream, "Status: %d %d %d, expected: %d %d %d\n\n", status[0], status[1], status[2],
+                 status_ref[0], status_ref[1], status_ref[2]);
+        return -1;
+    }
+
+    _REPORT_OK();
+    return 0;
+}
+
+/**
+ * @brief Read whole stream from begin to null-terminated buffer
+ *
+ * @return Number of bytes read
+ */
+static size_t read_back (FILE *stream, char *buffer, size_t size)
+{
+    assert (stream != NULL && "pointer can't be null");
+    assert (buffer != NULL && "pointer can't be null");
+
+    rewind (stream);
+    size_t n_read = fread (buffer, 1, size - 1, stream);
+    buffer[n_read] = '\0';
+    rewind (stream);
+
+    return n_read;
+}
+
+int manual_test_bin_io (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    const char input[] =
+        "# a b c n_roots x1 x2\n"
+        "1 0 -4 2 -2 2\n"
+        "1,2,1\n"
+        "\n"
+        "0 0 0 -1\n"
+        "0 228 282";
+
+    const char lin_input[] =
+        "# k b n_roots x\n"
+        "2 -4 1 2\n";
+
+    const char coeffs_ref[]  = "1 0 -4\n1 2 1\n0 0 0\n0 228 282\n";
+    const char lin_ref[]     = "0 2 -4\n";
+    const char solution_ref[] = "2 -2 2\n1 -1\n-1\n1 -1.236842105263158\n";
+
+    char  output[256] = "";
+    FILE *text_stream = tmpfile ();
+    FILE *bin_stream  = tmpfile ();
+    FILE *root_stream = tmpfile ();
+    FILE *out_stream  = tmpfile ();
+
+    assert (text_stream != NULL && bin_stream != NULL && root_stream != NULL && out_stream != NULL &&
+            "Failed to create temporary file");
+
+    fputs (input, text_stream);
+    rewind (text_stream);
+
+    size_t n_lines = 0;
+    int    err     = text_to_bin (text_stream, bin_stream, 3, &n_lines);
+    bin_header header = {};
+
+    rewind (bin_stream);
+    size_t n_read = fread (&header, sizeof (header), 1, bin_stream);
+    rewind (bin_stream);
+
+    if (err != 0 || n_lines != 4 || n_read != 1 || memcmp (header.magic, QUAD_BIN_MAGIC, 4) != 0 ||
+        header.version != QUAD_BIN_VERSION || header.precision != sizeof (double) ||
+        header.kind != BIN_COEFFS || header.count != 4)
+    {
+        fprintf (report_stream, "## Test Error: Wrong binary header, error: %d, lines: %zu ##\n", err, n_lines);
+        return -1;
+    }
+
+    // Binary coefficients are converted back exactly, solutions match text mode
+    err = bin_to_text (bin_stream, out_stream, FORMAT_MACHINE);
+    read_back (out_stream, output, sizeof (output));
+
+    if (err != 0 || strcmp (output, coeffs_ref) != 0)
+    {
+        fprintf (report_stream, "## Test Error: Wrong coefficients from binary ##\n");
+        fprintf (report_stream, "Error: %d\nExpected:\n%s\nGot:\n%s\n\n", err, coeffs_ref, output);
+        return -1;
+    }
+
+    batch_opts opts = {};
+    opts.format = FORMAT_MACHINE;
+
+    rewind (bin_stream);
+    fclose (out_stream);
+    out_stream = tmpfile ();
+
+    err = solve_bin (bin_stream, root_stream, true, &opts);
+    rewind (root_stream);
+    if (err == 0) err = bin_to_text (root_stream, out_stream, FORMAT_MACHINE);
+    read_back (out_stream, output, sizeof (output));
+
+    if (err != 0 || strcmp (output, solution_ref) != 0)
+    {
+        fprintf (report_stream, "## Test Error: Wrong solutions from binary ##\n");
+        fprintf (report_stream, "Error: %d\nExpected:\n%s\nGot:\n%s\n\n", err, solution_ref, output);
+        return -1;
+    }
+
+    // Linear equations k b are converted to 0 k b
+    fclose (text_stream);
+    fclose (bin_stream);
+    fclose (out_stream);
+
+    text_stream = tmpfile ();
+    bin_stream  = tmpfile ();
+    out_stream  = tmpfile ();
+
+    fputs (lin_input, text_stream);
+    rewind (text_stream);
+
+    err = text_to_bin (text_stream, bin_stream, 2, NULL);
+    rewind (bin_stream);
+    if (err == 0) err = bin_to_text (bin_stream, out_stream, FORMAT_MACHINE);
+    read_back (out_stream, output, sizeof (output));
+
+    if (err != 0 || strcmp (output, lin_ref) != 0)
+    {
+        fprintf (report_stream, "## Test Error: Wrong linear coefficients from binary ##\n");
+        fprintf (report_stream, "Error: %d\nExpected:\n%s\nGot:\n%s\n\n", err, lin_ref, output);
+        return -1;
+    }
+
+    // Text and truncated files are rejected, solutions can't be solved
+    rewind (text_stream);
+    int text_err = solve_bin (text_stream, out_stream, false, &opts);
+
+    rewind (root_stream);
+    int root_err = solve_bin (root_stream, out_stream, false, &opts);
+
+    rewind (bin_stream);
+    ftruncate (fileno (bin_stream), sizeof (bin_header) + 8);
+    int trunc_err = solve_bin (bin_stream, out_stream, false, &opts);
+
+    fclose (text_stream);
+    fclose (bin_stream);
+    fclose (root_stream);
+    fclose (out_stream);
+
+    if (text_err != EINVAL || root_err != EINVAL || trunc_err != EINVAL)
+    {
+        fprintf (report_stream, "## Test Error: Bad binary input accepted ##\n");
+        fprintf (report_stream, "Errors: text %d, solutions %d, truncated %d\n\n", text_err, root_err, trunc_err);
+        return -1;
+    }
+
+    _REPORT_OK();
+    return 0;
+}
+
+int auto_test_ring_queue (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    const int    n_producers = 4;
+    const int    n_consumers = 4;
+    const size_t n_elems     = 100000; // Per producer
+
+    // Queue is much smaller than number of elements, so producers wait for consumers
+    ring_queue *queue = ring_queue_create (8);
+    assert (queue != NULL && "Failed to allocate memory");
+
+    std::atomic<size_t> sum     {0};
+    std::atomic<size_t> n_taken {0};
+    std::atomic<int>    n_wrong {0};
+
+    std::thread producers[n_producers];
+    std::thread consumers[n_consumers];
+
+    for (int i = 0; i < n_consumers; ++i)
+    {
+        consumers[i] = std::thread ([&]
+        {
+            // Elements of one producer come in order of pushing
+            size_t last[n_producers] = {};
+            void  *elem = NULL;
+
+            while ((elem = ring_queue_pop (queue)) != NULL)
+            {
+                size_t value    = (size_t) elem;
+                size_t producer = value % n_producers;
+
+                if (value / n_producers <= last[producer]) n_wrong++;
+
+                last[producer] = value / n_producers;
+                sum += value;
+                n_taken++;
+            }
+        });
+    }
+
+    for (int i = 0; i < n_producers; ++i)
+    {
+        producers[i] = std::thread ([&, i]
+        {
+            for (size_t j = 1; j <= n_elems; ++j) ring_queue_push (queue, (void *) (j * n_producers + (size_t) i));
+        });
+    }
+
+    for (std::thread &producer : producers) producer.join ();
+
+    ring_queue_close (queue);
+
+    for (std::thread &consumer : consumers) consumer.join ();
+
+    size_t n_total = n_elems * n_producers;
+    size_t sum_ref = n_producers * n_producers * n_elems * (n_elems + 1) / 2 + n_elems * n_producers * (n_producers - 1) / 2;
+
+    bool empty = ring_queue_try_pop (queue) == NULL;
+
+    ring_queue_destroy (queue);
+
+    if (n_taken != n_total || sum != sum_ref || n_wrong != 0 || !empty)
+    {
+        fprintf (report_stream, "## Test Error: Elements of ring queue are lost, duplicated or reordered ##\n");
+        fprintf (report_stream, "Taken: %zu of %zu, sum: %zu, expected %zu, out of order: %d\n\n",
+                                n_taken.load (), n_total, sum.load (), sum_ref, n_wrong.load ());
+        return -1;
+    }
+
+    _REPORT_OK();
+    return 0;
+}
+
+/**
+ * @brief Read whole stream into allocated null-terminated buffer
+ *
+ * @return Buffer, it must be freed
+ */
+static char *read_all (FILE *stream, size_t *size)
+{
+    assert (stream != NULL && "pointer can't be null");
+    assert (size   != NULL && "pointer can't be null");
+
+    fseek (stream, 0, SEEK_END);
+    *size = (size_t) ftell (stream);
+    rewind (stream);
+
+    char *buffer = (char *) calloc (*size + 1, 1);
+    assert (buffer != NULL && "Failed to allocate memory");
+
+    size_t n_read = fread (buffer, 1, *size, stream);
+    assert (n_read == *size && "Failed to read stream");
+
+    return buffer;
+}
+
+int auto_test_solve_stream_pipelined (FILE *report_stream)
+{
+    assert (report_stream != NULL && "pointer can't be NULL");
+
+    const size_t num_test = 100003; // Several blocks of pipeline
+
+    // Input with comments, empty and bad lines and without '\n' at the end
+    FILE *in_stream = tmpfile ();
+    assert (in_stream != NULL && "Failed to create temporary file");
+
+    for (size_t i = 0; i < num_test; ++i)
+    {
+        double a = 0, b = 0, c = 0;
+        rand_quad_coeffs (&a, &b, &c);
+
+        switch (rand () % 16)
+        {
+            case 0:  fputs ("# comment\n", in_stream); break;
+            case 1:  fputs ("\n", in_stream);          break;
+            case 2:  fputs ("1 2 garbage\n", in_stream); break;
+            case 3:  fprintf (in_stream, "%.17g 1e300 %.17g\n", a * 1e-10, c); break;
+            default: fprintf (in_stream, "%.17g, %.17g\t%.17g\n", a, b, c); break;
+        }
+    }
+
+    fputs ("1 -3 2", in_stream);
+    fflush (in_stream);
+
+    size_t in_size = 0;
+    char  *input   = read_all (in_stream, &in_size);
+
+    batch_opts opts = {};
+    opts.format = FORMAT_MACHINE;
+
+    batch_errors errors_ref = {};
+    opts.errors = &errors_ref;
+
+    FILE *ref_stream = tmpfile ();
+    assert (ref_stream != NULL && "Failed to create temporary file");
+
+    rewind (in_stream);
+    int err = solve_stream (in_stream, ref_stream, &opts);
+    assert (err == 0 && "Failed to solve stream");
+
+    size_t ref_size = 0;
+    char  *output_ref = read_all (ref_stream, &ref_size);
+    fclose (ref_stream);
+
+    // The least memory and one worker per stage make stages wait for each other, many workers reorder blocks
+    const int    n_threads[]  = {2, 2, 7};
+    const size_t mem_limits[] = {pipeline_min_mem (), PIPELINE_DEFAULT_MEM, PIPELINE_DEFAULT_MEM};
+
+    int res = 0;
+
+    for (size_t test = 0; test < sizeof (n_threads) / sizeof (n_threads[0]) && res == 0; ++test)
+    {
+        // Regular file is cut in mapped memory, pipe is read by blocks
+        for (int use_pipe = 0; use_pipe <= 1 && res == 0; ++use_pipe)
+        {
+            pipeline_opts popts = {};
+            pipeline_opts_init (&popts, n_threads[test], mem_limits[test]);
+
+            batch_errors errors = {};
+            opts.errors = &errors;
+
+            FILE *out_stream   = tmpfile ();
+            FILE *pipe_stream  = NULL;
+            int   pipe_fds[2]  = {-1, -1};
+            std::thread feeder = {};
+
+            assert (out_stream != NULL && "Failed to create temporary file");
+
+            if (use_pipe)
+            {
+                int pipe_res = pipe (pipe_fds);
+                assert (pipe_res == 0 && "Failed to create pipe");
+
+                feeder = std::thread ([&]
+                {
+                    ssize_t n_written = write (pipe_fds[1], input, in_size);
+                    assert ((size_t) n_written == in_size && "Failed to write pipe");
+                    close (pipe_fds[1]);
+                });
+
+                pipe_stream = fdopen (pipe_fds[0], "r");
+                assert (pipe_stream != NULL && "Failed to open pipe");
+
+                err = solve_stream_pipelined (pipe_stream, out_stream, &opts, &popts);
+
+                feeder.join ();
+                fclose (pipe_stream);
+            }
+            else
+            {
+                rewind (in_stream);
+                err = solve_stream_pipelined (in_stream, out_stream, &opts, &popts);
+            }
+
+            size_t out_size = 0;
+            char  *output   = read_all (out_stream, &out_size);
+            fclose (out_stream);
+
+            if (err != 0 || out_size != ref_size || memcmp (output, output_ref, ref_size) != 0 ||
+                memcmp (&errors, &errors_ref, sizeof (errors)) != 0)
+            {
+                fprintf (report_stream, "## Test Error: Pipelined output differs from solve_stream ##\n");
+                fprintf (report_stream, "Input: %s, threads: %d, memory: %zu, error: %d, size: %zu, expected %zu, "
+                                        "errors: %zu, expected %zu\n\n", use_pipe ? "pipe" : "file", n_threads[test],
+                                        mem_limits[test], err, out_size, ref_size, errors.n_errors, errors_ref.n_errors);
+                res = -1;
+            }
+
+            free (output);
+        }
+    }
+
+    // Line longer than block buffer is rejected, memory limit below two blocks too
+    if (res == 0)
+    {
+        pipeline_opts popts = {};
+        pipeline_opts_init (&popts, 2, pipeline_min_mem ());
+
+        opts.errors = NULL;
+
+        FILE *long_stream = tmpfile ();
+        FILE *out_stream  = fopen ("/dev/null", "w");
+        int   pipe_fds[2] = {-1, -1};
+
+        assert (long_stream != NULL && out_stream != NULL && "Failed to create temporary file");
+
+        for (int i = 0; i < 600000; ++i) fputs ("1 ", long_stream);
+        fputs ("1\n", long_stream);
+        fflush (long_stream);
+
+        size_t long_size  = 0;
+        char  *long_input = read_all (long_stream, &long_size);
+
+        int pipe_res = pipe (pipe_fds);
+        assert (pipe_res == 0 && "Failed to create pipe");
+
+        // Reader stops at the long line, the rest of it is written to closed pipe
+        void (*old_handler) (int) = signal (SIGPIPE, SIG_IGN);
+
+        std::thread feeder ([&]
+        {
+            ssize_t n_written = write (pipe_fds[1], long_input, long_size);
+            (void) n_written;
+            close (pipe_fds[1]);
+        });
+
+        FILE *pipe_stream = fdopen (pipe_fds[0], "r");
+        assert (pipe_stream != NULL && "Failed to open pipe");
+
+        int long_err = solve_stream_pipelined (pipe_stream, out_stream, &opts, &popts);
+        fclose (pipe_stream);
+        feeder.join ();
+
+        signal (SIGPIPE, old_handler);
+
+        popts.mem_limit = 1 << 20;
+
+        rewind (in_stream);
+        int mem_err = solve_stream_pipelined (in_stream, out_stream, &opts, &popts);
+
+        fclose (long_stream);
+        fclose (out_stream);
+        free (long_input);
+
+        if (long_err != EINVAL || mem_err != EINVAL)
+        {
+            fprintf (report_stream, "## Test Error: Too long line or too low memory limit accepted ##\n");
+            fprintf (report_stream, "Errors: long line %d, memory limit %d\n\n", long_err, mem_err);
+            res = -1;
+        }
+    }
+
+    fclose (in_stream);
+    free (input);
+    free (output_ref);
+
+    if (res == 0) _REPORT_OK();
+    return res;
+}
+
+int auto_test_input_coeffs (const char *tmp_file, FILE *dev_null, FILE *report_stream)
+{
+    assert (tmp_file      != NULL && "pointer can't be null");
+    assert (dev_null      != NULL && "pointer can't be null");
+    assert (report_stream != NULL && "pointer can't be null");
+
+    FILE *read_s  = fopen (tmp_file, "r");
+    FILE *write_s = fopen (tmp_file, "w");
+
+    const int num_coeffs = 3;
+    const int num_test = 100;
+    double inp_coeffs[num_coeffs] = {}; // Values from input_coeffs
+    double ref_coeffs[num_coeffs] = {}; // Reference values
+
+    for (int n = 0; n < num_test; ++n)
+    {
+        for (int j = 0; j < num_coeffs; ++j)
+        {
+            ref_coeffs[j] = rand_range (-100, 100);
+            fprintf (write_s, "%.18lf\nadsjkfhakjlhgljak\n9e999\n", ref_coeffs[j]);
+        }
+
+        fflush (write_s);
+
+        if (input_coeffs (num_coeffs, inp_coeffs, read_s, dev_null) != 0)
+        {
+            fprintf (report_stream, "## Test Error: Wrong input ##\n");
+            fprintf (report_stream, "Failed to read input string with vals\n");
+
+            for (int j = 0; j < num_coeffs; ++j) 
+            {
+                fprintf (report_stream, "Val #%d: %lg\n", j, ref_coeffs[j]);
+            }
+
+            putc ('\n', report_stream);
+
+            return -1;
+        }
+
+
+        for (int j = 0; j < num_coeffs; ++j)
+        {
+            if (!is_equal (inp_coeffs[j], ref_coeffs[j]))
+            {
+                fprintf (report_stream, "## Test Error: Wrong input ##\n");
+                fprintf (report_stream, "Invalid value #%d: expected %lg, got %lg\n\n", j, ref_coeffs[j], inp_coeffs[j]);
+
+                return -1;
+            }
+        }
+    }
+
+    fclose (read_s);
+    fclose (write_s);
+
+    _REPORT_OK();
+    return 0;
+}
+
+void run_test(const char *tmp_file, const char *input_file, const char *lin_file, const char *quad_file,
+              const char *output_ref_file, const char *dev_null, const char *report_file)
+{
+    assert (tmp_file        != NULL && "pointer can't be null");
+    assert (input_file      != NULL && "pointer can't be null");
+    assert (quad_file       != NULL && "pointer can't be null");
+    assert (output_ref_file != NULL && "pointer can't be null");
+    assert (dev_null        != NULL && "pointer can't be null");
+
+    FILE *in_stream       = fopen (input_file,      "r");
+    FILE *quad_stream     = fopen (quad_file,       "r");
+    FILE *lin_stream      = fopen (lin_file,        "r");
+    FILE *ref_stream      = fopen (output_ref_file, "r");
+    FILE *dev_null_stream = fopen (dev_null,        "w");
+    FILE *report_stream   = NULL;
+
+    if (report_file != NULL) report_stream  = fopen (report_file, "w");
+    else                     report_stream  = stdout;
+ 
+    unsigned int success = 0;
+    unsigned int failed  = 0;
+
+    #define _LOG_TEST(test)                                             \
+    {                                                                   \
+        if (test)                                                       \
+        {                                                               \
+            fprintf (report_stream, " ### TEST FAILED: %s\n\n", #test);  \
+            failed++;                                                   \
+        }                                                               \
+        else                                                            \
+        {                                                               \
+            success++;                                                  \
+        }                                                               \
+    }                   
+
+    fprintf (report_stream, "=== === Tests running... === ===\n");
+
+    _LOG_TEST (manual_test_solve_lin_eq  (lin_stream,  report_stream));
+    _LOG_TEST (manual_test_solve_quad_eq (quad_stream, report_stream));
+    _LOG_TEST (manual_test_solve_const   (report_stream));
+
+    fseek (in_stream, 0, SEEK_SET);
+
+    _LOG_TEST (manual_test_input_coeffs  (in_stream, dev_null_stream, report_stream));
+    _LOG_TEST (manual_test_output_format (tmp_file, ref_stream, report_stream));
+
+    _LOG_TEST (manual_test_parse_double  (report_stream));
+    _LOG_TEST (manual_test_solve_stream  (report_stream));
+    _LOG_TEST (manual_test_batch_errors  (report_stream));
+    _LOG_TEST (manual_test_bin_io        (report_stream));
+    _LOG_TEST (auto_test_ring_queue      (report_stream));
+    _LOG_TEST (auto_test_solve_stream_pipelined (report_stream));
+    _LOG_TEST (auto_test_format_solution (report_stream));
+
+    _LOG_TEST (auto_test_solve_lin_eq  (report_stream));
+    _LOG_TEST (auto_test_solve_quad_eq (report_stream));
+    _LOG_TEST (auto_test_solve_quad_eq_batch (report_stream));
+    _LOG_TEST (auto_test_solve_quad_eq_batch_parallel (report_stream));
+    _LOG_TEST (auto_test_solve_quad_eq_branchless (report_stream));
+    _LOG_TEST (manual_test_solve_quad_eq_precision (report_stream));
+    _LOG_TEST (auto_test_solve_quad_eq_batch_f (report_stream));
+    _LOG_TEST (manual_test_solve_quad_eq_complex (report_stream));
+    _LOG_TEST (auto_test_solve_quad_eq_batch_complex (report_stream));
+    _LOG_TEST (manual_test_polish_quad_roots (report_stream));
+    _LOG_TEST (auto_test_polish_quad_eq_batch (report_stream));
+    _LOG_TEST (manual_test_solve_quad_eq_accurate (report_stream));
+    _LOG_TEST (auto_test_solve_quad_eq_accurate (report_stream));
+    _LOG_TEST (auto_test_solution_cache (report_stream));
+    _LOG_TEST (auto_test_solver_stats (report_stream));
+    _LOG_TEST (auto_test_serve (report_stream));
+    _LOG_TEST (auto_test_prop_harness (report_stream));
+    _LOG_TEST (manual_test_solve_cubic_eq (report_stream));
+    _LOG_TEST (auto_test_solve_cubic_eq (report_stream));
+    _LOG_TEST (manual_test_solve_quartic_eq (report_stream));
+    _LOG_TEST (auto_test_solve_quartic_eq (report_stream));
+    _LOG_TEST (manual_test_solve_poly_eq (report_stream));
+    _LOG_TEST (auto_test_solve_poly_eq (report_stream));
+    _LOG_TEST (auto_test_input_coeffs  (tmp_file, dev_null_stream, report_stream));
+
+    fprintf (report_stream, "\n==========================================\n");
+    fprintf (report_stream, "Tests: All: %u Failed: %u Passed: %u Success ratio: %3.1f%%\n",
+            success+failed, failed, success, success * 100.0 / (failed + success));
+
+    #undef _LOG_TEST
+}
+
+/**
+ * Generate random value in [min, max] range
+ */
+static double rand_range (double min, double max)
+{
+    double range = (max - min);
+    return min + ((double) rand() / RAND_MAX) * range;
+}
+
+/**
+ * Generate random quadratic equation coefficients, covering every branch of solve_quad_eq:
+ * linear equations, zero discriminant, zero b or c, negative discriminant, big values and overflowing roots
+ */
+static void rand_quad_coeffs (double *a, double *b, double *c)
+{
+    assert (a != NULL && "pointer can't be null");
+    assert (b != NULL && "pointer can't be null");
+    assert (c != NULL && "pointer can't be null");
+
+    *a = rand_range (-100, +100);
+    *b = rand_range (-100, +100);
+    *c = rand_range (-100, +100);
+
+    switch (rand() % 8)
+    {
+        case 0: // Linear
+            *a = 0;
+            if (rand() % 2) *b = 0;
+            if (rand() % 2) *c = 0;
+            break;
+
+        case 1: // Zero discriminant: a(x - r)^2 with exact integer values
+            *a = rand() % 21 - 10;
+            *c = rand() % 21 - 10;
+            *b = -2 * (*a) * (*c);
+            *c = (*a) * (*c) * (*c);
+            break;
+
+        case 2:
+            *b = 0;
+            break;
+
+        case 3:
+            *c = 0;
+            break;
+
+        case 4: // Solved with scaling, roots may overflow
+            *b = DBL_MAX / rand_range (1, 100);
+            break;
+
+        case 5: // Big coefficients with representable roots
+            *a *= DBL_MAX / 100;
+            *b *= DBL_MAX / 100;
+            *c *= DBL_MAX / 100;
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+ * Compare x with y, taking into account floating point error
+ */
+static int is_equal (double x, double y)
+{
+    return is_zero (x - y);
+}
+
+/**
+ * @brief      Compare {x1, x2} to {y1, y2}, taking into account floating point error
+ *
+ * @return     True if equal set, False otherwise.
+ */
+static int is_equal_set (double x1, double x2, double y1, double y2)
+{
+    return  (is_equal (x1, y1) && is_equal (x2, y2)) ||
+            (is_equal (x1, y2) && is_equal (x2, y1));
+}
+
+/**
+ * Compare x with y with relative error for big values and absolute error for small ones
+ */
+static int is_close (double x, double y)
+{
+    return fabs (x - y) <= DBL_ERROR * fmax (1, fabs (y));
 }
 
 #undef _UNWRAP
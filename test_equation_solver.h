@@ -38,6 +38,12 @@ int manual_test_solve_lin_eq  (FILE *in_stream, FILE *report_stream);
  */
 int manual_test_solve_quad_eq (FILE *in_stream, FILE *report_stream);
 
+/// @brief Compare solutions of quad.txt and lin.txt cases, calculated at compile time by solve_quad_eq_const
+///        (they are checked by static_assert), with solutions of solve_quad_eq (must be bitwise equal)
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int manual_test_solve_const (FILE *report_stream);
+
 ///@param in_stream Stream with sample input
 ///@param dev_null /dev/null stream
 ///@param  report_stream  The stream to write report to
@@ -62,6 +68,153 @@ int auto_test_solve_lin_eq  (FILE *report_stream);
 /// @return Non-zero value if test failed
 int auto_test_solve_quad_eq (FILE *report_stream);
 
+/// @brief Compare solve_quad_eq_batch with solve_quad_eq on random equations of all classes for every supported ISA
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int auto_test_solve_quad_eq_batch (FILE *report_stream);
+
+/// @brief Compare solve_quad_eq_batch_parallel with solve_quad_eq_batch, results must be bitwise equal
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int auto_test_solve_quad_eq_batch_parallel (FILE *report_stream);
+
+/// @brief Compare solve_quad_eq_branchless with solve_quad_eq (same number of roots, close roots)
+///        and solve_quad_eq_batch_branchless with solve_quad_eq_branchless (bitwise equal)
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int auto_test_solve_quad_eq_branchless (FILE *report_stream);
+
+/// @brief Solve the same equations with float, double, long double and __float128 solvers,
+///        check per type tolerance (near double root is one root for float only) and scaling of big coefficients
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int manual_test_solve_quad_eq_precision (FILE *report_stream);
+
+/// @brief Compare solve_quad_eq_batch_f with solve_quad_eq_f, including equations solved by fixup
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int auto_test_solve_quad_eq_batch_f (FILE *report_stream);
+
+/// @brief Test solve_quad_eq_complex with known complex, real roots and format of complex roots
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int manual_test_solve_quad_eq_complex (FILE *report_stream);
+
+/// @brief Compare sequential and parallel complex batch solvers of every mode with solve_quad_eq_complex
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int auto_test_solve_quad_eq_batch_complex (FILE *report_stream);
+
+/// @brief Test polish_quad_roots on roots with cancellation and on roots, which must not change
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int manual_test_polish_quad_roots (FILE *report_stream);
+
+/// @brief Polish nearly double roots by batch, compare with polish_quad_roots and quad precision roots
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int auto_test_polish_quad_eq_batch (FILE *report_stream);
+
+/// @brief Test solve_quad_eq_accurate on nearly double roots of any scale and on cases misclassified by solve_quad_eq
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int manual_test_solve_quad_eq_accurate (FILE *report_stream);
+
+/// @brief Compare number of roots of accurate solver with sign of exact discriminant and its roots with quad precision ones
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int auto_test_solve_quad_eq_accurate (FILE *report_stream);
+
+/// @brief Solve repeated equations with small and big cache, sequentially and in parallel, compare solutions
+///        with solve_quad_eq_batch and check hit, miss and eviction counters
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int auto_test_solution_cache (FILE *report_stream);
+
+/// @brief Test solver branch counters: known branches of solve_quad_eq, batch and parallel counters equal scalar ones
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int auto_test_solver_stats (FILE *report_stream);
+
+/// @brief Run solver daemon, send pipelined requests of several clients and compare responses with
+///        solve_quad_eq_batch, check that bad request closes the connection
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int auto_test_serve (FILE *report_stream);
+
+/// @brief Test property-based harness: stats of known equations, the same report with and without threads,
+///        ULP bounds of accurate and polished solvers
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int auto_test_prop_harness (FILE *report_stream);
+
+/// @brief Test solve_cubic_eq with known roots: three, single and double, triple, lower degree and out of range
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int manual_test_solve_cubic_eq (FILE *report_stream);
+
+/// @brief Test solve_cubic_eq on random equations with known roots and compare solve_cubic_eq_batch with it
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int auto_test_solve_cubic_eq (FILE *report_stream);
+
+/// @brief Test solve_quartic_eq with known roots: four, two, multiple, no real roots, lower degree and out of range
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int manual_test_solve_quartic_eq (FILE *report_stream);
+
+/// @brief Test accuracy of solve_quartic_eq on random equations with known roots and compare batch solver with it
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int auto_test_solve_quartic_eq (FILE *report_stream);
+
+/// @brief Test solve_poly_eq on polynomials with known roots, zero lowest coefficients and invalid coefficients
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int manual_test_solve_poly_eq (FILE *report_stream);
+
+/// @brief Test residuals of solve_poly_eq roots of random polynomials and compare solve_poly_eq_batch with it
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int auto_test_solve_poly_eq (FILE *report_stream);
+
+/// @brief Test parse_double on valid numbers, garbage and out of range values
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int manual_test_parse_double (FILE *report_stream);
+
+/// @brief Compare format_solution human format with printf("%.3e"), check that machine format round trips exactly
+/// and that roots are not modified
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int auto_test_format_solution (FILE *report_stream);
+
+/// @brief Run solve_stream on sample input with all kinds of lines from file and from pipe and compare output with sample
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int manual_test_solve_stream (FILE *report_stream);
+
+/// @brief Test status of equations and error summary of solve_stream: parse errors, out of range and not finite ones
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int manual_test_batch_errors (FILE *report_stream);
+
+/// @brief Convert sample text to binary and back, solve binary file, check that bad binary files are rejected
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int manual_test_bin_io (FILE *report_stream);
+
+/// @brief Push and pop elements of ring queue from several threads, check that none is lost, duplicated or reordered
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int auto_test_ring_queue (FILE *report_stream);
+
+/// @brief Compare output and errors of solve_stream_pipelined with solve_stream on file and pipe with different
+///        numbers of workers and memory limits, check that too long lines and too low limit are rejected
+/// @param  report_stream  The stream to write report to
+/// @return Non-zero value if test failed
+int auto_test_solve_stream_pipelined (FILE *report_stream);
+
 /// @param tmp_file Temporary file
 /// @param dev_null /dev/null stream
 /// @param report_stream  The stream to write report to
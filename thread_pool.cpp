@@ -0,0 +1,226 @@
+#include <cassert>
+#include <new>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include "thread_pool.h"
+
+///@brief Range of chunks owned by worker. Owner takes chunks from begin, thieves take from end
+struct alignas(CACHE_LINE_SIZE) worker_queue
+{
+    std::mutex lock {};
+    size_t begin = 0;
+    size_t end   = 0;
+};
+
+struct thread_pool
+{
+    int n_threads = 0;
+
+    std::thread  *threads = NULL;
+    worker_queue *queues  = NULL;
+
+    std::mutex lock {};
+    std::condition_variable start_cond {};
+    std::condition_variable done_cond  {};
+
+    unsigned long generation = 0; ///< Incremented on every thread_pool_run
+    int  n_busy = 0;              ///< Number of started threads which have not finished current run
+    bool stop   = false;
+
+    chunk_func_t func = NULL;
+    void        *arg  = NULL;
+};
+
+static void worker_run    (thread_pool *pool, int thread_id);
+static void worker_main   (thread_pool *pool, int thread_id);
+static bool worker_steal  (thread_pool *pool, int thread_id);
+
+struct thread_pool *thread_pool_create (int n_threads)
+{
+    assert (n_threads >= 0 && "number of threads can't be negative");
+
+    if (n_threads == 0)
+    {
+        n_threads = (int) std::thread::hardware_concurrency ();
+        if (n_threads == 0) n_threads = 1;
+    }
+
+    thread_pool *pool = new (std::nothrow) thread_pool;
+    if (pool == NULL) return NULL;
+
+    pool->n_threads = n_threads;
+    pool->queues    = new (std::nothrow) worker_queue[n_threads];
+    pool->threads   = new (std::nothrow) std::thread[n_threads];
+
+    if (pool->queues == NULL || pool->threads == NULL)
+    {
+        thread_pool_destroy (pool);
+        return NULL;
+    }
+
+    // Worker 0 is calling thread
+    for (int i = 1; i < n_threads; ++i)
+    {
+        pool->threads[i] = std::thread (worker_main, pool, i);
+    }
+
+    return pool;
+}
+
+void thread_pool_destroy (struct thread_pool *pool)
+{
+    if (pool == NULL) return;
+
+    {
+        std::lock_guard<std::mutex> guard (pool->lock);
+        pool->stop = true;
+    }
+
+    pool->start_cond.notify_all ();
+
+    if (pool->threads != NULL)
+    {
+        for (int i = 1; i < pool->n_threads; ++i)
+        {
+            if (pool->threads[i].joinable ()) pool->threads[i].join ();
+        }
+    }
+
+    delete[] pool->threads;
+    delete[] pool->queues;
+    delete pool;
+}
+
+int thread_pool_size (const struct thread_pool *pool)
+{
+    assert (pool != NULL && "pointer can't be null");
+
+    return pool->n_threads;
+}
+
+void thread_pool_run (struct thread_pool *pool, size_t n_chunks, chunk_func_t func, void *arg)
+{
+    assert (pool != NULL && "pointer can't be null");
+    assert (func != NULL && "pointer can't be null");
+
+    size_t n_threads = (size_t) pool->n_threads;
+
+    for (size_t i = 0; i < n_threads; ++i)
+    {
+        std::lock_guard<std::mutex> guard (pool->queues[i].lock);
+
+        pool->queues[i].begin = n_chunks *  i      / n_threads;
+        pool->queues[i].end   = n_chunks * (i + 1) / n_threads;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard (pool->lock);
+
+        pool->func   = func;
+        pool->arg    = arg;
+        pool->n_busy = pool->n_threads - 1;
+        pool->generation++;
+    }
+
+    pool->start_cond.notify_all ();
+
+    worker_run (pool, 0);
+
+    std::unique_lock<std::mutex> guard (pool->lock);
+    pool->done_cond.wait (guard, [pool] { return pool->n_busy == 0; });
+}
+
+///@brief Thread function: wait for thread_pool_run and process chunks until pool is stopped
+static void worker_main (thread_pool *pool, int thread_id)
+{
+    assert (pool != NULL && "pointer can't be null");
+
+    unsigned long seen_generation = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> guard (pool->lock);
+            pool->start_cond.wait (guard, [&] { return pool->stop || pool->generation != seen_generation; });
+
+            if (pool->stop) return;
+            seen_generation = pool->generation;
+        }
+
+        worker_run (pool, thread_id);
+
+        std::lock_guard<std::mutex> guard (pool->lock);
+        if (--pool->n_busy == 0) pool->done_cond.notify_one ();
+    }
+}
+
+///@brief Process own chunks, then steal from other workers until there is no work left
+static void worker_run (thread_pool *pool, int thread_id)
+{
+    assert (pool != NULL && "pointer can't be null");
+
+    worker_queue *queue = &pool->queues[thread_id];
+
+    while (true)
+    {
+        size_t chunk = 0;
+        bool   found = false;
+
+        {
+            std::lock_guard<std::mutex> guard (queue->lock);
+
+            if (queue->begin < queue->end)
+            {
+                chunk = queue->begin++;
+                found = true;
+            }
+        }
+
+        if (found)
+        {
+            pool->func (pool->arg, chunk, thread_id);
+        }
+        else if (!worker_steal (pool, thread_id))
+        {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Move upper half of other worker's range to own queue
+ *
+ * @return False if all other queues are empty
+ */
+static bool worker_steal (thread_pool *pool, int thread_id)
+{
+    assert (pool != NULL && "pointer can't be null");
+
+    for (int i = 1; i < pool->n_threads; ++i)
+    {
+        worker_queue *victim = &pool->queues[(thread_id + i) % pool->n_threads];
+        size_t steal_begin = 0, steal_end = 0;
+
+        {
+            std::lock_guard<std::mutex> guard (victim->lock);
+
+            size_t left = victim->end - victim->begin;
+            if (left == 0) continue;
+
+            steal_end   = victim->end;
+            steal_begin = victim->end - (left + 1) / 2;
+            victim->end = steal_begin;
+        }
+
+        worker_queue *queue = &pool->queues[thread_id];
+        std::lock_guard<std::mutex> guard (queue->lock);
+
+        queue->begin = steal_begin;
+        queue->end   = steal_end;
+
+        return true;
+    }
+
+    return false;
+}
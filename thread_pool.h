@@ -0,0 +1,44 @@
+#ifndef QUAD_THREAD_POOL_H
+#define QUAD_THREAD_POOL_H
+
+#include <stddef.h>
+
+///@brief Cache line size, used to pad per-thread data against false sharing
+const size_t CACHE_LINE_SIZE = 64;
+
+///@brief Pool of worker threads with work stealing
+struct thread_pool;
+
+/**@brief Function processing one chunk of work
+ *
+ * @param [in] arg       Argument given to thread_pool_run
+ * @param [in] chunk     Chunk index in [0, n_chunks)
+ * @param [in] thread_id Index of the worker thread in [0, thread_pool_size)
+ */
+typedef void (*chunk_func_t) (void *arg, size_t chunk, int thread_id);
+
+/**@brief Create thread pool
+ *
+ * Calling thread is used as worker 0, so n_threads - 1 threads are started.
+ *
+ * @param [in] n_threads Number of workers, 0 for number of CPUs
+ * @return Pool or NULL on error
+ */
+struct thread_pool *thread_pool_create (int n_threads);
+
+///@brief Stop workers and free pool
+void thread_pool_destroy (struct thread_pool *pool);
+
+///@brief Number of workers in pool
+int thread_pool_size (const struct thread_pool *pool);
+
+/**@brief Run func for every chunk in [0, n_chunks) and wait for all of them
+ *
+ * Chunks are split into contiguous ranges, one per worker. A worker, which finished its range,
+ * steals upper half of the range of the next busy worker.
+ *
+ * @note Can't be called from chunk function or from several threads simultaneously
+ */
+void thread_pool_run (struct thread_pool *pool, size_t n_chunks, chunk_func_t func, void *arg);
+
+#endif //QUAD_THREAD_POOL_H